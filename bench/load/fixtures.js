@@ -0,0 +1,304 @@
+#!/usr/bin/env node
+// Stand-in printers for the load test: a fake CUPS server speaking just
+// enough IPP for libcups, plus loopback TCP (port 9100 style) and FIFO
+// device printers. All of them can inject delay; the CUPS server and the
+// TCP printers can also inject errors.
+//
+// Normally forked by bench/load/run.js. It can also run on its own, for
+// poking at it by hand:
+//
+//   node bench/load/fixtures.js --printers 4 --cups-delay-ms 5
+//
+// Standalone, it prints the CUPS_SERVER value and the printer list, then
+// runs until interrupted.
+
+const { execFileSync } = require('child_process');
+const fs = require('fs');
+const http = require('http');
+const net = require('net');
+const os = require('os');
+const path = require('path');
+const { TAG, OP, STATUS, decodeRequest, encodeResponse } = require('./ipp');
+
+const DEFAULTS = {
+  printers: 4,
+  cupsDelayMs: 0,      // added to every IPP response
+  cupsErrorRate: 0,    // share of Create-Job/Print-Job answered server-error-busy
+  printerDelayMs: 0,   // reads paused this long after each chunk (slow printer)
+  printerErrorRate: 0, // share of TCP chunks answered with a connection reset
+  devices: os.platform() !== 'win32'
+};
+
+function parseArgs(argv) {
+  const options = Object.assign({}, DEFAULTS);
+  const names = {
+    '--printers': 'printers',
+    '--cups-delay-ms': 'cupsDelayMs',
+    '--cups-error-rate': 'cupsErrorRate',
+    '--printer-delay-ms': 'printerDelayMs',
+    '--printer-error-rate': 'printerErrorRate'
+  };
+  for (let i = 0; i < argv.length; i += 2) {
+    const key = names[argv[i]];
+    if (!key) throw new Error(`Unknown argument: ${argv[i]}`);
+    options[key] = Number(argv[i + 1]);
+  }
+  return options;
+}
+
+function createStats() {
+  return {
+    cupsConnections: 0,
+    ippRequests: 0,
+    ippErrorsInjected: 0,
+    jobs: 0,
+    jobBytes: 0,
+    tcpConnections: 0,
+    tcpResets: 0,
+    tcpBytes: 0,
+    deviceBytes: 0
+  };
+}
+
+// ============================================================================
+// Fake CUPS server
+// ============================================================================
+
+function printerAttributes(printer) {
+  return {
+    tag: TAG.PRINTER,
+    attributes: [
+      [TAG.NAME, 'printer-name', printer.name],
+      [TAG.URI, 'printer-uri-supported', `ipp://localhost/printers/${printer.name}`],
+      [TAG.URI, 'device-uri', printer.deviceUri],
+      [TAG.ENUM, 'printer-state', 3],
+      [TAG.BOOLEAN, 'printer-is-accepting-jobs', true],
+      [TAG.INTEGER, 'printer-type', 0x0004],
+      [TAG.TEXT, 'printer-info', printer.name],
+      [TAG.TEXT, 'printer-make-and-model', 'Load Test Receipt Printer']
+    ]
+  };
+}
+
+function printerNameFor(req, message) {
+  const uri = message.attributes['printer-uri'] || req.url;
+  const match = /\/printers\/([^/?]+)/.exec(uri);
+  return match ? decodeURIComponent(match[1]) : null;
+}
+
+function startCupsServer(printers, options, stats) {
+  const byName = new Map(printers.map((p) => [p.name, p]));
+  let nextJobId = 1;
+
+  function handle(req, message) {
+    const printer = byName.get(printerNameFor(req, message));
+
+    switch (message.operation) {
+      case OP.CUPS_GET_PRINTERS:
+        return encodeResponse(message, STATUS.OK, printers.map(printerAttributes));
+
+      case OP.CUPS_GET_DEFAULT:
+        return encodeResponse(message, STATUS.OK, [printerAttributes(printers[0])]);
+
+      case OP.GET_PRINTER_ATTRIBUTES:
+        if (!printer) return encodeResponse(message, STATUS.NOT_FOUND);
+        return encodeResponse(message, STATUS.OK, [printerAttributes(printer)]);
+
+      case OP.CREATE_JOB:
+      case OP.PRINT_JOB: {
+        if (!printer) return encodeResponse(message, STATUS.NOT_FOUND);
+        if (Math.random() < options.cupsErrorRate) {
+          stats.ippErrorsInjected++;
+          return encodeResponse(message, STATUS.BUSY);
+        }
+        stats.jobs++;
+        stats.jobBytes += message.data.length;
+        return encodeResponse(message, STATUS.OK, [{
+          tag: TAG.JOB,
+          attributes: [
+            [TAG.INTEGER, 'job-id', nextJobId++],
+            [TAG.ENUM, 'job-state', message.operation === OP.PRINT_JOB ? 9 : 3]
+          ]
+        }]);
+      }
+
+      case OP.SEND_DOCUMENT:
+        stats.jobBytes += message.data.length;
+        return encodeResponse(message, STATUS.OK, [{
+          tag: TAG.JOB,
+          attributes: [
+            [TAG.INTEGER, 'job-id', message.attributes['job-id'] || 0],
+            [TAG.ENUM, 'job-state', 9]
+          ]
+        }]);
+
+      case OP.CANCEL_JOB:
+        return encodeResponse(message, STATUS.OK);
+
+      default:
+        return encodeResponse(message, STATUS.OPERATION_NOT_SUPPORTED);
+    }
+  }
+
+  const server = http.createServer((req, res) => {
+    const chunks = [];
+    req.on('data', (chunk) => chunks.push(chunk));
+    req.on('end', () => {
+      stats.ippRequests++;
+      let body;
+      try {
+        const message = decodeRequest(Buffer.concat(chunks));
+        body = handle(req, message);
+      } catch (err) {
+        res.writeHead(400);
+        res.end();
+        return;
+      }
+
+      const respond = () => {
+        res.writeHead(200, { 'Content-Type': 'application/ipp', 'Content-Length': body.length });
+        res.end(body);
+      };
+      if (options.cupsDelayMs > 0) {
+        setTimeout(respond, options.cupsDelayMs);
+      } else {
+        respond();
+      }
+    });
+  });
+  server.keepAliveTimeout = 60000;
+  server.on('connection', () => stats.cupsConnections++);
+
+  return new Promise((resolve) => {
+    server.listen(0, '127.0.0.1', () => resolve(server));
+  });
+}
+
+// ============================================================================
+// Loopback TCP printers
+// ============================================================================
+
+// Pause reading after each chunk to model a slow printer; writers only notice
+// once the socket buffers fill, exactly like a real busy printer
+function throttle(stream, delayMs) {
+  if (delayMs <= 0) return;
+  stream.pause();
+  setTimeout(() => stream.resume(), delayMs);
+}
+
+function startTcpPrinter(options, stats) {
+  const server = net.createServer((socket) => {
+    stats.tcpConnections++;
+    socket.on('error', () => {});
+    socket.on('data', (chunk) => {
+      if (Math.random() < options.printerErrorRate) {
+        stats.tcpResets++;
+        // resetAndDestroy() needs Node 16.17+; a plain close still fails the next write
+        if (socket.resetAndDestroy) socket.resetAndDestroy();
+        else socket.destroy();
+        return;
+      }
+      stats.tcpBytes += chunk.length;
+      throttle(socket, options.printerDelayMs);
+    });
+  });
+
+  return new Promise((resolve) => {
+    server.listen(0, '127.0.0.1', () => resolve(server));
+  });
+}
+
+// ============================================================================
+// FIFO device printers
+// ============================================================================
+
+// A FIFO stands in for /dev/usb/lp* and serial ports (Node has no pty API).
+// The reader holds the FIFO O_RDWR so it never sees EOF. The addon opens
+// device nodes O_RDWR as well, so a FIFO can't be made to fail a write;
+// only the delay applies here (a stalled reader fills the 64 KiB pipe and
+// writers then hit their write timeout).
+function startDevicePrinter(fifoPath, options, stats) {
+  execFileSync('mkfifo', [fifoPath]);
+
+  const fd = fs.openSync(fifoPath, fs.constants.O_RDWR | fs.constants.O_NONBLOCK);
+  const reader = new net.Socket({ fd, readable: true, writable: false });
+  reader.on('error', () => {});
+  reader.on('data', (chunk) => {
+    stats.deviceBytes += chunk.length;
+    throttle(reader, options.printerDelayMs);
+  });
+
+  return {
+    close() {
+      reader.destroy();
+    }
+  };
+}
+
+// ============================================================================
+// Setup
+// ============================================================================
+
+async function start(options) {
+  const stats = createStats();
+  const tmpDir = options.devices ? fs.mkdtempSync(path.join(os.tmpdir(), 'cashdrawer-load-')) : null;
+
+  const printers = [];
+  const closers = [];
+  for (let i = 0; i < options.printers; i++) {
+    const tcp = await startTcpPrinter(options, stats);
+    closers.push(() => tcp.close());
+
+    const printer = {
+      name: `load-printer-${i}`,
+      host: '127.0.0.1',
+      port: tcp.address().port,
+      devicePath: null,
+      deviceUri: `socket://127.0.0.1:${tcp.address().port}`
+    };
+
+    if (tmpDir) {
+      printer.devicePath = path.join(tmpDir, `lp${i}`);
+      const device = startDevicePrinter(printer.devicePath, options, stats);
+      closers.push(() => device.close());
+    }
+    printers.push(printer);
+  }
+
+  const cups = await startCupsServer(printers, options, stats);
+  closers.push(() => cups.close());
+
+  return {
+    cupsServer: `127.0.0.1:${cups.address().port}`,
+    printers,
+    stats,
+    close() {
+      closers.forEach((close) => close());
+      if (tmpDir) fs.rmSync(tmpDir, { recursive: true, force: true });
+    }
+  };
+}
+
+if (require.main === module) {
+  start(parseArgs(process.argv.slice(2))).then((fixtures) => {
+    const shutdown = () => {
+      fixtures.close();
+      process.exit(0);
+    };
+    process.on('SIGINT', shutdown);
+    process.on('SIGTERM', shutdown);
+
+    if (process.send) {
+      process.on('message', (message) => {
+        if (message === 'stats') process.send({ stats: fixtures.stats });
+      });
+      process.on('disconnect', shutdown);
+      process.send({ cupsServer: fixtures.cupsServer, printers: fixtures.printers });
+    } else {
+      console.log(`CUPS_SERVER=${fixtures.cupsServer}`);
+      console.log(JSON.stringify(fixtures.printers, null, 2));
+    }
+  });
+}
+
+module.exports = { start, parseArgs };
@@ -0,0 +1,139 @@
+// Minimal IPP/1.1 message encoding (RFC 8010), enough for the fake CUPS
+// server to answer the requests libcups makes on behalf of the addon.
+
+const TAG = {
+  OPERATION: 0x01,
+  JOB: 0x02,
+  END: 0x03,
+  PRINTER: 0x04,
+  INTEGER: 0x21,
+  BOOLEAN: 0x22,
+  ENUM: 0x23,
+  TEXT: 0x41,
+  NAME: 0x42,
+  KEYWORD: 0x44,
+  URI: 0x45,
+  CHARSET: 0x47,
+  LANGUAGE: 0x48,
+  MIME_TYPE: 0x49
+};
+
+const OP = {
+  PRINT_JOB: 0x0002,
+  CREATE_JOB: 0x0005,
+  SEND_DOCUMENT: 0x0006,
+  CANCEL_JOB: 0x0008,
+  GET_JOB_ATTRIBUTES: 0x0009,
+  GET_PRINTER_ATTRIBUTES: 0x000B,
+  CUPS_GET_DEFAULT: 0x4001,
+  CUPS_GET_PRINTERS: 0x4002
+};
+
+const STATUS = {
+  OK: 0x0000,
+  NOT_FOUND: 0x0406,
+  OPERATION_NOT_SUPPORTED: 0x0501,
+  SERVICE_UNAVAILABLE: 0x0502,
+  BUSY: 0x0507
+};
+
+function decodeValue(tag, raw) {
+  if (tag === TAG.INTEGER || tag === TAG.ENUM) return raw.readInt32BE(0);
+  if (tag === TAG.BOOLEAN) return raw[0] !== 0;
+  return raw.toString('utf8');
+}
+
+// Parse a request; attributes are flattened to name -> value (or array for
+// multi-valued attributes) and the trailing document data is returned as-is
+function decodeRequest(buf) {
+  if (buf.length < 9) throw new Error('IPP message too short');
+
+  const message = {
+    version: [buf[0], buf[1]],
+    operation: buf.readUInt16BE(2),
+    requestId: buf.readInt32BE(4),
+    attributes: {},
+    data: null
+  };
+
+  let offset = 8;
+  let lastName = null;
+  while (offset < buf.length) {
+    const tag = buf[offset++];
+    if (tag === TAG.END) break;
+    if (tag < 0x10) {
+      lastName = null;
+      continue;
+    }
+
+    const nameLength = buf.readUInt16BE(offset);
+    offset += 2;
+    const name = buf.toString('utf8', offset, offset + nameLength);
+    offset += nameLength;
+    const valueLength = buf.readUInt16BE(offset);
+    offset += 2;
+    const value = decodeValue(tag, buf.subarray(offset, offset + valueLength));
+    offset += valueLength;
+
+    if (nameLength === 0 && lastName !== null) {
+      const existing = message.attributes[lastName];
+      message.attributes[lastName] = Array.isArray(existing) ? existing.concat(value) : [existing, value];
+    } else {
+      message.attributes[name] = value;
+      lastName = name;
+    }
+  }
+
+  message.data = buf.subarray(offset);
+  return message;
+}
+
+function encodeAttribute(parts, tag, name, value) {
+  const values = Array.isArray(value) ? value : [value];
+  values.forEach((v, i) => {
+    let raw;
+    if (tag === TAG.INTEGER || tag === TAG.ENUM) {
+      raw = Buffer.alloc(4);
+      raw.writeInt32BE(v, 0);
+    } else if (tag === TAG.BOOLEAN) {
+      raw = Buffer.from([v ? 1 : 0]);
+    } else {
+      raw = Buffer.from(String(v), 'utf8');
+    }
+
+    const attrName = i === 0 ? Buffer.from(name, 'utf8') : Buffer.alloc(0);
+    const header = Buffer.alloc(3);
+    header[0] = tag;
+    header.writeUInt16BE(attrName.length, 1);
+    const length = Buffer.alloc(2);
+    length.writeUInt16BE(raw.length, 0);
+    parts.push(header, attrName, length, raw);
+  });
+}
+
+// groups: [{ tag, attributes: [[valueTag, name, value], ...] }, ...]
+function encodeResponse(request, status, groups) {
+  const parts = [];
+  const header = Buffer.alloc(8);
+  header[0] = request.version[0];
+  header[1] = request.version[1];
+  header.writeUInt16BE(status, 2);
+  header.writeInt32BE(request.requestId, 4);
+  parts.push(header);
+
+  parts.push(Buffer.from([TAG.OPERATION]));
+  encodeAttribute(parts, TAG.CHARSET, 'attributes-charset', 'utf-8');
+  encodeAttribute(parts, TAG.LANGUAGE, 'attributes-natural-language', 'en');
+
+  for (const group of groups || []) {
+    parts.push(Buffer.from([group.tag]));
+    for (const [tag, name, value] of group.attributes) {
+      encodeAttribute(parts, tag, name, value);
+    }
+  }
+
+  parts.push(Buffer.from([TAG.END]));
+  return Buffer.concat(parts);
+}
+
+module.exports = { TAG, OP, STATUS, decodeRequest, encodeResponse };
@@ -0,0 +1,287 @@
+#!/usr/bin/env node
+// End-to-end load test. Drives openCashDrawer() or getAvailablePrinters()
+// against the stand-in printers from fixtures.js and reports latency
+// percentiles, throughput and error rates as JSON.
+//
+//   npm run bench:load -- --scenario kick --transport tcp --concurrency 32
+//   npm run bench:load -- --scenario kick --transport spooler --rate 500 --cups-delay-ms 5
+//   npm run bench:load -- --scenario enumerate --printers 200
+//
+// Options:
+//   --scenario kick|enumerate   operation to run (default kick)
+//   --transport spooler|tcp|device
+//                               kick path (default spooler; spooler goes
+//                               through libcups to the fake CUPS server)
+//   --printers N                stand-in printers (default 4)
+//   --concurrency N             requests in flight for closed-loop runs (default 16)
+//   --rate N                    open loop: start N requests per second, latency
+//                               measured from the scheduled start (default 0 = closed loop)
+//   --duration S                measured seconds (default 10)
+//   --warmup S                  unmeasured seconds first (default 1)
+//   --cups-delay-ms, --cups-error-rate, --printer-delay-ms, --printer-error-rate
+//                               fault injection, see fixtures.js
+//   --out FILE                  also write the JSON report to FILE
+
+const { fork } = require('child_process');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+
+const FIXTURE_FLAGS = ['--printers', '--cups-delay-ms', '--cups-error-rate', '--printer-delay-ms', '--printer-error-rate'];
+
+// Outstanding open-loop requests beyond this are counted as dropped
+const MAX_OUTSTANDING = 10000;
+
+function parseArgs(argv) {
+  const args = {
+    scenario: 'kick',
+    transport: 'spooler',
+    printers: 4,
+    concurrency: 16,
+    rate: 0,
+    duration: 10,
+    warmup: 1,
+    out: null,
+    fixtureArgs: []
+  };
+
+  for (let i = 0; i < argv.length; i += 2) {
+    const flag = argv[i];
+    const value = argv[i + 1];
+    if (value === undefined) throw new Error(`Missing value for ${flag}`);
+
+    if (FIXTURE_FLAGS.includes(flag)) {
+      args.fixtureArgs.push(flag, value);
+      if (flag === '--printers') args.printers = Number(value);
+      continue;
+    }
+
+    switch (flag) {
+      case '--scenario': args.scenario = value; break;
+      case '--transport': args.transport = value; break;
+      case '--concurrency': args.concurrency = Number(value); break;
+      case '--rate': args.rate = Number(value); break;
+      case '--duration': args.duration = Number(value); break;
+      case '--warmup': args.warmup = Number(value); break;
+      case '--out': args.out = value; break;
+      default: throw new Error(`Unknown argument: ${flag}`);
+    }
+  }
+
+  if (!['kick', 'enumerate'].includes(args.scenario)) {
+    throw new Error('--scenario must be kick or enumerate');
+  }
+  if (!['spooler', 'tcp', 'device'].includes(args.transport)) {
+    throw new Error('--transport must be spooler, tcp or device');
+  }
+  if (args.transport === 'device' && os.platform() === 'win32') {
+    throw new Error('--transport device needs FIFOs and is not available on Windows');
+  }
+  return args;
+}
+
+function startFixtures(fixtureArgs) {
+  const child = fork(path.join(__dirname, 'fixtures.js'), fixtureArgs, { stdio: 'inherit' });
+  return new Promise((resolve, reject) => {
+    child.once('message', (info) => resolve({ child, info }));
+    child.once('exit', (code) => reject(new Error(`fixtures exited with code ${code}`)));
+  });
+}
+
+function requestStats(child) {
+  return new Promise((resolve) => {
+    child.once('message', (message) => resolve(message.stats));
+    child.send('stats');
+  });
+}
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+class Recorder {
+  constructor() {
+    this.latencies = [];
+    this.errors = {};
+    this.completed = 0;
+    this.failed = 0;
+    this.dropped = 0;
+    this.recording = false;
+  }
+
+  record(startNs, errorKey) {
+    if (!this.recording) return;
+    this.latencies.push(Number(process.hrtime.bigint() - startNs) / 1e6);
+    this.completed++;
+    if (errorKey !== null) {
+      this.failed++;
+      this.errors[errorKey] = (this.errors[errorKey] || 0) + 1;
+    }
+  }
+
+  summary(elapsedMs) {
+    const sorted = Float64Array.from(this.latencies).sort();
+    const pick = (q) => (sorted.length ? sorted[Math.min(sorted.length - 1, Math.floor(q * sorted.length))] : null);
+    const sum = sorted.reduce((a, b) => a + b, 0);
+    const round = (v) => (v === null ? null : Math.round(v * 1000) / 1000);
+
+    return {
+      requests: this.completed,
+      failed: this.failed,
+      dropped: this.dropped,
+      errorRate: this.completed ? this.failed / this.completed : 0,
+      errors: this.errors,
+      throughputPerSec: Math.round((this.completed / elapsedMs) * 1000 * 10) / 10,
+      latencyMs: {
+        mean: round(sorted.length ? sum / sorted.length : null),
+        p50: round(pick(0.5)),
+        p90: round(pick(0.9)),
+        p99: round(pick(0.99)),
+        p999: round(pick(0.999)),
+        max: round(sorted.length ? sorted[sorted.length - 1] : null)
+      }
+    };
+  }
+}
+
+// ============================================================================
+// Operations
+// ============================================================================
+
+function makeOperation(cashdrawer, args, codeNames) {
+  if (args.scenario === 'enumerate') {
+    return () => cashdrawer.getAvailablePrinters().then(() => null, (err) => err.code || 'EXCEPTION');
+  }
+
+  return (target) => {
+    const options = { transport: args.transport };
+    // Direct transports get their address up front so the run measures the
+    // transport rather than the CUPS queue lookup
+    if (args.transport === 'tcp') {
+      options.host = target.host;
+      options.port = target.port;
+    } else if (args.transport === 'device') {
+      options.devicePath = target.devicePath;
+    }
+    return cashdrawer.openCashDrawer(target.name, options).then(
+      (result) => (result.success ? null : codeNames[result.errorCode] || String(result.errorCode)),
+      () => 'EXCEPTION'
+    );
+  };
+}
+
+// Closed loop: `concurrency` workers, each issuing the next request as soon
+// as the previous one settles
+function runClosedLoop(operation, targets, args, recorder, until) {
+  let next = 0;
+  const worker = async () => {
+    while (Date.now() < until) {
+      const target = targets[next++ % targets.length];
+      const start = process.hrtime.bigint();
+      recorder.record(start, await operation(target));
+    }
+  };
+  return Promise.all(Array.from({ length: args.concurrency }, worker));
+}
+
+// Open loop: requests start on a fixed schedule whether or not earlier ones
+// finished, and latency counts from the scheduled start so a stalled backend
+// is not hidden (no coordinated omission)
+function runOpenLoop(operation, targets, args, recorder, until) {
+  return new Promise((resolve) => {
+    const intervalNs = BigInt(Math.round(1e9 / args.rate));
+    const origin = process.hrtime.bigint();
+    let issued = 0;
+    let outstanding = 0;
+    let finished = false;
+
+    const maybeResolve = () => {
+      if (finished && outstanding === 0) resolve();
+    };
+
+    const tick = () => {
+      const now = process.hrtime.bigint();
+      while (origin + BigInt(issued) * intervalNs <= now) {
+        const scheduled = origin + BigInt(issued) * intervalNs;
+        const target = targets[issued % targets.length];
+        issued++;
+
+        if (outstanding >= MAX_OUTSTANDING) {
+          if (recorder.recording) recorder.dropped++;
+          continue;
+        }
+        outstanding++;
+        operation(target).then((error) => {
+          recorder.record(scheduled, error);
+          outstanding--;
+          maybeResolve();
+        });
+      }
+
+      if (Date.now() < until) {
+        setTimeout(tick, 1);
+      } else {
+        finished = true;
+        maybeResolve();
+      }
+    };
+    tick();
+  });
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+async function main() {
+  const args = parseArgs(process.argv.slice(2));
+  const { child, info } = await startFixtures(args.fixtureArgs);
+
+  // libcups reads CUPS_SERVER the first time it needs a connection, so this
+  // must be set before the addon does anything
+  process.env.CUPS_SERVER = info.cupsServer;
+  const cashdrawer = require('../..');
+
+  const codeNames = {};
+  for (const [name, code] of Object.entries(cashdrawer.PrinterErrorCodes)) codeNames[code] = name;
+
+  const operation = makeOperation(cashdrawer, args, codeNames);
+  const run = args.rate > 0 ? runOpenLoop : runClosedLoop;
+  const recorder = new Recorder();
+
+  const warmupUntil = Date.now() + args.warmup * 1000;
+  await run(operation, info.printers, args, recorder, warmupUntil);
+
+  recorder.recording = true;
+  const started = Date.now();
+  await run(operation, info.printers, args, recorder, started + args.duration * 1000);
+  const elapsedMs = Date.now() - started;
+
+  const report = {
+    scenario: args.scenario,
+    transport: args.scenario === 'kick' ? args.transport : undefined,
+    mode: args.rate > 0 ? 'open' : 'closed',
+    concurrency: args.rate > 0 ? undefined : args.concurrency,
+    rate: args.rate > 0 ? args.rate : undefined,
+    printers: args.printers,
+    durationMs: elapsedMs,
+    node: process.version,
+    platform: `${os.platform()}-${os.arch()}`,
+    result: recorder.summary(elapsedMs),
+    cupsPool: cashdrawer.getCupsConnectionStats(),
+    backend: await requestStats(child)
+  };
+
+  const json = JSON.stringify(report, null, 2);
+  if (args.out) fs.writeFileSync(args.out, json + '\n');
+  console.log(json);
+
+  child.disconnect();
+  // Pooled printer connections live in native code; don't wait on them
+  process.exit(0);
+}
+
+main().catch((err) => {
+  console.error(err.message);
+  process.exit(1);
+});
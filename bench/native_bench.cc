@@ -0,0 +1,551 @@
+// Micro-benchmarks for the enumeration, parsing and marshalling hot paths.
+// Compiled into two addons that both export runNativeBenchmarks():
+// node_printer_bench, built with the production addon's flags, reports
+// timings; node_printer_bench_alloc (NODE_PRINTER_BENCH_ALLOCATIONS) counts
+// allocations only, since its build settings would skew the timings.
+// bench/run.js drives both and prints JSON.
+//
+//   node-gyp rebuild --build_benchmarks=true
+//   node bench/run.js [--sizes 10,100,1000,10000] [--min-time 200]
+
+#include "../src/common.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+// ============================================================================
+// Allocation counting
+// ============================================================================
+
+static volatile size_t g_sink;
+
+#ifdef NODE_PRINTER_BENCH_ALLOCATIONS
+// Replacing the global operator new only sees allocations that bind to this
+// module. On Linux the allocation target links with -Bsymbolic-functions and
+// defines _GLIBCXX_ASSERTIONS, which stops libstdc++ from routing std::string
+// growth through its own prebuilt (and separately bound) instantiation. The
+// counter verifies itself before any numbers are reported.
+
+static std::atomic<bool> g_countAllocations(false);
+static std::atomic<size_t> g_allocations(0);
+
+static void* countedAlloc(size_t size) {
+    if (g_countAllocations.load(std::memory_order_relaxed)) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(size); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(size); } catch (...) { return nullptr; }
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+static void startCounting() {
+    g_allocations.store(0, std::memory_order_relaxed);
+    g_countAllocations.store(true, std::memory_order_relaxed);
+}
+
+static size_t stopCounting() {
+    g_countAllocations.store(false, std::memory_order_relaxed);
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+// A direct operator new and a heap-sized std::string must each be seen
+// exactly once; the direct call goes through a volatile pointer so the
+// compiler cannot elide the pair
+static bool allocationCountingWorks() {
+    void* (*volatile allocate)(size_t) = &::operator new;
+    volatile size_t length = 64;
+
+    startCounting();
+    void* probe = allocate(16);
+    size_t direct = stopCounting();
+    ::operator delete(probe);
+
+    startCounting();
+    {
+        std::string text(length, 'x');
+        g_sink = text.size();
+    }
+    size_t viaString = stopCounting();
+
+    return direct == 1 && viaString == 1;
+}
+#else
+static bool allocationCountingWorks() { return false; }
+#endif
+
+// ============================================================================
+// Synthetic printer lists
+// ============================================================================
+
+static const char* SAMPLE_URIS[] = {
+    "socket://192.168.1.100:9100",
+    "usb://EPSON/TM-T20II?serial=X4CG012345",
+    "ipp://receipt-printer.local:631/ipp/print",
+    "serial:/dev/ttyUSB0?baud=38400+bits=8+parity=none",
+    "bluetooth://00:11:22:33:44:55",
+    "lpd://10.0.0.12/queue",
+    "socket://[fe80::1%25eth0]:9100",
+    "parallel:/dev/lp0",
+    "file:///dev/null",
+    "dnssd://Star%20TSP100._pdl-datastream._tcp.local/"
+};
+static const size_t SAMPLE_URI_COUNT = sizeof(SAMPLE_URIS) / sizeof(SAMPLE_URIS[0]);
+
+static const char* SAMPLE_STATES[] = { "3", "4", "5" };
+
+static std::string syntheticName(size_t i) {
+    // Every 16th queue carries a virtual-printer name so the blocklist scan
+    // sees both outcomes
+    if (i % 16 == 15) return "Microsoft Print to PDF " + std::to_string(i);
+    return "Receipt_Printer_" + std::to_string(i);
+}
+
+static std::vector<PrinterInfo> syntheticPrinters(size_t count) {
+    std::vector<PrinterInfo> printers(count);
+    for (size_t i = 0; i < count; i++) {
+        PrinterInfo& info = printers[i];
+        info.name = syntheticName(i);
+        info.isDefault = (i == 0);
+        info.status = "IDLE";
+        switch (i % 4) {
+        case 0:
+            info.type = "NETWORK";
+            info.ipAddress = "192.168.1.100";
+            info.port = DEFAULT_RAW_TCP_PORT;
+            break;
+        case 1:
+            info.type = "NETWORK";
+            info.hostname = "receipt-printer.local";
+            info.port = 631;
+            break;
+        case 2:
+            info.type = "BLUETOOTH";
+            info.bluetoothAddress = "00:11:22:33:44:55";
+            break;
+        default:
+            info.type = "USB";
+            break;
+        }
+    }
+    return printers;
+}
+
+#ifndef _WIN32
+// Destination array shaped like cupsGetDests() output; owns its strings
+// rather than going through cupsAddOption() so it never mixes allocators
+// with libcups
+class SyntheticDests {
+public:
+    explicit SyntheticDests(size_t count) : dests_(count), options_(count * 2) {
+        names_.reserve(count);
+        for (size_t i = 0; i < count; i++) names_.push_back(syntheticName(i));
+
+        for (size_t i = 0; i < count; i++) {
+            cups_option_t* opts = &options_[i * 2];
+            opts[0].name = const_cast<char*>("printer-state");
+            opts[0].value = const_cast<char*>(SAMPLE_STATES[i % 3]);
+            opts[1].name = const_cast<char*>("device-uri");
+            opts[1].value = const_cast<char*>(SAMPLE_URIS[i % SAMPLE_URI_COUNT]);
+
+            cups_dest_t& dest = dests_[i];
+            std::memset(&dest, 0, sizeof(dest));
+            dest.name = &names_[i][0];
+            dest.is_default = (i == 0);
+            dest.num_options = 2;
+            dest.options = opts;
+        }
+    }
+
+    size_t size() const { return dests_.size(); }
+    const cups_dest_t& operator[](size_t i) const { return dests_[i]; }
+
+private:
+    std::vector<std::string> names_;
+    std::vector<cups_dest_t> dests_;
+    std::vector<cups_option_t> options_;
+};
+#endif
+
+// ============================================================================
+// Reference marshalling
+// ============================================================================
+
+// The per-property marshalling PrinterMarshaller replaced: one
+// napi_create_string_utf8() for every key and value and one
+// napi_set_named_property() per field. Kept so the event-loop cost of
+// getAvailablePrinters() can be compared against it.
+static napi_value namedPropertyPrinter(napi_env env, const PrinterInfo& printer) {
+    napi_value printer_obj, value;
+    napi_create_object(env, &printer_obj);
+
+    napi_create_string_utf8(env, printer.name.c_str(), NAPI_AUTO_LENGTH, &value);
+    napi_set_named_property(env, printer_obj, "name", value);
+    napi_get_boolean(env, printer.isDefault, &value);
+    napi_set_named_property(env, printer_obj, "default", value);
+    napi_create_string_utf8(env, printer.status.c_str(), NAPI_AUTO_LENGTH, &value);
+    napi_set_named_property(env, printer_obj, "status", value);
+    napi_create_string_utf8(env, printer.type.c_str(), NAPI_AUTO_LENGTH, &value);
+    napi_set_named_property(env, printer_obj, "type", value);
+    if (!printer.ipAddress.empty()) {
+        napi_create_string_utf8(env, printer.ipAddress.c_str(), NAPI_AUTO_LENGTH, &value);
+        napi_set_named_property(env, printer_obj, "ipAddress", value);
+    }
+    if (printer.port > 0) {
+        napi_create_int32(env, printer.port, &value);
+        napi_set_named_property(env, printer_obj, "port", value);
+    }
+    if (!printer.hostname.empty()) {
+        napi_create_string_utf8(env, printer.hostname.c_str(), NAPI_AUTO_LENGTH, &value);
+        napi_set_named_property(env, printer_obj, "hostname", value);
+    }
+    if (!printer.bluetoothAddress.empty()) {
+        napi_create_string_utf8(env, printer.bluetoothAddress.c_str(), NAPI_AUTO_LENGTH, &value);
+        napi_set_named_property(env, printer_obj, "bluetoothAddress", value);
+    }
+    return printer_obj;
+}
+
+// ============================================================================
+// Harness
+// ============================================================================
+
+struct BenchResult {
+    std::string name;
+    size_t size;
+    size_t iterations;
+    double nsPerOp;           // < 0 in the allocation build, which isn't timed
+    double allocationsPerOp;  // < 0 when counting is unavailable
+};
+
+typedef std::chrono::steady_clock Clock;
+
+// The allocation build runs `op` once to count allocations; the timing
+// build runs it in doubling batches until a batch takes at least minTimeMs
+template <typename Op>
+static BenchResult measure(const char* name, size_t size, double minTimeMs, bool counting, Op op) {
+    BenchResult result;
+    result.name = name;
+    result.size = size;
+    result.iterations = 0;
+    result.nsPerOp = -1;
+    result.allocationsPerOp = -1;
+
+    op();  // warm-up
+#ifdef NODE_PRINTER_BENCH_ALLOCATIONS
+    (void)minTimeMs;
+    if (counting) {
+        startCounting();
+        op();
+        result.allocationsPerOp = static_cast<double>(stopCounting());
+    }
+    return result;
+#else
+    (void)counting;
+
+    size_t iterations = 1;
+    for (;;) {
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < iterations; i++) op();
+        double elapsedNs = static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+
+        if (elapsedNs >= minTimeMs * 1e6 || iterations >= (static_cast<size_t>(1) << 30)) {
+            result.iterations = iterations;
+            result.nsPerOp = elapsedNs / static_cast<double>(iterations);
+            return result;
+        }
+        iterations *= 2;
+    }
+#endif
+}
+
+static void runListBenchmarks(size_t size, double minTimeMs, bool counting,
+                              std::vector<BenchResult>& results) {
+    std::vector<PrinterInfo> printers = syntheticPrinters(size);
+
+#ifndef _WIN32
+    SyntheticDests dests(size);
+    results.push_back(measure("printerInfoFromDest", size, minTimeMs, counting, [&]() {
+        std::vector<PrinterInfo> out;
+        out.reserve(dests.size());
+        for (size_t i = 0; i < dests.size(); i++) out.push_back(printerInfoFromDest(dests[i]));
+        g_sink = out.size();
+    }));
+#endif
+
+    results.push_back(measure("isBlockedVirtualPrinter", size, minTimeMs, counting, [&]() {
+        size_t blocked = 0;
+        for (size_t i = 0; i < printers.size(); i++) {
+            if (isBlockedVirtualPrinter(printers[i].name)) blocked++;
+        }
+        g_sink = blocked;
+    }));
+
+    // Marshalling into JS objects is measured from JS through
+    // marshalPrinters() instead: inside one long native call the scavenger
+    // gets slower with every iteration and swamps the result
+}
+
+static napi_value makeDrawerOptions(napi_env env, bool tcp) {
+    napi_value options, value;
+    napi_create_object(env, &options);
+
+    napi_create_int32(env, 1, &value);
+    napi_set_named_property(env, options, "pin", value);
+    napi_create_int32(env, 100, &value);
+    napi_set_named_property(env, options, "pulseOnTime", value);
+    napi_create_int32(env, 200, &value);
+    napi_set_named_property(env, options, "pulseOffTime", value);
+
+    if (tcp) {
+        napi_create_string_utf8(env, "tcp", NAPI_AUTO_LENGTH, &value);
+        napi_set_named_property(env, options, "transport", value);
+        napi_create_string_utf8(env, "192.168.1.100", NAPI_AUTO_LENGTH, &value);
+        napi_set_named_property(env, options, "host", value);
+        napi_create_int32(env, DEFAULT_RAW_TCP_PORT, &value);
+        napi_set_named_property(env, options, "port", value);
+    }
+    return options;
+}
+
+static void runConfigBenchmarks(napi_env env, double minTimeMs, bool counting,
+                                std::vector<BenchResult>& results) {
+    napi_value pulseOptions = makeDrawerOptions(env, false);
+    napi_value tcpOptions = makeDrawerOptions(env, true);
+
+    results.push_back(measure("ParseDrawerConfig/pulse", 1, minTimeMs, counting, [&]() {
+        DrawerConfig config;
+        std::string error;
+        g_sink = ParseDrawerConfig(env, pulseOptions, config, error);
+    }));
+
+    results.push_back(measure("ParseDrawerConfig/tcp", 1, minTimeMs, counting, [&]() {
+        DrawerConfig config;
+        std::string error;
+        g_sink = ParseDrawerConfig(env, tcpOptions, config, error);
+    }));
+
+    DrawerConfig config(0x01, 0x64, 0xC8);
+    results.push_back(measure("DrawerConfig::buildCommand", 1, minTimeMs, counting, [&]() {
+        g_sink = config.buildCommand().size();
+    }));
+}
+
+// A 40-line receipt, once in plain ASCII and once with accents and the euro
+// sign, transcoded to CP858
+static void runEncoderBenchmarks(double minTimeMs, bool counting, std::vector<BenchResult>& results) {
+    std::string ascii, accented;
+    for (int i = 0; i < 40; i++) {
+        ascii += "Item description          2 x 3.50    7.00\n";
+        accented += "Cr\xC3\xA8me br\xC3\xBBl\xC3\xA9" "e          2 x 3,50    7,00 \xE2\x82\xAC\n";
+    }
+    const EscPosCodePage* page = findCodePage("cp858");
+    std::vector<unsigned char> out(std::max(ascii.size(), accented.size()));
+
+    results.push_back(measure("encodeText/ascii", ascii.size(), minTimeMs, counting, [&]() {
+        const unsigned char* text = reinterpret_cast<const unsigned char*>(ascii.data());
+        g_sink = encodeText(*page, text, ascii.size(), out.data()) - out.data();
+    }));
+
+    results.push_back(measure("encodeText/accented", accented.size(), minTimeMs, counting, [&]() {
+        const unsigned char* text = reinterpret_cast<const unsigned char*>(accented.data());
+        g_sink = encodedTextLength(text, accented.size());
+        g_sink = encodeText(*page, text, accented.size(), out.data()) - out.data();
+    }));
+}
+
+// What the metrics cost a kick: one stage timing, and the per-printer result
+// that every kick records once
+static void runStatsBenchmarks(double minTimeMs, bool counting, std::vector<BenchResult>& results) {
+    const std::string printerName = "EPSON_TM_T20III_Lane_3";
+    OperationResult success;
+
+    results.push_back(measure("StageTimer", 1, minTimeMs, counting, [&]() {
+        StageTimer timer(STAGE_VALIDATE);
+    }));
+
+    results.push_back(measure("recordPrinterResult", 1, minTimeMs, counting, [&]() {
+        recordPrinterResult(printerName, success, StatsClock::now());
+    }));
+
+    // What every traced call site costs while startTrace() is off
+    results.push_back(measure("TraceSpan (tracing off)", 1, minTimeMs, counting, [&]() {
+        TraceSpan span("cupsCreateJob");
+    }));
+}
+
+// ============================================================================
+// Exported N-API functions
+// ============================================================================
+
+// marshalPrinters(layout, count) marshals `count` synthetic printers the way
+// getAvailablePrinters() resolves them. bench/run.js times each call from JS,
+// which is the time the event loop is blocked. Layouts: "namedProperty" (the
+// reference implementation above), "objects" and "columnar".
+napi_value MarshalPrinters(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    char layout[16] = "";
+    size_t length = 0;
+    int64_t count = 0;
+    if (argc < 2 ||
+        napi_get_value_string_utf8(env, args[0], layout, sizeof(layout), &length) != napi_ok ||
+        napi_get_value_int64(env, args[1], &count) != napi_ok || count < 0 || count > 1000000) {
+        napi_throw_type_error(env, nullptr, "Expected (layout, count)");
+        return nullptr;
+    }
+
+    // Built once per size so only marshalling is timed
+    static std::vector<PrinterInfo> printers;
+    if (printers.size() != static_cast<size_t>(count)) printers = syntheticPrinters(static_cast<size_t>(count));
+
+    if (strcmp(layout, "namedProperty") == 0) {
+        napi_value array;
+        NAPI_CALL(env, napi_create_array_with_length(env, printers.size(), &array));
+        for (size_t i = 0; i < printers.size(); i++) {
+            napi_set_element(env, array, static_cast<uint32_t>(i), namedPropertyPrinter(env, printers[i]));
+        }
+        return array;
+    }
+    if (strcmp(layout, "objects") == 0) {
+        return PrintersToArray(env, printers);
+    }
+    if (strcmp(layout, "columnar") == 0) {
+        PrinterMarshaller marshaller(env);
+        return marshaller.toColumns(printers);
+    }
+
+    napi_throw_type_error(env, nullptr, "layout must be namedProperty, objects or columnar");
+    return nullptr;
+}
+
+static bool readSizes(napi_env env, napi_value options, std::vector<size_t>& sizes) {
+    bool has_sizes = false;
+    napi_has_named_property(env, options, "sizes", &has_sizes);
+    if (!has_sizes) return true;
+
+    napi_value array;
+    bool is_array = false;
+    napi_get_named_property(env, options, "sizes", &array);
+    napi_is_array(env, array, &is_array);
+    if (!is_array) return false;
+
+    uint32_t length = 0;
+    napi_get_array_length(env, array, &length);
+    sizes.clear();
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value element;
+        int64_t size = 0;
+        napi_get_element(env, array, i, &element);
+        if (napi_get_value_int64(env, element, &size) != napi_ok || size <= 0 || size > 1000000) {
+            return false;
+        }
+        sizes.push_back(static_cast<size_t>(size));
+    }
+    return true;
+}
+
+// runNativeBenchmarks({ sizes?: number[], minTimeMs?: number })
+napi_value RunNativeBenchmarks(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    std::vector<size_t> sizes = { 10, 100, 1000, 10000 };
+    double minTimeMs = 200;
+
+    if (argc >= 1) {
+        napi_valuetype type;
+        NAPI_CALL(env, napi_typeof(env, args[0], &type));
+        if (type == napi_object) {
+            if (!readSizes(env, args[0], sizes)) {
+                napi_throw_type_error(env, nullptr, "sizes must be an array of positive integers");
+                return nullptr;
+            }
+            bool has_min_time = false;
+            NAPI_CALL(env, napi_has_named_property(env, args[0], "minTimeMs", &has_min_time));
+            if (has_min_time) {
+                napi_value value;
+                NAPI_CALL(env, napi_get_named_property(env, args[0], "minTimeMs", &value));
+                if (napi_get_value_double(env, value, &minTimeMs) != napi_ok || minTimeMs <= 0) {
+                    napi_throw_type_error(env, nullptr, "minTimeMs must be a positive number");
+                    return nullptr;
+                }
+            }
+        }
+    }
+
+    bool counting = allocationCountingWorks();
+
+    std::vector<BenchResult> results;
+    runConfigBenchmarks(env, minTimeMs, counting, results);
+    runEncoderBenchmarks(minTimeMs, counting, results);
+    runStatsBenchmarks(minTimeMs, counting, results);
+    for (size_t i = 0; i < sizes.size(); i++) {
+        runListBenchmarks(sizes[i], minTimeMs, counting, results);
+    }
+
+    napi_value report, array, value;
+    NAPI_CALL(env, napi_create_object(env, &report));
+    NAPI_CALL(env, napi_get_boolean(env, counting, &value));
+    NAPI_CALL(env, napi_set_named_property(env, report, "allocationCounting", value));
+#ifdef NODE_PRINTER_BENCH_ALLOCATIONS
+    NAPI_CALL(env, napi_create_string_utf8(env, "allocations", NAPI_AUTO_LENGTH, &value));
+#else
+    NAPI_CALL(env, napi_create_string_utf8(env, "timing", NAPI_AUTO_LENGTH, &value));
+#endif
+    NAPI_CALL(env, napi_set_named_property(env, report, "build", value));
+
+    NAPI_CALL(env, napi_create_array_with_length(env, results.size(), &array));
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        napi_value entry;
+        NAPI_CALL(env, napi_create_object(env, &entry));
+
+        NAPI_CALL(env, napi_create_string_utf8(env, r.name.c_str(), NAPI_AUTO_LENGTH, &value));
+        NAPI_CALL(env, napi_set_named_property(env, entry, "name", value));
+        NAPI_CALL(env, napi_create_double(env, static_cast<double>(r.size), &value));
+        NAPI_CALL(env, napi_set_named_property(env, entry, "size", value));
+        NAPI_CALL(env, napi_create_double(env, static_cast<double>(r.iterations), &value));
+        NAPI_CALL(env, napi_set_named_property(env, entry, "iterations", value));
+        if (r.nsPerOp < 0) {
+            NAPI_CALL(env, napi_get_null(env, &value));
+            NAPI_CALL(env, napi_set_named_property(env, entry, "nsPerOp", value));
+            NAPI_CALL(env, napi_set_named_property(env, entry, "nsPerItem", value));
+        } else {
+            NAPI_CALL(env, napi_create_double(env, r.nsPerOp, &value));
+            NAPI_CALL(env, napi_set_named_property(env, entry, "nsPerOp", value));
+            NAPI_CALL(env, napi_create_double(env, r.nsPerOp / static_cast<double>(r.size), &value));
+            NAPI_CALL(env, napi_set_named_property(env, entry, "nsPerItem", value));
+        }
+        if (r.allocationsPerOp < 0) {
+            NAPI_CALL(env, napi_get_null(env, &value));
+        } else {
+            NAPI_CALL(env, napi_create_double(env, r.allocationsPerOp, &value));
+        }
+        NAPI_CALL(env, napi_set_named_property(env, entry, "allocationsPerOp", value));
+
+        NAPI_CALL(env, napi_set_element(env, array, static_cast<uint32_t>(i), entry));
+    }
+    NAPI_CALL(env, napi_set_named_property(env, report, "results", array));
+
+    return report;
+}
@@ -0,0 +1,189 @@
+#!/usr/bin/env node
+// Runs the native micro-benchmarks and prints the results as JSON.
+// Timings come from node_printer_bench, built like the production addon;
+// allocation counts from node_printer_bench_alloc, whose build settings
+// would skew timings. Turning a printer list into JS values happens on the
+// event loop, so it is timed from JS one call at a time (eventLoopBlock/*
+// entries).
+//
+//   npm run bench:build
+//   npm run bench -- [--sizes 10,100,1000,10000] [--min-time 200]
+//                    [--out results.json] [--compare baseline.json]
+//                    [--addon path/to/node_printer_bench.node]
+//                    [--alloc-addon path/to/node_printer_bench_alloc.node]
+//
+// With --compare, a per-benchmark change against an earlier run is written
+// to stderr so stdout stays machine-readable.
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+
+function parseArgs(argv) {
+  const args = {
+    sizes: [10, 100, 1000, 10000],
+    minTimeMs: 200,
+    out: null,
+    compare: null,
+    addon: null,
+    allocAddon: null
+  };
+
+  for (let i = 0; i < argv.length; i++) {
+    const flag = argv[i];
+    const value = argv[i + 1];
+    switch (flag) {
+      case '--sizes':
+        args.sizes = value.split(',').map(Number);
+        i++;
+        break;
+      case '--min-time':
+        args.minTimeMs = Number(value);
+        i++;
+        break;
+      case '--out':
+        args.out = value;
+        i++;
+        break;
+      case '--compare':
+        args.compare = value;
+        i++;
+        break;
+      case '--addon':
+        args.addon = value;
+        i++;
+        break;
+      case '--alloc-addon':
+        args.allocAddon = value;
+        i++;
+        break;
+      default:
+        throw new Error(`Unknown argument: ${flag}`);
+    }
+  }
+  return args;
+}
+
+function loadAddon(name, explicitPath, required) {
+  const root = path.join(__dirname, '..');
+  const candidates = explicitPath
+    ? [path.resolve(explicitPath)]
+    : [
+      path.join(root, 'build', 'Release', `${name}.node`),
+      path.join(root, 'build', 'Debug', `${name}.node`)
+    ];
+
+  for (const candidate of candidates) {
+    if (fs.existsSync(candidate)) {
+      return require(candidate);
+    }
+  }
+  if (!required) return null;
+  throw new Error(
+    `${name}.node not found. Build it with: npm run bench:build`
+  );
+}
+
+// Fill in allocationsPerOp from the allocation build's run
+function mergeAllocations(results, allocReport) {
+  const counts = new Map(
+    allocReport.results.map((r) => [`${r.name}@${r.size}`, r.allocationsPerOp])
+  );
+  for (const result of results) {
+    const count = counts.get(`${result.name}@${result.size}`);
+    result.allocationsPerOp = count === undefined ? null : count;
+  }
+}
+
+const MARSHAL_LAYOUTS = ['namedProperty', 'objects', 'columnar'];
+
+// Time individual marshalPrinters() calls; each call is the time
+// getAvailablePrinters() would keep the event loop blocked for that list
+function measureEventLoopBlock(addon, sizes, minTimeMs) {
+  const results = [];
+  for (const size of sizes) {
+    for (const layout of MARSHAL_LAYOUTS) {
+      addon.marshalPrinters(layout, size); // warm-up
+
+      const samples = [];
+      const until = process.hrtime.bigint() + BigInt(Math.round(minTimeMs * 1e6));
+      while (process.hrtime.bigint() < until || samples.length < 5) {
+        const start = process.hrtime.bigint();
+        addon.marshalPrinters(layout, size);
+        samples.push(Number(process.hrtime.bigint() - start));
+      }
+
+      samples.sort((a, b) => a - b);
+      const mean = samples.reduce((a, b) => a + b, 0) / samples.length;
+      results.push({
+        name: `eventLoopBlock/${layout}`,
+        size,
+        iterations: samples.length,
+        nsPerOp: mean,
+        nsPerItem: mean / size,
+        p50Ns: samples[Math.floor(samples.length * 0.5)],
+        p99Ns: samples[Math.min(samples.length - 1, Math.floor(samples.length * 0.99))],
+        allocationsPerOp: null
+      });
+    }
+  }
+  return results;
+}
+
+function compare(baseline, current) {
+  const key = (r) => `${r.name}@${r.size}`;
+  const previous = new Map(baseline.results.map((r) => [key(r), r]));
+
+  const lines = [];
+  for (const result of current.results) {
+    const before = previous.get(key(result));
+    if (!before) continue;
+    const change = ((result.nsPerOp - before.nsPerOp) / before.nsPerOp) * 100;
+    const sign = change >= 0 ? '+' : '';
+    lines.push(
+      `${key(result).padEnd(40)} ${before.nsPerOp.toFixed(1).padStart(14)} -> ` +
+      `${result.nsPerOp.toFixed(1).padStart(14)} ns/op  ${sign}${change.toFixed(1)}%`
+    );
+  }
+  return lines.join('\n');
+}
+
+function main() {
+  const args = parseArgs(process.argv.slice(2));
+  const addon = loadAddon('node_printer_bench', args.addon, true);
+  const allocAddon = loadAddon('node_printer_bench_alloc', args.allocAddon, false);
+
+  const report = addon.runNativeBenchmarks({
+    sizes: args.sizes,
+    minTimeMs: args.minTimeMs
+  });
+  let allocationCounting = false;
+  if (allocAddon) {
+    const allocReport = allocAddon.runNativeBenchmarks({ sizes: args.sizes });
+    allocationCounting = allocReport.allocationCounting;
+    mergeAllocations(report.results, allocReport);
+  }
+
+  const output = {
+    node: process.version,
+    platform: os.platform(),
+    arch: os.arch(),
+    cpu: os.cpus()[0] ? os.cpus()[0].model : 'unknown',
+    date: new Date().toISOString(),
+    allocationCounting,
+    results: report.results.concat(measureEventLoopBlock(addon, args.sizes, args.minTimeMs))
+  };
+
+  const json = JSON.stringify(output, null, 2);
+  if (args.out) {
+    fs.writeFileSync(args.out, json + '\n');
+  }
+  console.log(json);
+
+  if (args.compare) {
+    const baseline = JSON.parse(fs.readFileSync(args.compare, 'utf8'));
+    console.error(compare(baseline, output));
+  }
+}
+
+main();
@@ -0,0 +1,121 @@
+// Micro-benchmark: connection-detail parsing, std::regex (previous
+// implementation) versus the scanners in src/uri.cc.
+//
+//   node-gyp rebuild --build_benchmarks=true
+//   ./build/Release/uri_parse_bench [iterations]
+
+#include "../src/uri.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <regex>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Previous implementation (kept verbatim for comparison)
+// ============================================================================
+
+static bool regexExtractIPv4(const std::string& str, std::string& ip, int& port) {
+    std::regex ipPattern(R"((\d{1,3}\.\d{1,3}\.\d{1,3}\.\d{1,3})(?::(\d+))?)");
+    std::smatch match;
+
+    if (std::regex_search(str, match, ipPattern)) {
+        ip = match[1].str();
+        if (match[2].matched) {
+            port = std::stoi(match[2].str());
+        }
+        return true;
+    }
+    return false;
+}
+
+static bool regexExtractBluetoothAddress(const std::string& str, std::string& btAddr) {
+    std::regex btPattern(R"(([0-9A-Fa-f]{2}[:\-]){5}[0-9A-Fa-f]{2})");
+    std::smatch match;
+
+    if (std::regex_search(str, match, btPattern)) {
+        btAddr = match[0].str();
+        return true;
+    }
+
+    std::regex btPatternNoSep(R"(([0-9A-Fa-f]{12}))");
+    if (std::regex_search(str, match, btPatternNoSep)) {
+        std::string raw = match[1].str();
+        btAddr = raw.substr(0, 2) + ":" + raw.substr(2, 2) + ":" +
+                 raw.substr(4, 2) + ":" + raw.substr(6, 2) + ":" +
+                 raw.substr(8, 2) + ":" + raw.substr(10, 2);
+        return true;
+    }
+    return false;
+}
+
+// ============================================================================
+// Harness
+// ============================================================================
+
+static const char* NETWORK_URIS[] = {
+    "socket://192.168.1.100:9100",
+    "socket://10.0.0.25",
+    "ipp://192.168.20.5/ipp/print",
+    "ipps://10.10.1.1:443/printers/receipt",
+    "lpd://172.16.0.9/queue",
+    "ipp://printer-lane3.local:631/ipp/print",
+};
+
+static const char* BLUETOOTH_URIS[] = {
+    "bluetooth://00:11:22:33:44:55",
+    "bth://001122AABBCC",
+};
+
+template <typename Fn>
+static double nsPerOp(size_t iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) fn(i);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+}
+
+int main(int argc, char** argv) {
+    size_t iterations = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 200000;
+    const size_t networkCount = sizeof(NETWORK_URIS) / sizeof(NETWORK_URIS[0]);
+    const size_t bluetoothCount = sizeof(BLUETOOTH_URIS) / sizeof(BLUETOOTH_URIS[0]);
+
+    std::vector<std::string> network(NETWORK_URIS, NETWORK_URIS + networkCount);
+    std::vector<std::string> bluetooth(BLUETOOTH_URIS, BLUETOOTH_URIS + bluetoothCount);
+    volatile size_t sink = 0;
+
+    double regexNetwork = nsPerOp(iterations, [&](size_t i) {
+        std::string ip;
+        int port = 0;
+        regexExtractIPv4(network[i % networkCount], ip, port);
+        sink += ip.size() + static_cast<size_t>(port);
+    });
+    double scanNetwork = nsPerOp(iterations, [&](size_t i) {
+        const std::string& uri = network[i % networkCount];
+        UriParts parts;
+        parseUri(uri.data(), uri.size(), parts);
+        sink += parts.host.length + static_cast<size_t>(parts.port);
+    });
+
+    double regexBluetooth = nsPerOp(iterations, [&](size_t i) {
+        std::string address;
+        regexExtractBluetoothAddress(bluetooth[i % bluetoothCount], address);
+        sink += address.size();
+    });
+    double scanBluetooth = nsPerOp(iterations, [&](size_t i) {
+        const std::string& uri = bluetooth[i % bluetoothCount];
+        char address[18];
+        sink += scanBluetoothAddress(uri.data(), uri.size(), address) ? 1 : 0;
+    });
+
+    std::printf("{\"iterations\":%zu,\"results\":[", iterations);
+    std::printf("{\"name\":\"network_uri\",\"regex_ns_per_op\":%.1f,\"scanner_ns_per_op\":%.1f,\"speedup\":%.1f},",
+                regexNetwork, scanNetwork, regexNetwork / scanNetwork);
+    std::printf("{\"name\":\"bluetooth_address\",\"regex_ns_per_op\":%.1f,\"scanner_ns_per_op\":%.1f,\"speedup\":%.1f}",
+                regexBluetooth, scanBluetooth, regexBluetooth / scanBluetooth);
+    std::printf("]}\n");
+    return sink == 0 ? 1 : 0;
+}
@@ -1,12 +1,34 @@
 {
+  "variables": {
+    "build_benchmarks%": "false",
+    "printer_sources": [
+      "src/addon.cc",
+      "src/blocklist.cc",
+      "src/printers.cc",
+      "src/cashdrawer.cc",
+      "src/cupspool.cc",
+      "src/destcache.cc",
+      "src/drawerhandle.cc",
+      "src/drawerstatus.cc",
+      "src/escpos.cc",
+      "src/failover.cc",
+      "src/jobtracker.cc",
+      "src/nameindex.cc",
+      "src/raster.cc",
+      "src/scheduler.cc",
+      "src/snapshot.cc",
+      "src/stats.cc",
+      "src/trace.cc",
+      "src/transport.cc",
+      "src/uri.cc",
+      "src/watcher.cc",
+      "src/workpool.cc"
+    ]
+  },
   "targets": [
     {
       "target_name": "node_printer",
-      "sources": [
-        "src/addon.cc",
-        "src/printers.cc",
-        "src/cashdrawer.cc"
-      ],
+      "sources": ["<@(printer_sources)"],
       "include_dirs": ["<!@(node -p \"require('node-addon-api').include\")"],
       "dependencies": ["<!(node -p \"require('node-addon-api').gyp\")"],
       "defines": ["NAPI_DISABLE_CPP_EXCEPTIONS"],
@@ -45,11 +67,134 @@
               "-std=c++11"
             ],
             "libraries": [
-              "-lcups"
+              "-lcups",
+              "-ldl"
             ]
           }
         ]
       ]
     }
+  ],
+  "conditions": [
+    [
+      'build_benchmarks=="true"',
+      {
+        "targets": [
+          {
+            # Timings: the production addon's flags, no allocation hooks
+            "target_name": "node_printer_bench",
+            "sources": [
+              "<@(printer_sources)",
+              "bench/native_bench.cc"
+            ],
+            "include_dirs": ["<!@(node -p \"require('node-addon-api').include\")"],
+            "dependencies": ["<!(node -p \"require('node-addon-api').gyp\")"],
+            "defines": ["NAPI_DISABLE_CPP_EXCEPTIONS", "NODE_PRINTER_BENCHMARKS"],
+            "cflags!": ["-fno-exceptions"],
+            "cflags_cc!": ["-fno-exceptions"],
+            "conditions": [
+              [
+                'OS=="win"',
+                {
+                  "libraries": ["-lwinspool"],
+                  "msvs_settings": {
+                    "VCCLCompilerTool": {
+                      "ExceptionHandling": 1
+                    }
+                  }
+                }
+              ],
+              [
+                'OS=="mac"',
+                {
+                  "xcode_settings": {
+                    "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+                    "OTHER_CFLAGS": ["-std=c++11"],
+                    "OTHER_LDFLAGS": ["-lcups"]
+                  }
+                }
+              ],
+              [
+                'OS=="linux"',
+                {
+                  "cflags": ["-std=c++11"],
+                  "libraries": ["-lcups", "-ldl"]
+                }
+              ]
+            ]
+          },
+          {
+            # Allocation counts only; never timed
+            "target_name": "node_printer_bench_alloc",
+            "sources": [
+              "<@(printer_sources)",
+              "bench/native_bench.cc"
+            ],
+            "include_dirs": ["<!@(node -p \"require('node-addon-api').include\")"],
+            "dependencies": ["<!(node -p \"require('node-addon-api').gyp\")"],
+            "defines": [
+              "NAPI_DISABLE_CPP_EXCEPTIONS",
+              "NODE_PRINTER_BENCHMARKS",
+              "NODE_PRINTER_BENCH_ALLOCATIONS"
+            ],
+            "cflags!": ["-fno-exceptions"],
+            "cflags_cc!": ["-fno-exceptions"],
+            "conditions": [
+              [
+                'OS=="win"',
+                {
+                  "libraries": ["-lwinspool"],
+                  "msvs_settings": {
+                    "VCCLCompilerTool": {
+                      "ExceptionHandling": 1
+                    }
+                  }
+                }
+              ],
+              [
+                'OS=="mac"',
+                {
+                  "xcode_settings": {
+                    "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+                    "OTHER_CFLAGS": ["-std=c++11"],
+                    "OTHER_LDFLAGS": ["-lcups"]
+                  }
+                }
+              ],
+              [
+                'OS=="linux"',
+                {
+                  "cflags": ["-std=c++11"],
+                  "libraries": ["-lcups", "-ldl"],
+                  # Let bench/native_bench.cc count allocations: bind
+                  # operator new locally and keep std::string out of the
+                  # prebuilt libstdc++ instantiation
+                  "defines": ["_GLIBCXX_ASSERTIONS"],
+                  "ldflags": ["-Wl,-Bsymbolic-functions"]
+                }
+              ]
+            ]
+          },
+          {
+            "target_name": "uri_parse_bench",
+            "type": "executable",
+            "sources": [
+              "bench/uri_parse_bench.cc",
+              "src/uri.cc"
+            ],
+            "cflags!": ["-fno-exceptions"],
+            "cflags_cc!": ["-fno-exceptions"],
+            "xcode_settings": {
+              "GCC_ENABLE_CPP_EXCEPTIONS": "YES"
+            },
+            "msvs_settings": {
+              "VCCLCompilerTool": {
+                "ExceptionHandling": 1
+              }
+            }
+          }
+        ]
+      }
+    ]
   ]
-}
\ No newline at end of file
+}
@@ -4,6 +4,31 @@ const addon = require('node-gyp-build')(__dirname);
 
 module.exports = {
   openCashDrawer: addon.openCashDrawer,
+  openCashDrawers: addon.openCashDrawers,
+  openDrawerHandle: addon.openDrawerHandle,
+  sendRaw: addon.sendRaw,
+  encodeReceipt: addon.encodeReceipt,
+  encodeRasterImage: addon.encodeRasterImage,
+  DrawerHandle: addon.DrawerHandle,
+  getDrawerStatus: addon.getDrawerStatus,
+  waitForDrawerClosed: addon.waitForDrawerClosed,
   getAvailablePrinters: addon.getAvailablePrinters,
+  watchPrinters: addon.watchPrinters,
+  unwatchPrinters: addon.unwatchPrinters,
+  refreshPrinters: addon.refreshPrinters,
+  setPrinterCacheTtl: addon.setPrinterCacheTtl,
+  configureScheduler: addon.configureScheduler,
+  configureWorkerPool: addon.configureWorkerPool,
+  getWorkerPoolStats: addon.getWorkerPoolStats,
+  configureBlocklist: addon.configureBlocklist,
+  setPrinterAliases: addon.setPrinterAliases,
+  resolvePrinterName: addon.resolvePrinterName,
+  getQueueDepth: addon.getQueueDepth,
+  getCupsConnectionStats: addon.getCupsConnectionStats,
+  getStats: addon.getStats,
+  resetStats: addon.resetStats,
+  startTrace: addon.startTrace,
+  stopTrace: addon.stopTrace,
+  dumpTrace: addon.dumpTrace,
   PrinterErrorCodes: addon.PrinterErrorCodes
 };
\ No newline at end of file
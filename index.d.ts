@@ -16,6 +16,18 @@ export enum PrinterErrorCodes {
   PRINTER_OTHER_ERROR = 1007,
   /** Attempted to use a virtual printer (PDF, XPS, Fax, etc.) */
   PRINTER_VIRTUAL_BLOCKED = 1008,
+  /** Too many jobs are already queued for the printer */
+  PRINTER_QUEUE_FULL = 1009,
+  /** kick() was called on a DrawerHandle after close() */
+  PRINTER_HANDLE_CLOSED = 1010,
+  /** waitForDrawerClosed(): the drawer was still open at the timeout; awaitCompletion: the job had not finished */
+  PRINTER_TIMEOUT = 1011,
+  /** The printer can't report its drawer status (no answer, or no bidirectional transport) */
+  PRINTER_STATUS_UNAVAILABLE = 1012,
+  /** awaitCompletion: the spooler canceled or aborted the job */
+  PRINTER_JOB_FAILED = 1013,
+  /** The printer name matches more than one queue once case and separators are ignored */
+  PRINTER_AMBIGUOUS_NAME = 1014,
 }
 
 export interface DrawerOptions {
@@ -25,12 +37,54 @@ export interface DrawerOptions {
   pulseOnTime?: number;
   /** Pulse off time (0-255). Default: 250 (~500ms) */
   pulseOffTime?: number;
+  /**
+   * How the command is handed to CUPS (macOS/Linux only).
+   * "stream" writes it straight into the job; "file" spools a temporary file. Default: "stream"
+   */
+  spool?: "stream" | "file";
+  /**
+   * How the command reaches the printer. "spooler" goes through the Windows spooler or CUPS;
+   * "tcp" writes straight to a network printer's raw port and "device" to a USB, parallel
+   * or serial device node (macOS/Linux). Default: "spooler"
+   */
+  transport?: "spooler" | "tcp" | "device";
+  /** tcp: printer address. Default: host of the queue's socket:// device URI */
+  host?: string;
+  /** tcp: printer port. Default: 9100 */
+  port?: number;
+  /** tcp: connect timeout in milliseconds; does not cover resolving a hostname. Default: 3000 */
+  connectTimeout?: number;
+  /** tcp/device: write timeout in milliseconds. Default: 3000 */
+  writeTimeout?: number;
+  /** tcp: how long an idle connection is kept open for reuse, in milliseconds. 0 closes it after each kick. Default: 30000 */
+  keepAlive?: number;
+  /** device: device node, e.g. "/dev/usb/lp0". Default: node named by the queue's device URI */
+  devicePath?: string;
+  /** device: serial baud rate. Default: 9600 (or the queue's serial: URI setting) */
+  baudRate?: number;
+  /** device: serial data bits. Default: 8 */
+  dataBits?: 7 | 8;
+  /** device: serial stop bits. Default: 1 */
+  stopBits?: 1 | 2;
+  /** device: serial parity. Default: "none" */
+  parity?: "none" | "even" | "odd";
+  /** device: serial flow control. Default: "none" */
+  flowControl?: "none" | "hardware" | "software";
+  /**
+   * spooler: settle only once the spooler reports the job finished, instead of once it is queued.
+   * A job still queued at `timeout` resolves with PRINTER_TIMEOUT. Default: false
+   */
+  awaitCompletion?: boolean;
+  /** awaitCompletion: how long the job may take to finish, in milliseconds. Default: 30000 */
+  timeout?: number;
 }
 
 export interface OpenCashDrawerResult {
   success: boolean;
   errorMessage: string;
   errorCode: PrinterErrorCodes;
+  /** awaitCompletion on the spooler transport: milliseconds from the call to seeing the job finished */
+  completionMs?: number;
 }
 
 export enum PrinterStatus {
@@ -60,9 +114,11 @@ export interface PrinterInfo {
   default: boolean;
   status: PrinterStatus;
   type: PrinterType;
-  /** IP address for network printers */
+  /** IP address for network printers (IPv4 or IPv6) */
   ipAddress?: string;
-  /** Port number for network printers (default: 9100 for RAW, 631 for IPP) */
+  /** Host name for network printers addressed by name rather than IP */
+  hostname?: string;
+  /** Port number for network printers (default: 9100 for RAW, 631 for IPP, 515 for LPD) */
   port?: number;
   /** Bluetooth MAC address for Bluetooth printers */
   bluetoothAddress?: string;
@@ -79,9 +135,523 @@ export declare function openCashDrawer(
   options?: DrawerOptions
 ): Promise<OpenCashDrawerResult>;
 
+export interface FailoverOptions extends DrawerOptions {
+  /**
+   * Also try the next printer once the running attempts have taken this many
+   * milliseconds without an answer; 0 tries every printer at once. By default
+   * the next printer is only tried after an attempt has failed.
+   */
+  hedgeAfterMs?: number;
+}
+
+export interface FailoverAttempt {
+  printerName: string;
+  /** Started while an earlier attempt was still running */
+  hedged: boolean;
+  /** Still running when the call settled; the remaining fields are absent */
+  pending: boolean;
+  success?: boolean;
+  errorCode?: PrinterErrorCodes;
+  errorMessage?: string;
+  elapsedMs?: number;
+}
+
+export interface FailoverResult extends OpenCashDrawerResult {
+  /** The printer that opened the drawer, or null if every attempt failed */
+  printerName: string | null;
+  /** The successful attempt was a hedge */
+  hedged: boolean;
+  /** Every attempt started, in the order they were started */
+  attempts: FailoverAttempt[];
+}
+
+/**
+ * Tries printers in order until one opens the drawer, e.g. a lane with a
+ * backup printer wired to the same drawer.
+ * @param printerNames - Printers to try, in order (at most 16).
+ * @param options - Drawer options, applied to every printer, and hedging.
+ * @returns A promise that resolves to the first success, or the failure of every attempt.
+ */
+export declare function openCashDrawer(
+  printerNames: string[],
+  options?: FailoverOptions
+): Promise<FailoverResult>;
+
+export interface CashDrawerRequest {
+  /** The name of the printer connected to the cash drawer. */
+  printerName: string;
+  /** Optional configuration for this drawer's command. */
+  options?: DrawerOptions;
+}
+
+export interface BatchOptions {
+  /** Maximum number of kicks in flight (1-64). Default: 8 */
+  concurrency?: number;
+}
+
+export interface BatchCashDrawerResult extends OpenCashDrawerResult {
+  printerName: string;
+}
+
+/**
+ * Opens several cash drawers in one native call, e.g. every lane at shift change.
+ * Entries are validated together and submitted in parallel on native threads.
+ * @param requests - Printers to kick, each with optional drawer options.
+ * @param batchOptions - Optional batch configuration.
+ * @returns A promise that resolves to one result per request, in request order.
+ */
+export declare function openCashDrawers(
+  requests: CashDrawerRequest[],
+  batchOptions?: BatchOptions
+): Promise<BatchCashDrawerResult[]>;
+
+export interface SendRawOptions extends DrawerOptions {
+  /** Append the drawer command (built from pin/pulse options) after the data, in the same job. Default: false */
+  appendDrawerKick?: boolean;
+}
+
+/**
+ * Sends raw bytes (e.g. an ESC/POS receipt) to the printer as one job, optionally
+ * followed by the drawer kick. The data is read in place on a native thread, not
+ * copied; don't modify it until the promise settles.
+ * @param printerName - The name of the printer.
+ * @param data - Bytes to send as they are.
+ * @param options - Drawer and transport options.
+ */
+export declare function sendRaw(
+  printerName: string,
+  data: Uint8Array | ArrayBuffer,
+  options?: SendRawOptions
+): Promise<OpenCashDrawerResult>;
+
+export type EscPosCodePage = "cp437" | "cp858" | "cp1252";
+
+/** Formatting for encodeReceipt(); settings apply before `text`, then `feed` and `cut` */
+export interface ReceiptDirective {
+  /** Switch the printer's code page (ESC t) for this and later text */
+  codePage?: EscPosCodePage;
+  /** Justification (ESC a) */
+  align?: "left" | "center" | "right";
+  /** Emphasised printing on or off (ESC E) */
+  bold?: boolean;
+  /** Text in the current code page; bytes are read as UTF-8 */
+  text?: string | Uint8Array;
+  /** Print and feed this many lines, 0-255 (ESC d) */
+  feed?: number;
+  /** Cut the paper (GS V); true is a full cut */
+  cut?: true | "full" | "partial";
+}
+
+export interface EncodeReceiptOptions {
+  /** Code page selected at the start. Default: "cp437" */
+  codePage?: EscPosCodePage;
+  /** Start with ESC @ to reset the printer's formatting. Default: true */
+  initialize?: boolean;
+}
+
+/**
+ * Encodes receipt text and formatting into one ESC/POS byte stream for sendRaw().
+ * Characters the code page lacks print as "?". Throws on invalid items.
+ * @param items - Text and directives, in order.
+ * @param options - Optional encoder settings.
+ */
+export declare function encodeReceipt(
+  items: Array<string | ReceiptDirective>,
+  options?: EncodeReceiptOptions
+): Buffer;
+
+export interface RasterImageOptions {
+  /** Diffuse the rounding error (Floyd-Steinberg) instead of thresholding each pixel. Default: true */
+  dither?: boolean;
+  /** Gray level (0-255) below which a dot is printed. Default: 128 */
+  threshold?: number;
+}
+
+/**
+ * Encodes an RGBA image as an ESC/POS GS v 0 raster command for sendRaw().
+ * Transparent pixels are white. Recent results are cached. Throws on invalid input.
+ * @param rgba - width * height * 4 bytes, row by row.
+ * @param width - Image width in pixels.
+ * @param height - Image height in pixels.
+ * @param options - Optional conversion settings.
+ */
+export declare function encodeRasterImage(
+  rgba: Uint8Array | Uint8ClampedArray | ArrayBuffer,
+  width: number,
+  height: number,
+  options?: RasterImageOptions
+): Buffer;
+
+/**
+ * A cash drawer with its transport kept open between kicks.
+ * Created by openDrawerHandle(); the constructor is not public.
+ */
+export declare class DrawerHandle {
+  private constructor();
+  readonly printerName: string;
+  readonly transport: "spooler" | "tcp" | "device";
+  /** True once close() was called */
+  readonly closed: boolean;
+  /** Opens the drawer over the open transport. After close() resolves with PRINTER_HANDLE_CLOSED. */
+  kick(): Promise<OpenCashDrawerResult>;
+  /** Closes the transport once kicks already queued have run. Safe to call more than once. */
+  close(): Promise<void>;
+}
+
+/** Rejection from openDrawerHandle() */
+export interface DrawerHandleError extends Error {
+  errorCode: PrinterErrorCodes;
+}
+
+/**
+ * Opens a persistent handle to one cash drawer. The printer is validated and
+ * its transport resolved and opened once; kick() then only sends the command.
+ * @param printerName - The name of the printer connected to the cash drawer.
+ * @param options - Drawer options, as for openCashDrawer().
+ * @returns A promise for the handle; rejects with a DrawerHandleError if the printer can't be opened.
+ */
+export declare function openDrawerHandle(
+  printerName: string,
+  options?: DrawerOptions
+): Promise<DrawerHandle>;
+
+export interface DrawerStatusOptions extends DrawerOptions {
+  /**
+   * Drawer sensor level that means "open". Most drawers pull the sensor low when
+   * open; use "high" for drawers wired the other way. Default: "low"
+   */
+  drawerOpenLevel?: "low" | "high";
+}
+
+export interface WaitForDrawerClosedOptions extends DrawerStatusOptions {
+  /** Give up after this many milliseconds. Default: 30000 */
+  timeout?: number;
+  /** Time between status requests in milliseconds (at least 50). Default: 200 */
+  intervalMs?: number;
+}
+
+export interface DrawerStatusResult extends OpenCashDrawerResult {
+  /** Present on success */
+  drawerOpen?: boolean;
+}
+
+/**
+ * Reads whether the drawer is open with the ESC/POS real-time status request (DLE EOT 1).
+ * Uses raw TCP or the device node; with the "spooler" transport, the queue's socket://
+ * or device URI. Not supported on Windows.
+ * @param printerName - The name of the printer connected to the cash drawer.
+ * @param options - Transport options and the sensor level.
+ */
+export declare function getDrawerStatus(
+  printerName: string,
+  options?: DrawerStatusOptions
+): Promise<DrawerStatusResult>;
+
+/**
+ * Resolves once the drawer reads closed, or with PRINTER_TIMEOUT if it is still open
+ * after `timeout`. A native thread waits on the printer connection; JS does not poll.
+ * @param printerName - The name of the printer connected to the cash drawer.
+ * @param options - Transport options, sensor level, timeout and query interval.
+ */
+export declare function waitForDrawerClosed(
+  printerName: string,
+  options?: WaitForDrawerClosedOptions
+): Promise<DrawerStatusResult>;
+
+/** Printer list with one array per field; `null` where a printer has no value */
+export interface PrinterColumns {
+  length: number;
+  name: string[];
+  default: boolean[];
+  status: PrinterStatus[];
+  type: PrinterType[];
+  ipAddress: (string | null)[];
+  port: (number | null)[];
+  hostname: (string | null)[];
+  bluetoothAddress: (string | null)[];
+}
+
+export interface PrinterListOptions {
+  /** Shape of printer lists. "columnar" is cheaper to build for long lists. Default: "objects" */
+  layout?: "objects" | "columnar";
+}
+
+export interface PrinterDeltaOptions extends PrinterListOptions {
+  /** Generation from an earlier delta result; 0 requests the full list */
+  since: number;
+}
+
+export interface PrinterDelta<List = PrinterInfo[]> {
+  /** Pass as `since` next time */
+  generation: number;
+  /** The `since` generation was unknown or too old; `added` holds every printer */
+  full: boolean;
+  /** Printers that appeared after `since` (may replace an entry the caller already holds) */
+  added: List;
+  /** Printers whose status, type or address changed after `since` */
+  changed: List;
+  /** Names of printers that disappeared after `since` */
+  removed: string[];
+}
+
 /**
  * Gets a list of available printers on the system.
  * Cross-platform: Works on Windows, macOS, and Linux.
+ * With `since`, resolves only the printers added, changed or removed after
+ * that generation, plus the new generation.
+ * @param options - Optional generation and list layout.
  * @returns A promise that resolves to an array of printer information objects.
  */
 export declare function getAvailablePrinters(): Promise<PrinterInfo[]>;
+export declare function getAvailablePrinters(options: PrinterDeltaOptions & { layout: "columnar" }): Promise<PrinterDelta<PrinterColumns>>;
+export declare function getAvailablePrinters(options: PrinterDeltaOptions): Promise<PrinterDelta>;
+export declare function getAvailablePrinters(options: { layout: "columnar" }): Promise<PrinterColumns>;
+export declare function getAvailablePrinters(options?: PrinterListOptions): Promise<PrinterInfo[]>;
+
+export interface PrinterChange {
+  /** "added" for new printers (and every printer in the first callback), "removed" or "changed" */
+  type: "added" | "removed" | "changed";
+  /** Current state, or the last known state for removed printers */
+  printer: PrinterInfo;
+}
+
+export interface WatchOptions {
+  /** How often the print system is polled, in milliseconds (at least 100). Default: 2000 */
+  intervalMs?: number;
+}
+
+export interface PrinterWatcher {
+  /** Stops watching. An open watcher keeps the process alive. */
+  close(): void;
+}
+
+/**
+ * Watches the print system and reports only what changed, instead of polling
+ * getAvailablePrinters(). The first callback lists every current printer as "added".
+ * @param callback - Receives the changed printers.
+ * @param options - Optional watch configuration.
+ */
+export declare function watchPrinters(
+  callback: (changes: PrinterChange[]) => void,
+  options?: WatchOptions
+): PrinterWatcher;
+
+/**
+ * Drops all cached printer destinations so the next operation re-resolves
+ * queues from the print system. Call this after adding or removing printers.
+ */
+export declare function refreshPrinters(): void;
+
+/**
+ * Sets how long resolved printer destinations are cached.
+ * @param ttlMs - Cache lifetime in milliseconds (default: 60000). 0 disables caching.
+ */
+export declare function setPrinterCacheTtl(ttlMs: number): void;
+
+export interface SchedulerOptions {
+  /**
+   * Merge an identical kick arriving within this many milliseconds of the previous one
+   * into a single job; every caller receives the shared result. Default: 0 (disabled)
+   */
+  coalesceWindowMs?: number;
+  /** Jobs a printer may have queued or running before new ones fail with PRINTER_QUEUE_FULL. Default: 32 */
+  maxQueueDepth?: number;
+}
+
+/**
+ * Configures the per-printer job queue.
+ * @param options - Scheduler settings.
+ */
+export declare function configureScheduler(options: SchedulerOptions): void;
+
+export interface WorkerPoolOptions {
+  /** Number of worker threads running printer I/O (1-64). Default: 4 */
+  size?: number;
+  /**
+   * Give each worker its own queue and let idle workers take tasks from busy
+   * ones, instead of one shared queue. Default: false
+   */
+  workStealing?: boolean;
+}
+
+export interface WorkerPoolStats {
+  size: number;
+  workStealing: boolean;
+  /** Workers running a task right now */
+  active: number;
+  /** Tasks waiting for a worker right now */
+  queued: number;
+  /** Most tasks ever waiting at once */
+  peakQueued: number;
+  submitted: number;
+  completed: number;
+  /** Tasks an idle worker took from another worker's queue */
+  stolen: number;
+  /** Total time workers spent running tasks */
+  busyMs: number;
+  /** Time since the pool started */
+  uptimeMs: number;
+  /** busyMs / (size * uptimeMs), 0-1 */
+  utilization: number;
+}
+
+/**
+ * Configures the native worker pool that runs printer I/O off libuv's thread pool.
+ * Reconfiguring starts a new pool; the old one finishes its queued work first.
+ * @param options - Pool settings.
+ */
+export declare function configureWorkerPool(options: WorkerPoolOptions): void;
+
+/**
+ * Gets worker pool counters since the pool was last (re)configured, for sizing it.
+ */
+export declare function getWorkerPoolStats(): WorkerPoolStats;
+
+export interface BlocklistOptions {
+  /** Start over from the built-in patterns and an empty allowlist (applied first) */
+  defaults?: boolean;
+  /** Replace every pattern */
+  replace?: string[];
+  /** Patterns to add */
+  add?: string[];
+  /** Patterns to remove */
+  remove?: string[];
+  /** Replace the allowlist: printer names that are never blocked, ignoring case */
+  allow?: string[];
+}
+
+export interface BlocklistConfig {
+  /** Lowercased, sorted */
+  patterns: string[];
+  allow: string[];
+}
+
+/**
+ * Replaces the printer alias table. Calls taking a printer name accept an alias
+ * in its place, ignoring case and separators.
+ * @param aliases - Alias to printer name, e.g. { "Lane 3 Drawer": "EPSON_TM_T20III" }.
+ */
+export declare function setPrinterAliases(aliases: Record<string, string>): void;
+
+export interface PrinterNameResolution {
+  /** The queue the name resolves to, or the name as given */
+  printerName: string;
+  /**
+   * "exact": a queue name; "alias": a registered alias; "normalized": one queue once case
+   * and separators are ignored; "ambiguous": several such queues; "none": unknown, used as given
+   */
+  matchedBy: "exact" | "alias" | "normalized" | "ambiguous" | "none";
+  /** The matching queues when ambiguous */
+  candidates?: string[];
+}
+
+/**
+ * Shows which queue a printer name resolves to.
+ * @param printerName - A queue name, a differently spelled one, or an alias.
+ */
+export declare function resolvePrinterName(printerName: string): PrinterNameResolution;
+
+/**
+ * Configures the virtual printer blocklist. A printer is blocked when its name
+ * contains a pattern, ignoring ASCII case, and isn't on the allowlist.
+ * @param options - Changes to apply; omit to read the current configuration.
+ */
+export declare function configureBlocklist(options?: BlocklistOptions): BlocklistConfig;
+
+/**
+ * Gets the number of jobs queued or running for a printer.
+ * @param printerName - The printer name.
+ */
+export declare function getQueueDepth(printerName: string): number;
+
+export interface CupsConnectionStats {
+  /** Connections opened to the CUPS server, including reconnects */
+  opened: number;
+  /** Requests served by a connection already in the pool */
+  reused: number;
+  /** Connections re-established after the server dropped them */
+  reconnected: number;
+  /** Connections closed because they were stale, broken, or the pool was full */
+  discarded: number;
+  /** Connections currently idle in the pool */
+  idle: number;
+  /** Connections currently borrowed, including those held by drawer handles */
+  inUse: number;
+}
+
+/**
+ * Gets counters for the pooled connections to the CUPS server.
+ * All zero on Windows.
+ */
+export declare function getCupsConnectionStats(): CupsConnectionStats;
+
+/** Latency distribution. Percentiles are the upper bound of a histogram bucket, within about 25% */
+export interface LatencySummary {
+  count: number;
+  meanMs: number;
+  p50Ms: number;
+  p90Ms: number;
+  p99Ms: number;
+  maxMs: number;
+}
+
+export interface PrinterStats {
+  /** Kicks and raw jobs sent to this printer */
+  requests: number;
+  failures: number;
+  /** Failures by PrinterErrorCodes value */
+  errors: Record<string, number>;
+  /** From validation to result, excluding queue wait and awaitCompletion */
+  latency: LatencySummary;
+}
+
+export interface Stats {
+  /** Milliseconds since the addon loaded or resetStats() was called */
+  windowMs: number;
+  stages: {
+    /** Printer name checks */
+    validate: LatencySummary;
+    /** Time spent waiting in the printer's job queue */
+    queueWait: LatencySummary;
+    /** Destination, endpoint or device resolution */
+    lookup: LatencySummary;
+    /** Temporary file write with spool: "file"; included in submit */
+    spoolFile: LatencySummary;
+    /** Job submission or direct write to the printer */
+    submit: LatencySummary;
+    /** Result waiting for the event loop to settle the promise */
+    completion: LatencySummary;
+    /** Printer enumeration */
+    enumerate: LatencySummary;
+    /** Converting the printer list to JS objects on the event loop */
+    marshal: LatencySummary;
+  };
+  /** Keyed by printer name; "(other)" once 128 printers are tracked */
+  printers: Record<string, PrinterStats>;
+  /** Failures by PrinterErrorCodes value, across printers */
+  errors: Record<string, number>;
+}
+
+/**
+ * Gets latency histograms per stage and counters per printer and error code.
+ */
+export declare function getStats(options?: { format?: "object" }): Stats;
+/** Gets the same metrics in the Prometheus text exposition format. */
+export declare function getStats(options: { format: "prometheus" }): string;
+
+/** Clears every histogram and counter. */
+export declare function resetStats(): void;
+
+export interface TraceOptions {
+  /** Events kept, rounded up to a power of two (256 to 1048576). Default: 16384 */
+  bufferSize?: number;
+}
+
+/** Starts recording trace events, replacing any earlier trace. */
+export declare function startTrace(options?: TraceOptions): void;
+
+/** Stops recording; the buffer is kept until the next startTrace(). */
+export declare function stopTrace(): void;
+
+/** Returns the buffered events as Chrome trace JSON. */
+export declare function dumpTrace(): string;
@@ -4,20 +4,39 @@ const bindings = require("./binding.js");
 const { PrinterErrorCodes } = bindings;
 
 /**
- * Opens the cash drawer connected to the specified printer.
- * @param {string} printerName - The name of the printer connected to the cash drawer.
+ * Opens the cash drawer connected to the specified printer. Given a list of
+ * printers, they are tried in order until one opens the drawer.
+ * @param {string|string[]} printerName - The printer connected to the cash drawer, or printers to try in order (at most 16).
  * @param {Object} [options] - Optional configuration for the drawer command.
  * @param {number} [options.pin=0] - Drawer pin (0 or 1).
  * @param {number} [options.pulseOnTime=50] - Pulse on time (0-255).
  * @param {number} [options.pulseOffTime=250] - Pulse off time (0-255).
- * @returns {Promise<{success: boolean, errorCode: number, errorMessage: string}>}
+ * @param {"stream"|"file"} [options.spool="stream"] - How the command is handed to CUPS (macOS/Linux).
+ * @param {"spooler"|"tcp"|"device"} [options.transport="spooler"] - Send through the print spooler or straight to the printer.
+ * @param {string} [options.host] - tcp: printer address. Defaults to the host of the queue's socket:// URI.
+ * @param {number} [options.port=9100] - tcp: printer port.
+ * @param {number} [options.connectTimeout=3000] - tcp: connect timeout in milliseconds.
+ * @param {number} [options.writeTimeout=3000] - tcp/device: write timeout in milliseconds.
+ * @param {number} [options.keepAlive=30000] - tcp: how long an idle connection is kept open for reuse (0 closes it).
+ * @param {string} [options.devicePath] - device: device node. Defaults to the node named by the queue's device URI.
+ * @param {number} [options.baudRate=9600] - device: serial baud rate.
+ * @param {number} [options.dataBits=8] - device: serial data bits (7 or 8).
+ * @param {number} [options.stopBits=1] - device: serial stop bits (1 or 2).
+ * @param {"none"|"even"|"odd"} [options.parity="none"] - device: serial parity.
+ * @param {"none"|"hardware"|"software"} [options.flowControl="none"] - device: serial flow control.
+ * @param {boolean} [options.awaitCompletion=false] - spooler: settle only once the spooler reports the job finished.
+ * @param {number} [options.timeout=30000] - awaitCompletion: how long the job may take to finish, in milliseconds.
+ * @param {number} [options.hedgeAfterMs] - Printer list: also try the next printer once the running attempts have taken this long (0 tries all at once). By default the next printer is only tried after a failure.
+ * @returns {Promise<{success: boolean, errorCode: number, errorMessage: string, completionMs?: number, printerName?: string|null, hedged?: boolean, attempts?: Array<Object>}>}
+ *   With a printer list, printerName is the printer that opened the drawer and attempts lists every attempt made.
  */
 const openCashDrawer = async (printerName, options = {}) => {
-  if (typeof printerName !== "string") {
+  const isList = Array.isArray(printerName) && printerName.every((name) => typeof name === "string");
+  if (typeof printerName !== "string" && !isList) {
     return {
       success: false,
       errorCode: PrinterErrorCodes.PRINTER_INVALID_NAME,
-      errorMessage: "printerName must be a string.",
+      errorMessage: "printerName must be a string or an array of strings.",
     };
   }
 
@@ -33,6 +52,197 @@ const openCashDrawer = async (printerName, options = {}) => {
   }
 };
 
+/**
+ * Opens several cash drawers in one native call, e.g. every lane at shift change.
+ * Entries are validated together and submitted in parallel on native threads.
+ * @param {Array<{printerName: string, options?: Object}>} requests - Printers to kick, each with optional drawer options.
+ * @param {Object} [batchOptions] - Optional batch configuration.
+ * @param {number} [batchOptions.concurrency=8] - Maximum number of kicks in flight (1-64).
+ * @returns {Promise<Array<{printerName: string, success: boolean, errorCode: number, errorMessage: string}>>} Results in request order.
+ */
+const openCashDrawers = async (requests, batchOptions = {}) => {
+  if (!Array.isArray(requests)) {
+    throw new TypeError("requests must be an array of { printerName, options }.");
+  }
+
+  try {
+    return await bindings.openCashDrawers(requests, batchOptions);
+  } catch (error) {
+    return requests.map((request) => ({
+      printerName: typeof request?.printerName === "string" ? request.printerName : "",
+      success: false,
+      errorCode: PrinterErrorCodes.PRINTER_OTHER_ERROR,
+      errorMessage: error?.message ?? "Failed to open Cash Drawers.",
+    }));
+  }
+};
+
+/**
+ * Sends raw bytes (e.g. an ESC/POS receipt) to the printer as one job,
+ * optionally followed by the drawer kick, so a sale needs a single trip
+ * through the spooler. The data is not copied: the native side reads the
+ * caller's memory while the job runs, so don't modify it until the promise
+ * settles. Jobs go through the same per-printer queue as openCashDrawer(),
+ * behind any pending kicks.
+ * @param {string} printerName - The name of the printer.
+ * @param {Buffer|Uint8Array|ArrayBuffer} data - Bytes to send as they are.
+ * @param {Object} [options] - Drawer and transport options, as for openCashDrawer().
+ * @param {boolean} [options.appendDrawerKick=false] - Append the drawer command after the data.
+ * @returns {Promise<{success: boolean, errorCode: number, errorMessage: string}>}
+ */
+const sendRaw = async (printerName, data, options = {}) => {
+  if (typeof printerName !== "string") {
+    return {
+      success: false,
+      errorCode: PrinterErrorCodes.PRINTER_INVALID_NAME,
+      errorMessage: "printerName must be a string.",
+    };
+  }
+  if (!(data instanceof Uint8Array) && !(data instanceof ArrayBuffer)) {
+    return {
+      success: false,
+      errorCode: PrinterErrorCodes.PRINTER_INVALID_ARGUMENT,
+      errorMessage: "data must be a Buffer, Uint8Array or ArrayBuffer.",
+    };
+  }
+
+  try {
+    return await bindings.sendRaw(printerName, data, options);
+  } catch (error) {
+    return {
+      success: false,
+      errorCode: PrinterErrorCodes.PRINTER_OTHER_ERROR,
+      errorMessage: error?.message ?? "Failed to send raw data.",
+    };
+  }
+};
+
+/**
+ * Encodes receipt text and formatting into one ESC/POS byte stream, ready for
+ * sendRaw(). Strings are transcoded natively from UTF-8 to the printer's code
+ * page; characters the code page lacks print as "?". Directive objects apply
+ * their settings (codePage, align, bold) before their `text`, then `feed` and
+ * `cut`.
+ * @param {Array<string|{text?: string, codePage?: "cp437"|"cp858"|"cp1252", align?: "left"|"center"|"right", bold?: boolean, feed?: number, cut?: true|"full"|"partial"}>} items - Text and directives, in order.
+ * @param {Object} [options] - Optional encoder settings.
+ * @param {"cp437"|"cp858"|"cp1252"} [options.codePage="cp437"] - Code page selected at the start.
+ * @param {boolean} [options.initialize=true] - Start with ESC @ to reset the printer's formatting.
+ * @returns {Buffer}
+ */
+const encodeReceipt = (items, options = {}) => {
+  if (!Array.isArray(items)) {
+    throw new TypeError("items must be an array of strings and directives.");
+  }
+  return bindings.encodeReceipt(items, options);
+};
+
+/**
+ * Encodes an RGBA image, such as a logo drawn on a canvas, as an ESC/POS
+ * GS v 0 raster command for sendRaw(). Pixels are composited over white,
+ * converted to grayscale and reduced to 1 bit, with Floyd-Steinberg error
+ * diffusion by default. Recent results are cached natively, so encoding the
+ * same logo for every receipt only costs a comparison of the pixels.
+ * @param {Uint8Array|Uint8ClampedArray|ArrayBuffer} rgba - width * height * 4 bytes, row by row.
+ * @param {number} width - Image width in pixels; rows are padded to whole bytes.
+ * @param {number} height - Image height in pixels.
+ * @param {Object} [options] - Optional conversion settings.
+ * @param {boolean} [options.dither=true] - Diffuse the rounding error instead of thresholding each pixel.
+ * @param {number} [options.threshold=128] - Gray level (0-255) below which a dot is printed.
+ * @returns {Buffer}
+ */
+const encodeRasterImage = (rgba, width, height, options = {}) => {
+  if (!Number.isInteger(width) || !Number.isInteger(height)) {
+    throw new TypeError("width and height must be integers.");
+  }
+  return bindings.encodeRasterImage(rgba, width, height, options);
+};
+
+/**
+ * Opens a persistent handle to one cash drawer. The printer is validated and
+ * its transport resolved once, and the transport stays open between kicks: a
+ * dedicated CUPS connection (a printer handle on Windows), the raw TCP socket
+ * or the device node. Use it for a drawer that is kicked on every sale.
+ *
+ * `handle.kick()` resolves like openCashDrawer() and goes through the same
+ * per-printer queue. `handle.close()` releases the transport; a handle that
+ * is garbage collected without close() releases it as well, but not promptly.
+ * @param {string} printerName - The name of the printer connected to the cash drawer.
+ * @param {Object} [options] - Drawer options, as for openCashDrawer().
+ * @returns {Promise<DrawerHandle>} Rejects with an Error carrying `errorCode` if the printer can't be opened.
+ */
+const openDrawerHandle = async (printerName, options = {}) => {
+  if (typeof printerName !== "string") {
+    const error = new TypeError("printerName must be a string.");
+    error.errorCode = PrinterErrorCodes.PRINTER_INVALID_NAME;
+    throw error;
+  }
+
+  return bindings.openDrawerHandle(printerName, options);
+};
+
+/**
+ * Reads whether the drawer is open, straight from the printer: sends the
+ * ESC/POS real-time status request (DLE EOT 1) and reads the drawer-sensor
+ * level from the answer. Needs a transport that can read back, so it uses
+ * raw TCP or the device node; with the default "spooler" transport the
+ * queue's socket:// or device URI is used instead. Not supported on Windows.
+ * @param {string} printerName - The name of the printer connected to the cash drawer.
+ * @param {Object} [options] - Transport options, as for openCashDrawer().
+ * @param {"low"|"high"} [options.drawerOpenLevel="low"] - Sensor level that means "open". Most drawers
+ *   pull the sensor low when open; use "high" for drawers wired the other way.
+ * @returns {Promise<{success: boolean, errorCode: number, errorMessage: string, drawerOpen?: boolean}>}
+ */
+const getDrawerStatus = async (printerName, options = {}) => {
+  if (typeof printerName !== "string") {
+    return {
+      success: false,
+      errorCode: PrinterErrorCodes.PRINTER_INVALID_NAME,
+      errorMessage: "printerName must be a string.",
+    };
+  }
+
+  try {
+    return await bindings.getDrawerStatus(printerName, options);
+  } catch (error) {
+    return {
+      success: false,
+      errorCode: PrinterErrorCodes.PRINTER_OTHER_ERROR,
+      errorMessage: error?.message ?? "Failed to read the drawer status.",
+    };
+  }
+};
+
+/**
+ * Resolves once the drawer reads closed, e.g. to hold the next sale until the
+ * cashier shuts the drawer. A native thread queries the printer and sleeps on
+ * its connection between answers; nothing runs in JS while the drawer stays
+ * open. Resolves with PRINTER_TIMEOUT if it is still open after `timeout`.
+ * @param {string} printerName - The name of the printer connected to the cash drawer.
+ * @param {Object} [options] - Transport options, as for getDrawerStatus().
+ * @param {number} [options.timeout=30000] - Give up after this many milliseconds.
+ * @param {number} [options.intervalMs=200] - Time between status requests (at least 50).
+ * @returns {Promise<{success: boolean, errorCode: number, errorMessage: string, drawerOpen?: boolean}>}
+ */
+const waitForDrawerClosed = async (printerName, options = {}) => {
+  if (typeof printerName !== "string") {
+    return {
+      success: false,
+      errorCode: PrinterErrorCodes.PRINTER_INVALID_NAME,
+      errorMessage: "printerName must be a string.",
+    };
+  }
+
+  try {
+    return await bindings.waitForDrawerClosed(printerName, options);
+  } catch (error) {
+    return {
+      success: false,
+      errorCode: PrinterErrorCodes.PRINTER_OTHER_ERROR,
+      errorMessage: error?.message ?? "Failed to wait for the drawer.",
+    };
+  }
+};
+
 // Printer Status Constants
 const PrinterStatus = {
   IDLE: "IDLE",
@@ -60,9 +270,26 @@ const PrinterType = {
 /**
  * Gets a list of available printers on the system.
  * Cross-platform: Works on Windows, macOS, and Linux.
- * @returns {Promise<Array<{name: string, default: boolean, status: string, type: string, ipAddress?: string, port?: number, bluetoothAddress?: string}>>}
+ *
+ * With `{ since }`, resolves only what changed after that generation instead
+ * of the full list. Pass the `generation` of the previous result; start with
+ * `since: 0`, which always yields the full list (`full: true`).
+ *
+ * With `{ layout: "columnar" }`, each printer list is returned as one array
+ * per field (`{ length, name: [], status: [], ... }`, `null` where a printer
+ * has no value), which is cheaper to build for long lists.
+ * @param {Object} [options] - Optional enumeration settings.
+ * @param {number} [options.since] - Generation from an earlier delta result.
+ * @param {"objects"|"columnar"} [options.layout="objects"] - Shape of printer lists.
+ * @returns {Promise<Array<{name: string, default: boolean, status: string, type: string, ipAddress?: string, hostname?: string, port?: number, bluetoothAddress?: string}>|{generation: number, full: boolean, added: Array<Object>, changed: Array<Object>, removed: string[]}>}
  */
-const getAvailablePrinters = async () => {
+const getAvailablePrinters = async (options) => {
+  if (options !== undefined && options !== null) {
+    // Invalid options are reported; enumeration failures already resolve
+    // with an empty list or the last known state
+    return bindings.getAvailablePrinters(options);
+  }
+
   try {
     const printers = await bindings.getAvailablePrinters();
     return printers
@@ -71,5 +298,187 @@ const getAvailablePrinters = async () => {
   }
 };
 
-module.exports = { openCashDrawer, getAvailablePrinters, PrinterStatus, PrinterType, PrinterErrorCodes };
+/**
+ * Watches the print system and reports only what changed, instead of polling
+ * getAvailablePrinters(). One native thread polls for all watchers and diffs
+ * the results; nothing reaches JS while nothing changes. The first callback
+ * lists every current printer as "added". Changes that arrive while the
+ * callback is pending are merged per printer.
+ * @param {function(Array<{type: "added"|"removed"|"changed", printer: Object}>): void} callback - Receives the changed printers.
+ * @param {Object} [options] - Optional watch configuration.
+ * @param {number} [options.intervalMs=2000] - How often the print system is polled (at least 100). With several watchers the shortest interval wins.
+ * @returns {{close: function(): void}} Call close() to stop watching; an open watcher keeps the process alive.
+ */
+const watchPrinters = (callback, options = {}) => {
+  if (typeof callback !== "function") {
+    throw new TypeError("callback must be a function.");
+  }
+
+  const id = bindings.watchPrinters(callback, options);
+  let closed = false;
+  return {
+    close() {
+      if (!closed) {
+        closed = true;
+        bindings.unwatchPrinters(id);
+      }
+    },
+  };
+};
+
+/**
+ * Drops all cached printer destinations so the next operation re-resolves
+ * queues from the print system. Call this after adding or removing printers.
+ */
+const refreshPrinters = () => {
+  bindings.refreshPrinters();
+};
+
+/**
+ * Sets how long resolved printer destinations are cached.
+ * @param {number} ttlMs - Cache lifetime in milliseconds. 0 disables caching.
+ */
+const setPrinterCacheTtl = (ttlMs) => {
+  bindings.setPrinterCacheTtl(ttlMs);
+};
+
+/**
+ * Configures the per-printer job queue.
+ * @param {Object} options - Scheduler settings.
+ * @param {number} [options.coalesceWindowMs=0] - Merge an identical kick arriving within this many
+ *   milliseconds of the previous one into a single job. 0 disables coalescing.
+ * @param {number} [options.maxQueueDepth=32] - Jobs a printer may have queued or running before new
+ *   ones are rejected with PRINTER_QUEUE_FULL.
+ */
+const configureScheduler = (options) => {
+  bindings.configureScheduler(options);
+};
+
+/**
+ * Configures the native worker pool that runs printer I/O (kicks, raw jobs,
+ * handle opens and printer enumeration) off libuv's thread pool.
+ * @param {Object} options - Pool settings.
+ * @param {number} [options.size=4] - Number of worker threads (1-64).
+ * @param {boolean} [options.workStealing=false] - Give each worker its own queue and let idle
+ *   workers take tasks from busy ones, instead of one shared queue.
+ */
+const configureWorkerPool = (options) => {
+  bindings.configureWorkerPool(options);
+};
+
+/**
+ * Gets worker pool counters, for sizing the pool. Counters start over when
+ * the pool is reconfigured.
+ * @returns {{size: number, workStealing: boolean, active: number, queued: number, peakQueued: number,
+ *   submitted: number, completed: number, stolen: number, busyMs: number, uptimeMs: number, utilization: number}}
+ */
+const getWorkerPoolStats = () => bindings.getWorkerPoolStats();
+
+/**
+ * Changes which printers kicks are refused on as virtual printers (PDF
+ * writers, fax queues, ...). A printer is blocked when its name contains a
+ * pattern, ignoring ASCII case, and isn't on the allowlist.
+ * @param {Object} [options] - Omit to read the current configuration.
+ * @param {boolean} [options.defaults] - Start over from the built-in patterns and an empty allowlist.
+ * @param {string[]} [options.replace] - Replace every pattern.
+ * @param {string[]} [options.add] - Patterns to add.
+ * @param {string[]} [options.remove] - Patterns to remove.
+ * @param {string[]} [options.allow] - Replace the allowlist: printer names never blocked, ignoring case.
+ * @returns {{patterns: string[], allow: string[]}} The configuration now in effect.
+ */
+const configureBlocklist = (options) => bindings.configureBlocklist(options);
+
+/**
+ * Replaces the printer alias table. Calls taking a printer name accept an
+ * alias in its place, ignoring case and separators.
+ * @param {Object<string, string>} aliases - Alias to printer name, e.g. { 'Lane 3 Drawer': 'EPSON_TM_T20III' }.
+ */
+const setPrinterAliases = (aliases) => bindings.setPrinterAliases(aliases);
+
+/**
+ * Shows which queue a printer name resolves to.
+ * @param {string} printerName - A queue name, a differently spelled one, or an alias.
+ * @returns {{printerName: string, matchedBy: string, candidates?: string[]}}
+ */
+const resolvePrinterName = (printerName) => bindings.resolvePrinterName(printerName);
+
+/**
+ * Gets the number of jobs queued or running for a printer.
+ * @param {string} printerName - The printer name.
+ * @returns {number}
+ */
+const getQueueDepth = (printerName) => bindings.getQueueDepth(printerName);
+
+/**
+ * Gets counters for the pooled connections to the CUPS server (macOS/Linux;
+ * all zero on Windows). A healthy pool reuses far more than it opens.
+ * @returns {{opened: number, reused: number, reconnected: number, discarded: number, idle: number, inUse: number}}
+ */
+const getCupsConnectionStats = () => bindings.getCupsConnectionStats();
+
+/**
+ * Gets latency histograms for each stage of drawer kicks, raw jobs and printer
+ * enumeration, plus request and error counters per printer. Recording is
+ * always on and costs well under a microsecond per kick.
+ * @param {Object} [options]
+ * @param {"object"|"prometheus"} [options.format="object"] - "prometheus" returns the Prometheus text exposition format.
+ * @returns {Object|string}
+ */
+const getStats = (options) => bindings.getStats(options);
+
+/**
+ * Clears every histogram and counter, starting a new stats window.
+ */
+const resetStats = () => bindings.resetStats();
+
+/**
+ * Starts recording trace events for every stage of every operation into a
+ * ring buffer, replacing any earlier trace. Off by default.
+ * @param {Object} [options]
+ * @param {number} [options.bufferSize=16384] - Events kept, rounded up to a power of two; the oldest are overwritten.
+ */
+const startTrace = (options) => bindings.startTrace(options);
+
+/**
+ * Stops recording. The buffer is kept until the next startTrace().
+ */
+const stopTrace = () => bindings.stopTrace();
+
+/**
+ * Renders the buffered events as Chrome trace JSON for Perfetto or chrome://tracing.
+ * @returns {string}
+ */
+const dumpTrace = () => bindings.dumpTrace();
+
+module.exports = {
+  openCashDrawer,
+  openCashDrawers,
+  openDrawerHandle,
+  sendRaw,
+  encodeReceipt,
+  encodeRasterImage,
+  DrawerHandle: bindings.DrawerHandle,
+  getDrawerStatus,
+  waitForDrawerClosed,
+  getAvailablePrinters,
+  watchPrinters,
+  refreshPrinters,
+  setPrinterCacheTtl,
+  configureScheduler,
+  configureWorkerPool,
+  getWorkerPoolStats,
+  configureBlocklist,
+  setPrinterAliases,
+  resolvePrinterName,
+  getQueueDepth,
+  getCupsConnectionStats,
+  getStats,
+  resetStats,
+  startTrace,
+  stopTrace,
+  dumpTrace,
+  PrinterStatus,
+  PrinterType,
+  PrinterErrorCodes,
+};
    
\ No newline at end of file
@@ -1,5 +1,9 @@
 #include "common.h"
 
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+
 // ============================================================================
 // Export error codes as a JavaScript object
 // ============================================================================
@@ -40,24 +44,234 @@ napi_value GetErrorCodes(napi_env env) {
     napi_create_int32(env, PRINTER_VIRTUAL_BLOCKED, &val);
     napi_set_named_property(env, codes, "PRINTER_VIRTUAL_BLOCKED", val);
 
+    napi_create_int32(env, PRINTER_QUEUE_FULL, &val);
+    napi_set_named_property(env, codes, "PRINTER_QUEUE_FULL", val);
+
+    napi_create_int32(env, PRINTER_HANDLE_CLOSED, &val);
+    napi_set_named_property(env, codes, "PRINTER_HANDLE_CLOSED", val);
+
+    napi_create_int32(env, PRINTER_TIMEOUT, &val);
+    napi_set_named_property(env, codes, "PRINTER_TIMEOUT", val);
+
+    napi_create_int32(env, PRINTER_STATUS_UNAVAILABLE, &val);
+    napi_set_named_property(env, codes, "PRINTER_STATUS_UNAVAILABLE", val);
+
+    napi_create_int32(env, PRINTER_JOB_FAILED, &val);
+    napi_set_named_property(env, codes, "PRINTER_JOB_FAILED", val);
+
+    napi_create_int32(env, PRINTER_AMBIGUOUS_NAME, &val);
+    napi_set_named_property(env, codes, "PRINTER_AMBIGUOUS_NAME", val);
+
     return codes;
 }
 
+// ============================================================================
+// Per-environment addon state
+// ============================================================================
+
+static void FinalizeAddonData(napi_env env, void* data, void* hint) {
+    AddonData* addon = static_cast<AddonData*>(data);
+    if (addon->drawerHandleConstructor != nullptr) {
+        napi_delete_reference(env, addon->drawerHandleConstructor);
+    }
+    delete addon;
+}
+
+AddonData* GetAddonData(napi_env env) {
+    void* data = nullptr;
+    napi_get_instance_data(env, &data);
+    return static_cast<AddonData*>(data);
+}
+
+// ============================================================================
+// Module pinning
+// ============================================================================
+
+// Node unloads an addon when the last worker_threads environment using it
+// exits, but the scheduler, transport and watcher threads are detached and
+// may still be running. Take an extra, never-released reference so the
+// code they execute stays mapped.
+static void pinModule() {
+#ifdef _WIN32
+    HMODULE module;
+    GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_PIN,
+                       reinterpret_cast<LPCSTR>(&pinModule), &module);
+#else
+    Dl_info info;
+    if (dladdr(reinterpret_cast<void*>(&pinModule), &info) && info.dli_fname) {
+        dlopen(info.dli_fname, RTLD_LAZY | RTLD_NODELETE);
+    }
+#endif
+}
+
 // ============================================================================
 // Module initialization
 // ============================================================================
 
 napi_value init(napi_env env, napi_value exports) {
+    pinModule();
+
+    AddonData* data = new AddonData();
+    NAPI_CALL(env, napi_set_instance_data(env, data, FinalizeAddonData, nullptr));
+
+    if (!InitScheduler(env, data)) {
+        napi_throw_error(env, nullptr, "Failed to initialize the printer job scheduler");
+        return nullptr;
+    }
+
+    if (!InitWorkerPool(env, data)) {
+        napi_throw_error(env, nullptr, "Failed to initialize the printer worker pool");
+        return nullptr;
+    }
+
     // Export openCashDrawer
     napi_value open_cashdrawer;
     NAPI_CALL(env, napi_create_function(env, nullptr, 0, OpenCashDrawer, nullptr, &open_cashdrawer));
     NAPI_CALL(env, napi_set_named_property(env, exports, "openCashDrawer", open_cashdrawer));
 
+    // Export openCashDrawers
+    napi_value open_cashdrawers;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, OpenCashDrawers, nullptr, &open_cashdrawers));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "openCashDrawers", open_cashdrawers));
+
+    // Export openDrawerHandle and the DrawerHandle class it returns
+    napi_value drawer_handle_class = DefineDrawerHandle(env, data);
+    if (drawer_handle_class == nullptr) {
+        napi_throw_error(env, nullptr, "Failed to define the DrawerHandle class");
+        return nullptr;
+    }
+    NAPI_CALL(env, napi_set_named_property(env, exports, "DrawerHandle", drawer_handle_class));
+
+    napi_value open_drawer_handle;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, OpenDrawerHandle, nullptr, &open_drawer_handle));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "openDrawerHandle", open_drawer_handle));
+
+    // Export sendRaw
+    napi_value send_raw;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, SendRaw, nullptr, &send_raw));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "sendRaw", send_raw));
+
+    // Export encodeReceipt
+    napi_value encode_receipt;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, EncodeReceipt, nullptr, &encode_receipt));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "encodeReceipt", encode_receipt));
+
+    // Export encodeRasterImage
+    napi_value encode_raster;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, EncodeRasterImage, nullptr, &encode_raster));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "encodeRasterImage", encode_raster));
+
+    // Export getDrawerStatus
+    napi_value get_drawer_status;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, GetDrawerStatus, nullptr, &get_drawer_status));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "getDrawerStatus", get_drawer_status));
+
+    // Export waitForDrawerClosed
+    napi_value wait_for_closed;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, WaitForDrawerClosed, nullptr, &wait_for_closed));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "waitForDrawerClosed", wait_for_closed));
+
     // Export getAvailablePrinters
     napi_value get_printers;
     NAPI_CALL(env, napi_create_function(env, nullptr, 0, GetAvailablePrinters, nullptr, &get_printers));
     NAPI_CALL(env, napi_set_named_property(env, exports, "getAvailablePrinters", get_printers));
 
+    // Export watchPrinters
+    napi_value watch_printers;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, WatchPrinters, nullptr, &watch_printers));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "watchPrinters", watch_printers));
+
+    // Export unwatchPrinters
+    napi_value unwatch_printers;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, UnwatchPrinters, nullptr, &unwatch_printers));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "unwatchPrinters", unwatch_printers));
+
+    // Export refreshPrinters
+    napi_value refresh_printers;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, RefreshPrinters, nullptr, &refresh_printers));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "refreshPrinters", refresh_printers));
+
+    // Export setPrinterCacheTtl
+    napi_value set_cache_ttl;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, SetPrinterCacheTtl, nullptr, &set_cache_ttl));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "setPrinterCacheTtl", set_cache_ttl));
+
+    // Export configureScheduler
+    napi_value configure_scheduler;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, ConfigureScheduler, nullptr, &configure_scheduler));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "configureScheduler", configure_scheduler));
+
+    // Export configureWorkerPool
+    napi_value configure_worker_pool;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, ConfigureWorkerPool, nullptr, &configure_worker_pool));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "configureWorkerPool", configure_worker_pool));
+
+    // Export getWorkerPoolStats
+    napi_value get_worker_pool_stats;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, GetWorkerPoolStats, nullptr, &get_worker_pool_stats));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "getWorkerPoolStats", get_worker_pool_stats));
+
+    // Export configureBlocklist
+    napi_value configure_blocklist;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, ConfigureBlocklist, nullptr, &configure_blocklist));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "configureBlocklist", configure_blocklist));
+
+    // Export setPrinterAliases
+    napi_value set_printer_aliases;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, SetPrinterAliases, nullptr, &set_printer_aliases));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "setPrinterAliases", set_printer_aliases));
+
+    // Export resolvePrinterName
+    napi_value resolve_printer_name;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, ResolvePrinterName, nullptr, &resolve_printer_name));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "resolvePrinterName", resolve_printer_name));
+
+    // Export getCupsConnectionStats
+    napi_value get_cups_stats;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, GetCupsConnectionStats, nullptr, &get_cups_stats));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "getCupsConnectionStats", get_cups_stats));
+
+    // Export getStats
+    napi_value get_stats;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, GetStats, nullptr, &get_stats));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "getStats", get_stats));
+
+    // Export resetStats
+    napi_value reset_stats;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, ResetStats, nullptr, &reset_stats));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "resetStats", reset_stats));
+
+    // Export startTrace
+    napi_value start_trace;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, StartTrace, nullptr, &start_trace));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "startTrace", start_trace));
+
+    // Export stopTrace
+    napi_value stop_trace;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, StopTrace, nullptr, &stop_trace));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "stopTrace", stop_trace));
+
+    // Export dumpTrace
+    napi_value dump_trace;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, DumpTrace, nullptr, &dump_trace));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "dumpTrace", dump_trace));
+
+    // Export getQueueDepth
+    napi_value get_queue_depth;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, GetQueueDepth, nullptr, &get_queue_depth));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "getQueueDepth", get_queue_depth));
+
+#ifdef NODE_PRINTER_BENCHMARKS
+    // Export runNativeBenchmarks (benchmark build only)
+    napi_value run_benchmarks;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, RunNativeBenchmarks, nullptr, &run_benchmarks));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "runNativeBenchmarks", run_benchmarks));
+
+    napi_value marshal_printers;
+    NAPI_CALL(env, napi_create_function(env, nullptr, 0, MarshalPrinters, nullptr, &marshal_printers));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "marshalPrinters", marshal_printers));
+#endif
+
     // Export error codes
     napi_value error_codes = GetErrorCodes(env);
     NAPI_CALL(env, napi_set_named_property(env, exports, "PrinterErrorCodes", error_codes));
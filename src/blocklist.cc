@@ -0,0 +1,310 @@
+#include "common.h"
+#include <algorithm>
+#include <deque>
+#include <mutex>
+
+// ============================================================================
+// Virtual printer blocklist
+// ============================================================================
+//
+// Kicks are refused on printers whose name contains a blocked pattern
+// (PDF writers, fax queues and the like), unless the name is allowlisted.
+// The patterns are compiled into one Aho-Corasick automaton, stored as a
+// dense transition table over the bytes that occur in any pattern, with
+// ASCII case folding built into the byte classes. A check is one pass over
+// the name with a table lookup per byte, whatever the number of patterns,
+// and never allocates. configureBlocklist() builds a new automaton and
+// swaps it in; checks already running keep the one they started with.
+
+// Matched case-insensitively anywhere in the name
+static const char* const DEFAULT_BLOCKED_PATTERNS[] = {
+    "microsoft print to pdf",
+    "microsoft xps document writer",
+    "onenote",
+    "fax",
+    "send to onenote",
+    "adobe pdf",
+    "cute pdf",
+    "cutepdf",
+    "bullzip pdf",
+    "foxit pdf",
+    "pdf24",
+    "dopdf",
+    "pdfcreator"
+};
+
+static const size_t MAX_BLOCKLIST_PATTERNS = 1024;
+static const size_t MAX_BLOCKLIST_BYTES = 8192;  // Bounds the transition table to a few MB
+
+namespace {
+
+char foldCase(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+std::string foldCase(const std::string& text) {
+    std::string folded = text;
+    for (char& c : folded) c = foldCase(c);
+    return folded;
+}
+
+struct BlocklistMatcher {
+    std::vector<std::string> patterns;  // Folded, sorted, unique
+    std::vector<std::string> allowed;   // Folded, sorted, unique
+    uint16_t byteClass[256];            // 0 for bytes in no pattern; up to 256 more classes
+    size_t classCount;
+    std::vector<uint32_t> transitions;  // state * classCount + class -> state
+    std::vector<uint8_t> accepting;     // Some pattern ends at this state
+
+    bool matches(const std::string& name) const;
+    bool isAllowed(const std::string& name) const;
+};
+
+bool BlocklistMatcher::matches(const std::string& name) const {
+    uint32_t state = 0;
+    for (char c : name) {
+        state = transitions[state * classCount + byteClass[static_cast<unsigned char>(c)]];
+        if (accepting[state]) return true;
+    }
+    return false;
+}
+
+bool BlocklistMatcher::isAllowed(const std::string& name) const {
+    for (const auto& allowedName : allowed) {
+        if (allowedName.size() != name.size()) continue;
+        size_t i = 0;
+        while (i < name.size() && foldCase(name[i]) == allowedName[i]) i++;
+        if (i == name.size()) return true;
+    }
+    return false;
+}
+
+void sortUnique(std::vector<std::string>& values) {
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+}
+
+// Builds the trie, then fills every missing transition from the failure
+// links breadth first, which turns it into a DFA
+std::shared_ptr<const BlocklistMatcher> buildMatcher(std::vector<std::string> patterns,
+                                                      std::vector<std::string> allowed) {
+    std::shared_ptr<BlocklistMatcher> matcher = std::make_shared<BlocklistMatcher>();
+    for (auto& pattern : patterns) pattern = foldCase(pattern);
+    for (auto& name : allowed) name = foldCase(name);
+    sortUnique(patterns);
+    sortUnique(allowed);
+
+    // Byte classes: upper and lower case letters share one
+    memset(matcher->byteClass, 0, sizeof(matcher->byteClass));
+    size_t classCount = 1;
+    for (const auto& pattern : patterns) {
+        for (char c : pattern) {
+            uint16_t& cls = matcher->byteClass[static_cast<unsigned char>(c)];
+            if (cls == 0) cls = static_cast<uint16_t>(classCount++);
+        }
+    }
+    for (int c = 'A'; c <= 'Z'; c++) {
+        matcher->byteClass[c] = matcher->byteClass[c - 'A' + 'a'];
+    }
+
+    const uint32_t MISSING = UINT32_MAX;
+    std::vector<uint32_t>& next = matcher->transitions;
+    std::vector<uint8_t>& accepting = matcher->accepting;
+    next.assign(classCount, MISSING);
+    accepting.assign(1, 0);
+
+    for (const auto& pattern : patterns) {
+        uint32_t state = 0;
+        for (char c : pattern) {
+            size_t slot = state * classCount + matcher->byteClass[static_cast<unsigned char>(c)];
+            if (next[slot] == MISSING) {
+                next[slot] = static_cast<uint32_t>(accepting.size());
+                accepting.push_back(0);
+                next.resize(next.size() + classCount, MISSING);
+            }
+            state = next[slot];
+        }
+        accepting[state] = 1;
+    }
+
+    std::vector<uint32_t> failure(accepting.size(), 0);
+    std::deque<uint32_t> queue;
+    for (size_t cls = 0; cls < classCount; cls++) {
+        if (next[cls] == MISSING) {
+            next[cls] = 0;
+        } else {
+            queue.push_back(next[cls]);
+        }
+    }
+    while (!queue.empty()) {
+        uint32_t state = queue.front();
+        queue.pop_front();
+        if (accepting[failure[state]]) accepting[state] = 1;
+
+        for (size_t cls = 0; cls < classCount; cls++) {
+            uint32_t& target = next[state * classCount + cls];
+            uint32_t fallback = next[failure[state] * classCount + cls];
+            if (target == MISSING) {
+                target = fallback;
+            } else {
+                failure[target] = fallback;
+                queue.push_back(target);
+            }
+        }
+    }
+
+    matcher->classCount = classCount;
+    matcher->patterns.swap(patterns);
+    matcher->allowed.swap(allowed);
+    return matcher;
+}
+
+std::shared_ptr<const BlocklistMatcher> defaultMatcher() {
+    return buildMatcher(
+        std::vector<std::string>(std::begin(DEFAULT_BLOCKED_PATTERNS), std::end(DEFAULT_BLOCKED_PATTERNS)),
+        std::vector<std::string>());
+}
+
+// Intentionally leaked: detached workers may still check names during exit
+std::mutex& g_blocklistMutex = *new std::mutex();
+std::shared_ptr<const BlocklistMatcher>& g_blocklist =
+    *new std::shared_ptr<const BlocklistMatcher>(defaultMatcher());
+
+std::shared_ptr<const BlocklistMatcher> currentMatcher() {
+    std::lock_guard<std::mutex> lock(g_blocklistMutex);
+    return g_blocklist;
+}
+
+// Reads options[key] as an array of non-empty printer-name-sized strings
+bool GetPatternArray(napi_env env, napi_value options, const char* key,
+                     std::vector<std::string>& values, bool& present, std::string& error) {
+    present = false;
+    bool has_property;
+    napi_has_named_property(env, options, key, &has_property);
+    if (!has_property) return true;
+
+    napi_value array;
+    napi_get_named_property(env, options, key, &array);
+    napi_valuetype type;
+    napi_typeof(env, array, &type);
+    if (type == napi_undefined) return true;
+
+    bool is_array = false;
+    napi_is_array(env, array, &is_array);
+    uint32_t length = 0;
+    if (!is_array || napi_get_array_length(env, array, &length) != napi_ok || length > MAX_BLOCKLIST_PATTERNS) {
+        error = std::string(key) + " must be an array of at most " + std::to_string(MAX_BLOCKLIST_PATTERNS) + " strings";
+        return false;
+    }
+
+    values.clear();
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value element;
+        napi_get_element(env, array, i, &element);
+        std::string value;
+        if (!GetPrinterNameFromArg(env, element, value) || value.empty()) {
+            error = std::string(key) + " entries must be non-empty strings with max " +
+                    std::to_string(MAX_PRINTER_NAME_LENGTH) + " characters";
+            return false;
+        }
+        values.push_back(value);
+    }
+    present = true;
+    return true;
+}
+
+napi_value StringArray(napi_env env, const std::vector<std::string>& values) {
+    napi_value array, value;
+    napi_create_array_with_length(env, values.size(), &array);
+    for (size_t i = 0; i < values.size(); i++) {
+        napi_create_string_utf8(env, values[i].c_str(), values[i].size(), &value);
+        napi_set_element(env, array, static_cast<uint32_t>(i), value);
+    }
+    return array;
+}
+
+napi_value BlocklistToObject(napi_env env, const BlocklistMatcher& matcher) {
+    napi_value result;
+    napi_create_object(env, &result);
+    napi_set_named_property(env, result, "patterns", StringArray(env, matcher.patterns));
+    napi_set_named_property(env, result, "allow", StringArray(env, matcher.allowed));
+    return result;
+}
+
+} // namespace
+
+// Whether kicks on this printer are refused as a virtual printer
+bool isBlockedVirtualPrinter(const std::string& printerName) {
+    std::shared_ptr<const BlocklistMatcher> matcher = currentMatcher();
+    return matcher->matches(printerName) && !matcher->isAllowed(printerName);
+}
+
+// ============================================================================
+// Exported N-API functions
+// ============================================================================
+
+// configureBlocklist({ replace, add, remove, allow, defaults }) -> { patterns, allow }
+// Applied in that order after an optional reset to the defaults; with no
+// options it returns the current configuration.
+napi_value ConfigureBlocklist(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) napi_typeof(env, args[0], &type);
+    if (type == napi_undefined) return BlocklistToObject(env, *currentMatcher());
+    if (type != napi_object) {
+        napi_throw_type_error(env, nullptr, "Options must be an object");
+        return nullptr;
+    }
+
+    std::vector<std::string> replace, add, remove, allow;
+    bool has_replace, has_add, has_remove, has_allow;
+    std::string error;
+    if (!GetPatternArray(env, args[0], "replace", replace, has_replace, error) ||
+        !GetPatternArray(env, args[0], "add", add, has_add, error) ||
+        !GetPatternArray(env, args[0], "remove", remove, has_remove, error) ||
+        !GetPatternArray(env, args[0], "allow", allow, has_allow, error)) {
+        napi_throw_type_error(env, nullptr, error.c_str());
+        return nullptr;
+    }
+
+    bool defaults = false;
+    bool has_defaults;
+    napi_has_named_property(env, args[0], "defaults", &has_defaults);
+    if (has_defaults) {
+        napi_value value;
+        napi_get_named_property(env, args[0], "defaults", &value);
+        if (napi_get_value_bool(env, value, &defaults) != napi_ok) {
+            napi_throw_type_error(env, nullptr, "defaults must be a boolean");
+            return nullptr;
+        }
+    }
+
+    // Built outside the lock; configuration only changes on the JS thread
+    std::shared_ptr<const BlocklistMatcher> current = defaults ? defaultMatcher() : currentMatcher();
+    std::vector<std::string> patterns = has_replace ? replace : current->patterns;
+    patterns.insert(patterns.end(), add.begin(), add.end());
+    for (const auto& pattern : remove) {
+        std::string folded = foldCase(pattern);
+        patterns.erase(std::remove_if(patterns.begin(), patterns.end(),
+                           [&folded](const std::string& p) { return foldCase(p) == folded; }),
+                       patterns.end());
+    }
+    size_t bytes = 0;
+    for (const auto& pattern : patterns) bytes += pattern.size();
+    if (patterns.size() > MAX_BLOCKLIST_PATTERNS || bytes > MAX_BLOCKLIST_BYTES) {
+        napi_throw_range_error(env, nullptr, "The blocklist holds at most 1024 patterns totalling 8192 characters");
+        return nullptr;
+    }
+
+    std::shared_ptr<const BlocklistMatcher> matcher =
+        buildMatcher(patterns, has_allow ? allow : current->allowed);
+    {
+        std::lock_guard<std::mutex> lock(g_blocklistMutex);
+        g_blocklist = matcher;
+    }
+    return BlocklistToObject(env, *matcher);
+}
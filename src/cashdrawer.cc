@@ -1,133 +1,274 @@
 #include "common.h"
+#include <algorithm>
+#include <atomic>
 
 // ============================================================================
-// Cash Drawer Configuration
+// CUPS job submission
 // ============================================================================
 
-// Default ESC/POS drawer configuration
-static const unsigned char DEFAULT_DRAWER_PIN = 0x00;      // Pin 0 (some drawers use 0x01)
-static const unsigned char DEFAULT_PULSE_ON_TIME = 0x32;   // ~100ms
-static const unsigned char DEFAULT_PULSE_OFF_TIME = 0xFA;  // ~500ms
+#ifndef _WIN32
+static const char* DRAWER_JOB_TITLE = "Open Cash Drawer";
+
+// Stream the data into a raw job straight from memory. Returns the job id,
+// or 0 with the error recorded in result. resendable is set when the
+// failure was a dropped connection before any document data went out.
+static int submitStreamedJob(http_t* http, const std::string& queue, const char* title,
+                             const DataSegment* segments, size_t count, OperationResult& result,
+                             bool& resendable) {
+    resendable = false;
+    int job_id;
+    {
+        TraceSpan span("cupsCreateJob");
+        job_id = cupsCreateJob(http, queue.c_str(), title, 0, NULL);
+    }
+    if (job_id == 0) {
+        // A job created before the answer was lost has no document, so it
+        // never prints
+        resendable = cupsLastError() == IPP_STATUS_ERROR_SERVICE_UNAVAILABLE;
+        result.setError(
+            PRINTER_START_DOC_ERROR,
+            "Failed to send print job to '" + queue + "': " + cupsLastErrorString()
+        );
+        return 0;
+    }
 
-struct DrawerConfig {
-    unsigned char pin;
-    unsigned char pulseOnTime;
-    unsigned char pulseOffTime;
+    // Send-Document: start, data and finish. From here on cupsd may already
+    // hold the document when a response is lost, so nothing is resent.
+    TraceSpan sendDocument("cupsSendDocument");
+    if (cupsStartDocument(http, queue.c_str(), job_id, title,
+                          CUPS_FORMAT_RAW, 1) != HTTP_STATUS_CONTINUE) {
+        result.setError(
+            PRINTER_START_DOC_ERROR,
+            "Failed to start document on '" + queue + "': " + cupsLastErrorString()
+        );
+        cupsCancelJob2(http, queue.c_str(), job_id, 0);
+        return 0;
+    }
 
-    DrawerConfig()
-        : pin(DEFAULT_DRAWER_PIN)
-        , pulseOnTime(DEFAULT_PULSE_ON_TIME)
-        , pulseOffTime(DEFAULT_PULSE_OFF_TIME) {}
+    for (size_t i = 0; i < count; i++) {
+        if (segments[i].length == 0) continue;
+        if (cupsWriteRequestData(http, reinterpret_cast<const char*>(segments[i].data),
+                                 segments[i].length) != HTTP_STATUS_CONTINUE) {
+            cupsFinishDocument(http, queue.c_str());
+            result.setError(
+                PRINTER_WRITE_ERROR,
+                "Failed to write command to '" + queue + "': " + cupsLastErrorString()
+            );
+            cupsCancelJob2(http, queue.c_str(), job_id, 0);
+            return 0;
+        }
+    }
 
-    DrawerConfig(unsigned char p, unsigned char onTime, unsigned char offTime)
-        : pin(p), pulseOnTime(onTime), pulseOffTime(offTime) {}
+    if (cupsFinishDocument(http, queue.c_str()) != IPP_STATUS_OK) {
+        result.setError(
+            PRINTER_WRITE_ERROR,
+            "Failed to finish print job on '" + queue + "': " + cupsLastErrorString()
+        );
+        // Don't leave a half-sent job on the server to print later
+        cupsCancelJob2(http, queue.c_str(), job_id, 0);
+        return 0;
+    }
 
-    // Build the ESC/POS command for opening the drawer
-    std::vector<unsigned char> buildCommand() const {
-        return { 0x1B, 0x70, pin, pulseOnTime, pulseOffTime };
+    return job_id;
+}
+
+// Legacy path: spool the data through a temporary file. cupsPrintFile2()
+// sends the file in the same call that creates the job, so a failure can't
+// be told apart from a lost response and the job is never resent.
+static int submitSpoolFile(http_t* http, const std::string& queue, const char* title,
+                           const DataSegment* segments, size_t count, OperationResult& result) {
+    StageTimer timer(STAGE_SPOOL_FILE);
+    char tempFile[] = "/tmp/drawer_cmd_XXXXXX";
+    int fd = mkstemp(tempFile);
+    if (fd < 0) {
+        int savedErrno = errno;
+        result.setError(
+            PRINTER_WRITE_ERROR,
+            "Failed to create temporary file: " + std::string(std::strerror(savedErrno))
+        );
+        return 0;
     }
-};
 
-// ============================================================================
-// Windows RAII Printer Handle
-// ============================================================================
+    bool complete = true;
+    int writeErrno = 0;
+    for (size_t i = 0; i < count && complete; i++) {
+        ssize_t bytes_written = write(fd, segments[i].data, segments[i].length);
+        writeErrno = errno;
+        complete = bytes_written >= 0 && static_cast<size_t>(bytes_written) == segments[i].length;
+    }
+    close(fd);
+    timer.stop();
 
-#ifdef _WIN32
-class PrinterHandle {
-public:
-    PrinterHandle() : handle_(NULL), docStarted_(false), pageStarted_(false) {}
+    if (!complete) {
+        result.setError(
+            PRINTER_WRITE_ERROR,
+            "Failed to write command to temporary file: " + std::string(std::strerror(writeErrno))
+        );
+        unlink(tempFile);
+        return 0;
+    }
 
-    ~PrinterHandle() {
-        close();
+    int job_id;
+    {
+        TraceSpan span("cupsPrintFile2");
+        job_id = cupsPrintFile2(http, queue.c_str(), tempFile, title, 0, NULL);
     }
+    unlink(tempFile);
 
-    bool open(const std::string& printerName, DWORD* errorCode) {
-        if (!OpenPrinterA(const_cast<char*>(printerName.c_str()), &handle_, NULL)) {
-            if (errorCode) *errorCode = GetLastError();
-            handle_ = NULL;
-            return false;
-        }
-        return true;
+    if (job_id == 0) {
+        result.setError(
+            PRINTER_START_DOC_ERROR,
+            "Failed to send print job to '" + queue + "': " + cupsLastErrorString()
+        );
     }
+    return job_id;
+}
 
-    bool startDoc(const char* docName, DWORD* errorCode) {
-        DOC_INFO_1A docInfo;
-        docInfo.pDocName = const_cast<LPSTR>(docName);
-        docInfo.pOutputFile = nullptr;
-        docInfo.pDatatype = const_cast<LPSTR>("RAW");
+// Submit over a pooled connection. A connection cupsd closed while it sat
+// idle fails Create-Job before anything was sent, so reconnect and retry
+// once; a failure after the document went out is reported, never resent.
+int submitCupsJob(CupsConnection& cups, const std::string& queue, const std::vector<unsigned char>& data,
+                  SpoolMode spool, OperationResult& result) {
+    DataSegment segment = { data.data(), data.size() };
+    return submitCupsJob(cups, queue, DRAWER_JOB_TITLE, &segment, 1, spool, result);
+}
 
-        DWORD jobId = StartDocPrinterA(handle_, 1, reinterpret_cast<LPBYTE>(&docInfo));
-        if (jobId == 0) {
-            if (errorCode) *errorCode = GetLastError();
-            return false;
-        }
-        docStarted_ = true;
-        return true;
+int submitCupsJob(CupsConnection& cups, const std::string& queue, const char* title,
+                  const DataSegment* segments, size_t count, SpoolMode spool, OperationResult& result) {
+    std::string error;
+    // Held across kicks (DrawerHandle); cupsd may have closed it meanwhile
+    if (cups.isOpen()) cups.refresh();
+    if (!cups.isOpen() && !cups.acquire(error)) {
+        result.setError(PRINTER_OPEN_ERROR, error);
+        return 0;
     }
 
-    bool startPage(DWORD* errorCode) {
-        if (!StartPagePrinter(handle_)) {
-            if (errorCode) *errorCode = GetLastError();
-            return false;
-        }
-        pageStarted_ = true;
-        return true;
+    bool resendable = false;
+    int job_id = spool == SPOOL_FILE
+        ? submitSpoolFile(cups.get(), queue, title, segments, count, result)
+        : submitStreamedJob(cups.get(), queue, title, segments, count, result, resendable);
+    if (job_id == 0 && resendable && cups.reconnect()) {
+        result = OperationResult();
+        job_id = submitStreamedJob(cups.get(), queue, title, segments, count, result, resendable);
     }
+    if (job_id == 0) cups.discardIfBroken();
+    result.value = job_id;
+    return job_id;
+}
+#endif
 
-    bool write(const std::vector<unsigned char>& data, DWORD* bytesWritten, DWORD* errorCode) {
-        if (!WritePrinter(handle_, const_cast<unsigned char*>(data.data()),
-                          static_cast<DWORD>(data.size()), bytesWritten)) {
-            if (errorCode) *errorCode = GetLastError();
-            return false;
-        }
-        return true;
+// ============================================================================
+// Direct transports
+// ============================================================================
+
+// Fill in the endpoint from the queue's socket:// URI when no host was given
+bool resolveTcpEndpoint(const std::string& printerName, const DrawerConfig& config,
+                        TcpEndpoint& endpoint, OperationResult& result) {
+    endpoint = config.tcp;
+    if (!endpoint.host.empty()) return true;
+
+#ifndef _WIN32
+    PrinterDestination dest;
+    if (!resolvePrinterDestination(printerName, dest)) {
+        result.setError(
+            PRINTER_OPEN_ERROR,
+            "Printer not found: '" + printerName + "'. Check printer name and installation."
+        );
+        return false;
+    }
+    int port = 0;
+    if (!extractSocketEndpoint(dest.deviceUri, endpoint.host, port)) {
+        result.setError(
+            PRINTER_INVALID_ARGUMENT,
+            "Printer '" + printerName + "' is not a socket:// queue. Pass options.host to use the tcp transport."
+        );
+        return false;
     }
+    endpoint.port = port;
+    return true;
+#else
+    result.setError(PRINTER_INVALID_ARGUMENT, "options.host is required for the tcp transport");
+    return false;
+#endif
+}
 
-    void close() {
-        if (pageStarted_) {
-            EndPagePrinter(handle_);
-            pageStarted_ = false;
-        }
-        if (docStarted_) {
-            EndDocPrinter(handle_);
-            docStarted_ = false;
-        }
-        if (handle_ != NULL) {
-            ClosePrinter(handle_);
-            handle_ = NULL;
-        }
+// Fill in the device node named by the queue's URI when no path was given
+bool resolveDeviceTarget(const std::string& printerName, const DrawerConfig& config,
+                         DeviceTarget& target, OperationResult& result) {
+    target = config.device;
+    if (!target.path.empty()) return true;
+
+#ifndef _WIN32
+    PrinterDestination dest;
+    if (!resolvePrinterDestination(printerName, dest)) {
+        result.setError(
+            PRINTER_OPEN_ERROR,
+            "Printer not found: '" + printerName + "'. Check printer name and installation."
+        );
+        return false;
+    }
+    if (!extractDevicePath(dest.deviceUri, target.path, target.serial)) {
+        result.setError(
+            PRINTER_INVALID_ARGUMENT,
+            "Printer '" + printerName + "' does not name a device node. Pass options.devicePath to use the device transport."
+        );
+        return false;
     }
+    // Explicit serial options win over settings embedded in the URI
+    if (config.serialOptionsGiven) {
+        target.serial = config.device.serial;
+    }
+    return true;
+#else
+    result.setError(PRINTER_INVALID_ARGUMENT, "options.devicePath is required for the device transport");
+    return false;
+#endif
+}
 
-    bool isValid() const { return handle_ != NULL; }
+static OperationResult send_over_tcp(const std::string& printerName, const DrawerConfig& config,
+                                     const DataSegment* segments, size_t count) {
+    OperationResult result;
+    TcpEndpoint endpoint;
+    StageTimer lookup(STAGE_LOOKUP);
+    if (!resolveTcpEndpoint(printerName, config, endpoint, result)) {
+        return result;
+    }
+    lookup.stop();
 
-private:
-    HANDLE handle_;
-    bool docStarted_;
-    bool pageStarted_;
+    StageTimer submit(STAGE_SUBMIT);
+    return sendOverTcp(endpoint, segments, count);
+}
 
-    PrinterHandle(const PrinterHandle&) = delete;
-    PrinterHandle& operator=(const PrinterHandle&) = delete;
-};
-#endif
+static OperationResult send_to_device(const std::string& printerName, const DrawerConfig& config,
+                                      const DataSegment* segments, size_t count) {
+    OperationResult result;
+    DeviceTarget target;
+    StageTimer lookup(STAGE_LOOKUP);
+    if (!resolveDeviceTarget(printerName, config, target, result)) {
+        return result;
+    }
+    lookup.stop();
+
+    StageTimer submit(STAGE_SUBMIT);
+    return sendToDevice(target, segments, count);
+}
 
 // ============================================================================
 // Core cash drawer operation
 // ============================================================================
 
-static OperationResult open_cash_drawer(const std::string& printerName, const DrawerConfig& config = DrawerConfig()) {
-    OperationResult result;
-
-    // Validate printer name
+// Checks every kick path shares: a usable name that isn't a virtual printer
+bool validateDrawerPrinter(const std::string& printerName, OperationResult& result) {
     if (printerName.empty()) {
         result.setError(PRINTER_INVALID_ARGUMENT, "Printer name cannot be empty");
-        return result;
+        return false;
     }
     if (printerName.length() > MAX_PRINTER_NAME_LENGTH) {
         result.setError(
             PRINTER_INVALID_ARGUMENT,
             "Printer name too long. Maximum length is " + std::to_string(MAX_PRINTER_NAME_LENGTH) + " characters"
         );
-        return result;
+        return false;
     }
 
     // Block virtual printers
@@ -136,25 +277,23 @@ static OperationResult open_cash_drawer(const std::string& printerName, const Dr
             PRINTER_VIRTUAL_BLOCKED,
             "Cannot open cash drawer on virtual printer '" + printerName + "'. Please use a physical receipt printer."
         );
-        return result;
+        return false;
     }
-
-    std::vector<unsigned char> escposCommand = config.buildCommand();
+    return true;
+}
 
 #ifdef _WIN32
-    PrinterHandle printer;
-    DWORD winError = 0;
+// Write one RAW document to an open printer; the printer stays open
+OperationResult printRawDocument(PrinterHandle& printer, const std::vector<unsigned char>& data) {
+    DataSegment segment = { data.data(), data.size() };
+    return printRawDocument(printer, "Open Cash Drawer", &segment, 1);
+}
 
-    if (!printer.open(printerName, &winError)) {
-        result.setError(
-            PRINTER_OPEN_ERROR,
-            "Failed to open printer '" + printerName + "'. Windows Error: " + std::to_string(winError) +
-            ". Make sure the printer is installed and accessible."
-        );
-        return result;
-    }
+OperationResult printRawDocument(PrinterHandle& printer, const char* title, const DataSegment* segments, size_t count) {
+    OperationResult result;
+    DWORD winError = 0;
 
-    if (!printer.startDoc("Open Cash Drawer", &winError)) {
+    if (!printer.startDoc(title, &winError)) {
         result.setError(
             PRINTER_START_DOC_ERROR,
             "Failed to start print job. Windows Error: " + std::to_string(winError)
@@ -167,132 +306,351 @@ static OperationResult open_cash_drawer(const std::string& printerName, const Dr
             PRINTER_START_PAGE_ERROR,
             "Failed to start page. Windows Error: " + std::to_string(winError)
         );
+        printer.endDoc();
         return result;
     }
 
-    DWORD bytesWritten = 0;
-    if (!printer.write(escposCommand, &bytesWritten, &winError)) {
-        result.setError(
-            PRINTER_WRITE_ERROR,
-            "Failed to write to printer. Windows Error: " + std::to_string(winError)
-        );
-        return result;
+    for (size_t i = 0; i < count && result.success; i++) {
+        if (segments[i].length == 0) continue;
+        DWORD bytesWritten = 0;
+        if (!printer.write(segments[i].data, segments[i].length, &bytesWritten, &winError)) {
+            result.setError(
+                PRINTER_WRITE_ERROR,
+                "Failed to write to printer. Windows Error: " + std::to_string(winError)
+            );
+        } else if (bytesWritten != segments[i].length) {
+            result.setError(
+                PRINTER_INCOMPLETE_WRITE,
+                "Not all bytes were written to printer. Expected: " + std::to_string(segments[i].length) +
+                ", Written: " + std::to_string(bytesWritten)
+            );
+        }
     }
 
-    if (bytesWritten != escposCommand.size()) {
-        result.setError(
-            PRINTER_INCOMPLETE_WRITE,
-            "Not all bytes were written to printer. Expected: " + std::to_string(escposCommand.size()) +
-            ", Written: " + std::to_string(bytesWritten)
-        );
-        return result;
-    }
+    printer.endDoc();
+    if (result.success) result.value = printer.jobId();
+    return result;
+}
+#endif
 
-#else
-    // macOS and Linux use CUPS
-    cups_dest_t *dests = nullptr;
-    int num_dests = cupsGetDests(&dests);
-    cups_dest_t *dest = cupsGetDest(printerName.c_str(), NULL, num_dests, dests);
+static OperationResult submit_payload(const std::string& printerName, const DrawerConfig& config,
+                                      const char* title, const DataSegment* segments, size_t count) {
+    OperationResult result;
 
-    if (!dest) {
-        result.setError(
-            PRINTER_OPEN_ERROR,
-            "Printer not found: '" + printerName + "'. Check printer name and installation."
-        );
-        cupsFreeDests(num_dests, dests);
+    StageTimer validate(STAGE_VALIDATE);
+    if (!validateDrawerPrinter(printerName, result)) {
         return result;
     }
+    validate.stop();
 
-    // Create a temporary file for the command
-    char tempFile[] = "/tmp/drawer_cmd_XXXXXX";
-    int fd = mkstemp(tempFile);
-    if (fd < 0) {
-        int savedErrno = errno;
-        result.setError(
-            PRINTER_WRITE_ERROR,
-            "Failed to create temporary file: " + std::string(std::strerror(savedErrno))
-        );
-        cupsFreeDests(num_dests, dests);
-        return result;
+    if (config.transport == TRANSPORT_TCP) {
+        return send_over_tcp(printerName, config, segments, count);
+    }
+    if (config.transport == TRANSPORT_DEVICE) {
+        return send_to_device(printerName, config, segments, count);
     }
 
-    ssize_t bytes_written = write(fd, escposCommand.data(), escposCommand.size());
-    int writeErrno = errno;
-    close(fd);
+#ifdef _WIN32
+    PrinterHandle printer;
+    DWORD winError = 0;
 
-    if (bytes_written < 0 || static_cast<size_t>(bytes_written) != escposCommand.size()) {
+    StageTimer lookup(STAGE_LOOKUP);
+    if (!printer.open(printerName, &winError)) {
         result.setError(
-            PRINTER_WRITE_ERROR,
-            "Failed to write command to temporary file: " + std::string(std::strerror(writeErrno))
+            PRINTER_OPEN_ERROR,
+            "Failed to open printer '" + printerName + "'. Windows Error: " + std::to_string(winError) +
+            ". Make sure the printer is installed and accessible."
         );
-        unlink(tempFile);
-        cupsFreeDests(num_dests, dests);
         return result;
     }
+    lookup.stop();
 
-    int job_id = cupsPrintFile(dest->name, tempFile, "Open Cash Drawer", 0, NULL);
-
-    unlink(tempFile);
+    StageTimer submit(STAGE_SUBMIT);
+    result = printRawDocument(printer, title, segments, count);
 
-    if (job_id == 0) {
+#else
+    // macOS and Linux use CUPS
+    PrinterDestination dest;
+    bool fromCache = false;
+    StageTimer lookup(STAGE_LOOKUP);
+    if (!resolvePrinterDestination(printerName, dest, &fromCache)) {
         result.setError(
-            PRINTER_START_DOC_ERROR,
-            "Failed to send print job to '" + printerName + "': " + cupsLastErrorString()
+            PRINTER_OPEN_ERROR,
+            "Printer not found: '" + printerName + "'. Check printer name and installation."
         );
-        cupsFreeDests(num_dests, dests);
         return result;
     }
-
-    cupsFreeDests(num_dests, dests);
+    lookup.stop();
+
+    StageTimer submit(STAGE_SUBMIT);
+    CupsConnection cups;
+    int job_id = submitCupsJob(cups, dest.name, title, segments, count, config.spool, result);
+
+    // The queue may have been removed since it was cached; refetch once
+    if (job_id == 0 && fromCache && cupsLastError() == IPP_STATUS_ERROR_NOT_FOUND) {
+        invalidatePrinterDestination(printerName);
+        if (resolvePrinterDestination(printerName, dest)) {
+            result = OperationResult();
+            job_id = submitCupsJob(cups, dest.name, title, segments, count, config.spool, result);
+        }
+    }
+    if (job_id == 0 && result.success) {
+        result.setError(PRINTER_START_DOC_ERROR, "Failed to send print job to '" + dest.name + "'");
+    }
 #endif
 
     return result;
 }
 
-// ============================================================================
-// Async work for openCashDrawer
-// ============================================================================
+// Send one payload as a single job over the configured transport
+static OperationResult send_payload(const std::string& printerName, const DrawerConfig& config,
+                                    const char* title, const DataSegment* segments, size_t count) {
+    StatsClock::time_point start = StatsClock::now();
+    OperationResult result = submit_payload(printerName, config, title, segments, count);
+    recordPrinterResult(printerName, result, start);
+    return result;
+}
 
-struct AsyncDrawerWork {
-    napi_async_work work;
-    napi_deferred deferred;
-    std::string printerName;
-    DrawerConfig config;
-    OperationResult result;
-};
+OperationResult open_cash_drawer(const std::string& printerName, const DrawerConfig& config) {
+    std::vector<unsigned char> escposCommand = config.buildCommand();
+    DataSegment segment = { escposCommand.data(), escposCommand.size() };
+    return send_payload(printerName, config, "Open Cash Drawer", &segment, 1);
+}
 
-static void ExecuteOpenDrawer(napi_env env, void* data) {
-    AsyncDrawerWork* asyncWork = static_cast<AsyncDrawerWork*>(data);
-    asyncWork->result = open_cash_drawer(asyncWork->printerName, asyncWork->config);
+// Caller's bytes, optionally followed by the drawer command, as one job. The
+// data belongs to a JS value the scheduler keeps referenced until the job
+// has settled.
+static OperationResult send_raw(const std::string& printerName, const DrawerConfig& config,
+                                const unsigned char* data, size_t length, bool appendDrawerKick) {
+    std::vector<unsigned char> escposCommand;
+    if (appendDrawerKick) escposCommand = config.buildCommand();
+
+    DataSegment segments[] = {
+        { data, length },
+        { escposCommand.data(), escposCommand.size() }
+    };
+    return send_payload(printerName, config, "Raw Print Job", segments, 2);
 }
 
-static void CompleteOpenDrawer(napi_env env, napi_status status, void* data) {
-    AsyncDrawerWork* asyncWork = static_cast<AsyncDrawerWork*>(data);
+// ============================================================================
+// Scheduled job for openCashDrawer
+// ============================================================================
+
+// Kicks with the same key produce identical bytes on the same path to the
+// printer, so they may be coalesced
+std::string CoalesceKey(const DrawerConfig& config) {
+    std::vector<unsigned char> command = config.buildCommand();
+    std::string key(command.begin(), command.end());
+    key += static_cast<char>(config.transport);
+    key += static_cast<char>(config.spool);
+    key += config.awaitCompletion ? 'a' : 'q';
+    if (config.transport == TRANSPORT_TCP) {
+        key += config.tcp.host + ":" + std::to_string(config.tcp.port);
+    } else if (config.transport == TRANSPORT_DEVICE) {
+        key += config.device.path;
+    }
+    return key;
+}
 
+// Build the { success, errorCode, errorMessage } object returned to JS
+napi_value CreateResultObject(napi_env env, const OperationResult& result) {
     napi_value result_object;
     napi_create_object(env, &result_object);
 
     napi_value success_value;
-    napi_get_boolean(env, asyncWork->result.success, &success_value);
+    napi_get_boolean(env, result.success, &success_value);
     napi_set_named_property(env, result_object, "success", success_value);
 
     napi_value error_code_value;
-    napi_create_int32(env, asyncWork->result.errorCode, &error_code_value);
+    napi_create_int32(env, result.errorCode, &error_code_value);
     napi_set_named_property(env, result_object, "errorCode", error_code_value);
 
     napi_value error_message_value;
-    napi_create_string_utf8(env, asyncWork->result.errorMessage.c_str(),
+    napi_create_string_utf8(env, result.errorMessage.c_str(),
         NAPI_AUTO_LENGTH, &error_message_value);
     napi_set_named_property(env, result_object, "errorMessage", error_message_value);
 
-    napi_resolve_deferred(env, asyncWork->deferred, result_object);
+    return result_object;
+}
+
+// A promise already settled with a result, for calls that fail before scheduling
+napi_value SettledResult(napi_env env, const OperationResult& result) {
+    napi_deferred deferred;
+    napi_value promise;
+    if (napi_create_promise(env, &deferred, &promise) != napi_ok) return nullptr;
+    napi_resolve_deferred(env, deferred, CreateResultObject(env, result));
+    return promise;
+}
+
+// Helper to read an optional string property from JS options
+bool GetOptionalStringProperty(napi_env env, napi_value object, const char* key, std::string& value, bool& present) {
+    present = false;
+
+    bool has_property;
+    napi_has_named_property(env, object, key, &has_property);
+    if (!has_property) return true;
+
+    napi_value property;
+    napi_get_named_property(env, object, key, &property);
+
+    napi_valuetype type;
+    napi_typeof(env, property, &type);
+    if (type == napi_undefined) return true;
+    if (type != napi_string) return false;
+
+    size_t length;
+    napi_get_value_string_utf8(env, property, nullptr, 0, &length);
+    value.resize(length);
+    napi_get_value_string_utf8(env, property, &value[0], length + 1, &length);
+    present = true;
+    return true;
+}
+
+// Helper to read an optional integer property from JS options
+bool GetOptionalInt32Property(napi_env env, napi_value object, const char* key, int32_t& value, bool& present) {
+    present = false;
+
+    bool has_property;
+    napi_has_named_property(env, object, key, &has_property);
+    if (!has_property) return true;
+
+    napi_value property;
+    napi_get_named_property(env, object, key, &property);
+
+    napi_valuetype type;
+    napi_typeof(env, property, &type);
+    if (type == napi_undefined) return true;
+    if (type != napi_number) return false;
+
+    napi_get_value_int32(env, property, &value);
+    present = true;
+    return true;
+}
+
+// Helper to parse the direct TCP transport options
+static bool ParseTcpOptions(napi_env env, napi_value options, TcpEndpoint& endpoint, std::string& error) {
+    bool present;
+    if (!GetOptionalStringProperty(env, options, "host", endpoint.host, present)) {
+        error = "Invalid options: host must be a string";
+        return false;
+    }
+
+    int32_t port;
+    if (!GetOptionalInt32Property(env, options, "port", port, present) ||
+        (present && (port <= 0 || port > 65535))) {
+        error = "Invalid options: port must be 1-65535";
+        return false;
+    }
+    if (present) endpoint.port = port;
+
+    int32_t timeout;
+    if (!GetOptionalInt32Property(env, options, "connectTimeout", timeout, present) ||
+        (present && timeout <= 0)) {
+        error = "Invalid options: connectTimeout must be a positive number of milliseconds";
+        return false;
+    }
+    if (present) endpoint.connectTimeoutMs = timeout;
+
+    if (!GetOptionalInt32Property(env, options, "writeTimeout", timeout, present) ||
+        (present && timeout <= 0)) {
+        error = "Invalid options: writeTimeout must be a positive number of milliseconds";
+        return false;
+    }
+    if (present) endpoint.writeTimeoutMs = timeout;
+
+    if (!GetOptionalInt32Property(env, options, "keepAlive", timeout, present) ||
+        (present && timeout < 0)) {
+        error = "Invalid options: keepAlive must be a non-negative number of milliseconds";
+        return false;
+    }
+    if (present) endpoint.keepAliveMs = timeout;
 
-    napi_delete_async_work(env, asyncWork->work);
-    delete asyncWork;
+    return true;
+}
+
+// Helper to parse the direct device transport options
+static bool ParseDeviceOptions(napi_env env, napi_value options, DeviceTarget& target,
+                               bool& serialOptionsGiven, std::string& error) {
+    bool present;
+    if (!GetOptionalStringProperty(env, options, "devicePath", target.path, present)) {
+        error = "Invalid options: devicePath must be a string";
+        return false;
+    }
+
+    int32_t value;
+    if (!GetOptionalInt32Property(env, options, "writeTimeout", value, present) ||
+        (present && value <= 0)) {
+        error = "Invalid options: writeTimeout must be a positive number of milliseconds";
+        return false;
+    }
+    if (present) target.writeTimeoutMs = value;
+
+    SerialSettings& serial = target.serial;
+    if (!GetOptionalInt32Property(env, options, "baudRate", value, present) || (present && value <= 0)) {
+        error = "Invalid options: baudRate must be a positive number";
+        return false;
+    }
+    if (present) serial.baudRate = value;
+    serialOptionsGiven |= present;
+
+    if (!GetOptionalInt32Property(env, options, "dataBits", value, present) ||
+        (present && value != 7 && value != 8)) {
+        error = "Invalid options: dataBits must be 7 or 8";
+        return false;
+    }
+    if (present) serial.dataBits = value;
+    serialOptionsGiven |= present;
+
+    if (!GetOptionalInt32Property(env, options, "stopBits", value, present) ||
+        (present && value != 1 && value != 2)) {
+        error = "Invalid options: stopBits must be 1 or 2";
+        return false;
+    }
+    if (present) serial.stopBits = value;
+    serialOptionsGiven |= present;
+
+    std::string text;
+    if (!GetOptionalStringProperty(env, options, "parity", text, present)) {
+        error = "Invalid options: parity must be a string";
+        return false;
+    }
+    serialOptionsGiven |= present;
+    if (present) {
+        if (text == "none") {
+            serial.parity = PARITY_NONE;
+        } else if (text == "even") {
+            serial.parity = PARITY_EVEN;
+        } else if (text == "odd") {
+            serial.parity = PARITY_ODD;
+        } else {
+            error = "Invalid options: parity must be 'none', 'even' or 'odd'";
+            return false;
+        }
+    }
+
+    if (!GetOptionalStringProperty(env, options, "flowControl", text, present)) {
+        error = "Invalid options: flowControl must be a string";
+        return false;
+    }
+    serialOptionsGiven |= present;
+    if (present) {
+        if (text == "none") {
+            serial.flowControl = FLOW_NONE;
+        } else if (text == "hardware") {
+            serial.flowControl = FLOW_HARDWARE;
+        } else if (text == "software") {
+            serial.flowControl = FLOW_SOFTWARE;
+        } else {
+            error = "Invalid options: flowControl must be 'none', 'hardware' or 'software'";
+            return false;
+        }
+    }
+
+    return true;
 }
 
 // Helper to parse DrawerConfig from JS options
-static bool ParseDrawerConfig(napi_env env, napi_value options, DrawerConfig& config) {
+bool ParseDrawerConfig(napi_env env, napi_value options, DrawerConfig& config, std::string& error) {
     if (options == nullptr) return true;
 
     napi_valuetype type;
@@ -307,7 +665,10 @@ static bool ParseDrawerConfig(napi_env env, napi_value options, DrawerConfig& co
         napi_get_named_property(env, options, "pin", &pin_value);
         int32_t pin;
         if (napi_get_value_int32(env, pin_value, &pin) == napi_ok) {
-            if (pin < 0 || pin > 255) return false;
+            if (pin < 0 || pin > 255) {
+                error = "Invalid options: pin, pulseOnTime, pulseOffTime must be 0-255";
+                return false;
+            }
             config.pin = static_cast<unsigned char>(pin);
         }
     }
@@ -317,7 +678,10 @@ static bool ParseDrawerConfig(napi_env env, napi_value options, DrawerConfig& co
         napi_get_named_property(env, options, "pulseOnTime", &pulse_on_value);
         int32_t pulseOn;
         if (napi_get_value_int32(env, pulse_on_value, &pulseOn) == napi_ok) {
-            if (pulseOn < 0 || pulseOn > 255) return false;
+            if (pulseOn < 0 || pulseOn > 255) {
+                error = "Invalid options: pin, pulseOnTime, pulseOffTime must be 0-255";
+                return false;
+            }
             config.pulseOnTime = static_cast<unsigned char>(pulseOn);
         }
     }
@@ -327,14 +691,254 @@ static bool ParseDrawerConfig(napi_env env, napi_value options, DrawerConfig& co
         napi_get_named_property(env, options, "pulseOffTime", &pulse_off_value);
         int32_t pulseOff;
         if (napi_get_value_int32(env, pulse_off_value, &pulseOff) == napi_ok) {
-            if (pulseOff < 0 || pulseOff > 255) return false;
+            if (pulseOff < 0 || pulseOff > 255) {
+                error = "Invalid options: pin, pulseOnTime, pulseOffTime must be 0-255";
+                return false;
+            }
             config.pulseOffTime = static_cast<unsigned char>(pulseOff);
         }
     }
 
+    std::string spool;
+    bool has_spool;
+    if (!GetOptionalStringProperty(env, options, "spool", spool, has_spool)) {
+        error = "Invalid options: spool must be a string";
+        return false;
+    }
+    if (has_spool) {
+        if (spool == "stream") {
+            config.spool = SPOOL_STREAM;
+        } else if (spool == "file") {
+            config.spool = SPOOL_FILE;
+        } else {
+            error = "Invalid options: spool must be 'stream' or 'file'";
+            return false;
+        }
+    }
+
+    std::string transport;
+    bool has_transport;
+    if (!GetOptionalStringProperty(env, options, "transport", transport, has_transport)) {
+        error = "Invalid options: transport must be a string";
+        return false;
+    }
+    if (has_transport) {
+        if (transport == "spooler") {
+            config.transport = TRANSPORT_SPOOLER;
+        } else if (transport == "tcp") {
+            config.transport = TRANSPORT_TCP;
+        } else if (transport == "device") {
+            config.transport = TRANSPORT_DEVICE;
+        } else {
+            error = "Invalid options: transport must be 'spooler', 'tcp' or 'device'";
+            return false;
+        }
+    }
+
+    bool has_await = false;
+    napi_has_named_property(env, options, "awaitCompletion", &has_await);
+    if (has_await) {
+        napi_value await_value;
+        napi_get_named_property(env, options, "awaitCompletion", &await_value);
+        napi_valuetype await_type;
+        napi_typeof(env, await_value, &await_type);
+        if (await_type != napi_undefined &&
+            napi_get_value_bool(env, await_value, &config.awaitCompletion) != napi_ok) {
+            error = "Invalid options: awaitCompletion must be a boolean";
+            return false;
+        }
+    }
+    if (config.awaitCompletion) {
+        int32_t timeout;
+        bool has_timeout;
+        if (!GetOptionalInt32Property(env, options, "timeout", timeout, has_timeout) ||
+            (has_timeout && timeout <= 0)) {
+            error = "Invalid options: timeout must be a positive number of milliseconds";
+            return false;
+        }
+        if (has_timeout) config.completionTimeoutMs = timeout;
+    }
+
+    if (config.transport == TRANSPORT_TCP && !ParseTcpOptions(env, options, config.tcp, error)) {
+        return false;
+    }
+    if (config.transport == TRANSPORT_DEVICE && !ParseDeviceOptions(env, options, config.device, config.serialOptionsGiven, error)) {
+        return false;
+    }
+
     return true;
 }
 
+// ============================================================================
+// Pool work for openCashDrawers (batch)
+// ============================================================================
+
+struct BatchDrawerItem {
+    std::string printerName;
+    DrawerConfig config;
+    OperationResult result;
+    bool valid;
+
+    BatchDrawerItem() : valid(true) {}
+};
+
+struct AsyncBatchDrawerWork {
+    napi_deferred deferred;
+    std::vector<BatchDrawerItem> items;
+    int concurrency;
+    AsyncWorkTrace trace;
+    std::atomic<size_t> next;       // Next item to kick
+    std::atomic<size_t> remaining;  // Items not settled yet
+    WorkCompletion* completion;
+
+    AsyncBatchDrawerWork() : deferred(nullptr), concurrency(0), next(0), remaining(0), completion(nullptr) {}
+};
+
+// Every task and tracker callback of a batch holds a reference; JS drops its
+// own once the result array is built
+typedef std::shared_ptr<AsyncBatchDrawerWork> BatchDrawerWork;
+
+// The last item to settle hands the batch back to JS
+static void SettleBatchItem(const BatchDrawerWork& batch) {
+    if (--batch->remaining == 0) {
+        batch->trace.executedAt = StatsClock::now();
+        FinishWorkCompletion(batch->completion);
+    }
+}
+
+// Schedules the next item's kick on its printer's queue, like any other
+// kick, so it never races other jobs for the device and is subject to queue
+// limits and coalescing. Once it settles (after the spooler finishes it,
+// with awaitCompletion), the chain moves on in a new task, since a settled
+// job's callback may run inside ScheduleNativeJob.
+static void KickNextBatchItem(BatchDrawerWork batch) {
+    size_t i;
+    for (;;) {
+        i = batch->next++;
+        if (i >= batch->items.size()) return;
+        if (batch->items[i].valid) break;
+        SettleBatchItem(batch);
+    }
+
+    const std::string printerName = batch->items[i].printerName;
+    const DrawerConfig config = batch->items[i].config;
+    JobWaiter native;
+    native.traceOperation = batch->trace.operation;
+    native.done = [batch, i](const OperationResult& result) {
+        batch->items[i].result = result;
+        if (batch->next < batch->items.size()) {
+            SubmitPoolTask([batch]() { KickNextBatchItem(batch); });
+        }
+        SettleBatchItem(batch);
+    };
+    ScheduleNativeJob(
+        native,
+        printerName,
+        LANE_KICK,
+        CoalesceKey(config),
+        [printerName, config]() { return open_cash_drawer(printerName, config); },
+        AwaitCompletionHandoff(printerName, config)
+    );
+}
+
+static void ExecuteOpenDrawers(BatchDrawerWork batch) {
+    std::vector<BatchDrawerItem>& items = batch->items;
+    TraceScope scope(batch->trace.operation, nullptr);
+    traceEvent("queueWait", TRACE_ASYNC, batch->trace.queuedAt, StatsClock::now());
+    TraceSpan execute("execute");
+
+    if (items.empty()) {
+        batch->trace.executedAt = StatsClock::now();
+        FinishWorkCompletion(batch->completion);
+        return;
+    }
+
+#ifndef _WIN32
+    // Resolve every spooler destination up front with a single enumeration
+    std::vector<std::string> names;
+    for (const auto& item : items) {
+        if (item.valid) names.push_back(item.printerName);
+    }
+    prefetchPrinterDestinations(names);
+#endif
+
+    // At most concurrency kicks in flight, one per chain
+    size_t chains = std::min(items.size(), static_cast<size_t>(batch->concurrency));
+    for (size_t c = 0; c < chains; c++) {
+        SubmitPoolTask([batch]() { KickNextBatchItem(batch); });
+    }
+}
+
+static void CompleteOpenDrawers(napi_env env, napi_status status, void* data) {
+    BatchDrawerWork* reference = static_cast<BatchDrawerWork*>(data);
+    AsyncBatchDrawerWork* asyncWork = reference->get();
+
+    napi_value result_array;
+    napi_create_array_with_length(env, asyncWork->items.size(), &result_array);
+
+    napi_value undefined_val;
+    napi_get_undefined(env, &undefined_val);
+
+    // Every entry gets completionMs (undefined unless the job was awaited and
+    // finished) and printerName in the same order, so one result array never
+    // mixes object shapes
+    for (size_t i = 0; i < asyncWork->items.size(); i++) {
+        const BatchDrawerItem& item = asyncWork->items[i];
+        bool tracked = item.config.awaitCompletion && item.config.transport == TRANSPORT_SPOOLER;
+        napi_value result_object = CreateResultObject(env, item.result);
+
+        napi_value latency = undefined_val;
+        if (tracked && item.result.success) {
+            napi_create_double(env, static_cast<double>(item.result.value) / 1000.0, &latency);
+        }
+        napi_set_named_property(env, result_object, "completionMs", latency);
+
+        napi_value name_value;
+        napi_create_string_utf8(env, item.printerName.c_str(), NAPI_AUTO_LENGTH, &name_value);
+        napi_set_named_property(env, result_object, "printerName", name_value);
+
+        napi_set_element(env, result_array, static_cast<uint32_t>(i), result_object);
+    }
+
+    napi_resolve_deferred(env, asyncWork->deferred, result_array);
+    TraceScope scope(asyncWork->trace.operation, nullptr);
+    traceEvent("completion", TRACE_ASYNC, asyncWork->trace.executedAt, StatsClock::now());
+    traceEvent("openCashDrawers", TRACE_ASYNC, asyncWork->trace.queuedAt, StatsClock::now());
+
+    delete reference;
+}
+
+// Validate one { printerName, options } entry; failures become that entry's result
+static void ParseBatchItem(napi_env env, napi_value entry, BatchDrawerItem& item) {
+    napi_valuetype type;
+    napi_typeof(env, entry, &type);
+    if (type != napi_object) {
+        item.valid = false;
+        item.result.setError(PRINTER_INVALID_ARGUMENT, "Each entry must be an object with a printerName");
+        return;
+    }
+
+    napi_value name_value;
+    napi_get_named_property(env, entry, "printerName", &name_value);
+    if (!GetPrinterNameFromArg(env, name_value, item.printerName)) {
+        item.valid = false;
+        item.result.setError(PRINTER_INVALID_NAME, "printerName must be a string with max 256 characters");
+        return;
+    }
+    if (!resolvePrinterName(item.printerName, item.printerName, item.result)) {
+        item.valid = false;
+        return;
+    }
+
+    napi_value options;
+    napi_get_named_property(env, entry, "options", &options);
+    std::string error;
+    if (!ParseDrawerConfig(env, options, item.config, error)) {
+        item.valid = false;
+        item.result.setError(PRINTER_INVALID_ARGUMENT, error);
+    }
+}
+
 // ============================================================================
 // Exported N-API function
 // ============================================================================
@@ -350,6 +954,13 @@ napi_value OpenCashDrawer(napi_env env, napi_callback_info info) {
         return nullptr;
     }
 
+    // A list of printers is tried in turn until one opens the drawer
+    bool is_array = false;
+    napi_is_array(env, args[0], &is_array);
+    if (is_array) {
+        return OpenCashDrawerFailover(env, args[0], argc >= 2 ? args[1] : nullptr);
+    }
+
     std::string printer_name;
     if (!GetPrinterNameFromArg(env, args[0], printer_name)) {
         napi_throw_error(env, nullptr, "First argument must be a string (printer name) with max 256 characters");
@@ -358,33 +969,199 @@ napi_value OpenCashDrawer(napi_env env, napi_callback_info info) {
 
     DrawerConfig config;
     if (argc >= 2) {
-        if (!ParseDrawerConfig(env, args[1], config)) {
-            napi_throw_error(env, nullptr, "Invalid options: pin, pulseOnTime, pulseOffTime must be 0-255");
+        std::string error;
+        if (!ParseDrawerConfig(env, args[1], config, error)) {
+            napi_throw_error(env, nullptr, error.c_str());
             return nullptr;
         }
     }
 
-    AsyncDrawerWork* asyncWork = new AsyncDrawerWork();
-    asyncWork->printerName = printer_name;
-    asyncWork->config = config;
+    // Configured spellings and aliases map onto one queue before scheduling
+    OperationResult resolution;
+    if (!resolvePrinterName(printer_name, printer_name, resolution)) {
+        return SettledResult(env, resolution);
+    }
 
-    napi_value promise;
-    NAPI_CALL(env, napi_create_promise(env, &asyncWork->deferred, &promise));
+    // Serialized per printer; kicks take the priority lane
+    napi_value promise = ScheduleJob(
+        env,
+        "openCashDrawer",
+        printer_name,
+        LANE_KICK,
+        CoalesceKey(config),
+        [printer_name, config]() { return open_cash_drawer(printer_name, config); },
+        CreateResultObject,
+        nullptr,
+        AwaitCompletionHandoff(printer_name, config)
+    );
+    if (promise == nullptr) {
+        napi_throw_error(env, nullptr, "Failed to schedule cash drawer job");
+        return nullptr;
+    }
+
+    return promise;
+}
+
+// Borrow the bytes of a Buffer, Uint8Array, Uint8ClampedArray or ArrayBuffer without copying
+bool GetRawData(napi_env env, napi_value value, const unsigned char*& data, size_t& length) {
+    bool is_typedarray = false;
+    napi_is_typedarray(env, value, &is_typedarray);
+    if (is_typedarray) {
+        napi_typedarray_type type;
+        void* bytes = nullptr;
+        if (napi_get_typedarray_info(env, value, &type, &length, &bytes, nullptr, nullptr) != napi_ok ||
+            (type != napi_uint8_array && type != napi_uint8_clamped_array)) {
+            return false;
+        }
+        data = static_cast<const unsigned char*>(bytes);
+        return true;
+    }
+
+    bool is_arraybuffer = false;
+    napi_is_arraybuffer(env, value, &is_arraybuffer);
+    if (is_arraybuffer) {
+        void* bytes = nullptr;
+        if (napi_get_arraybuffer_info(env, value, &bytes, &length) != napi_ok) return false;
+        data = static_cast<const unsigned char*>(bytes);
+        return true;
+    }
+    return false;
+}
+
+// sendRaw(printerName, data, { appendDrawerKick, ...drawer options })
+napi_value SendRaw(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    if (argc < 2) {
+        napi_throw_error(env, nullptr, "Expected at least 2 arguments: printer name and data");
+        return nullptr;
+    }
+
+    std::string printer_name;
+    if (!GetPrinterNameFromArg(env, args[0], printer_name)) {
+        napi_throw_error(env, nullptr, "First argument must be a string (printer name) with max 256 characters");
+        return nullptr;
+    }
 
-    napi_value work_name;
-    NAPI_CALL(env, napi_create_string_utf8(env, "OpenCashDrawerAsync", NAPI_AUTO_LENGTH, &work_name));
+    const unsigned char* data = nullptr;
+    size_t length = 0;
+    if (!GetRawData(env, args[1], data, length)) {
+        napi_throw_type_error(env, nullptr, "Second argument must be a Buffer, Uint8Array or ArrayBuffer");
+        return nullptr;
+    }
+
+    DrawerConfig config;
+    bool appendDrawerKick = false;
+    if (argc >= 3) {
+        std::string error;
+        if (!ParseDrawerConfig(env, args[2], config, error)) {
+            napi_throw_error(env, nullptr, error.c_str());
+            return nullptr;
+        }
 
-    NAPI_CALL(env, napi_create_async_work(
+        napi_valuetype type;
+        napi_typeof(env, args[2], &type);
+        bool has_kick = false;
+        if (type == napi_object) napi_has_named_property(env, args[2], "appendDrawerKick", &has_kick);
+        if (has_kick) {
+            napi_value kick_value;
+            napi_get_named_property(env, args[2], "appendDrawerKick", &kick_value);
+            if (napi_get_value_bool(env, kick_value, &appendDrawerKick) != napi_ok) {
+                napi_throw_error(env, nullptr, "Invalid options: appendDrawerKick must be a boolean");
+                return nullptr;
+            }
+        }
+    }
+
+    if (length == 0 && !appendDrawerKick) {
+        napi_throw_error(env, nullptr, "Nothing to send: data is empty");
+        return nullptr;
+    }
+
+    OperationResult resolution;
+    if (!resolvePrinterName(printer_name, printer_name, resolution)) {
+        return SettledResult(env, resolution);
+    }
+
+    // The job reads the caller's memory directly; the reference keeps it
+    // alive until the promise settles
+    napi_ref retained;
+    NAPI_CALL(env, napi_create_reference(env, args[1], 1, &retained));
+
+    // Receipts are bulk work; kicks for the same printer still go first
+    napi_value promise = ScheduleJob(
         env,
-        nullptr,
-        work_name,
-        ExecuteOpenDrawer,
-        CompleteOpenDrawer,
-        asyncWork,
-        &asyncWork->work
-    ));
-
-    NAPI_CALL(env, napi_queue_async_work(env, asyncWork->work));
+        "sendRaw",
+        printer_name,
+        LANE_BULK,
+        std::string(),
+        [printer_name, config, data, length, appendDrawerKick]() {
+            return send_raw(printer_name, config, data, length, appendDrawerKick);
+        },
+        CreateResultObject,
+        retained,
+        AwaitCompletionHandoff(printer_name, config)
+    );
+    if (promise == nullptr) {
+        napi_delete_reference(env, retained);
+        napi_throw_error(env, nullptr, "Failed to schedule raw print job");
+        return nullptr;
+    }
+
+    return promise;
+}
+
+napi_value OpenCashDrawers(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    bool is_array = false;
+    if (argc >= 1) {
+        napi_is_array(env, args[0], &is_array);
+    }
+    if (!is_array) {
+        napi_throw_type_error(env, nullptr, "First argument must be an array of { printerName, options }");
+        return nullptr;
+    }
+
+    int32_t concurrency = DEFAULT_BATCH_CONCURRENCY;
+    if (argc >= 2) {
+        napi_valuetype type;
+        napi_typeof(env, args[1], &type);
+        if (type == napi_object) {
+            bool present;
+            if (!GetOptionalInt32Property(env, args[1], "concurrency", concurrency, present) ||
+                concurrency < 1 || concurrency > MAX_BATCH_CONCURRENCY) {
+                napi_throw_range_error(env, nullptr, "concurrency must be 1-64");
+                return nullptr;
+            }
+        }
+    }
+
+    uint32_t length;
+    NAPI_CALL(env, napi_get_array_length(env, args[0], &length));
+
+    BatchDrawerWork asyncWork = std::make_shared<AsyncBatchDrawerWork>();
+    asyncWork->concurrency = concurrency;
+    asyncWork->items.resize(length);
+
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value entry;
+        napi_get_element(env, args[0], i, &entry);
+        ParseBatchItem(env, entry, asyncWork->items[i]);
+    }
+
+    napi_value promise;
+    NAPI_CALL(env, napi_create_promise(env, &asyncWork->deferred, &promise));
+
+    asyncWork->remaining = asyncWork->items.size();
+    asyncWork->completion = BeginWorkCompletion(env, CompleteOpenDrawers, new BatchDrawerWork(asyncWork));
+    SubmitPoolTask([asyncWork]() { ExecuteOpenDrawers(asyncWork); });
 
     return promise;
 }
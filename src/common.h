@@ -2,6 +2,9 @@
 #define NODE_PRINTER_COMMON_H
 
 #include <node_api.h>
+#include <chrono>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 #include <cstring>
@@ -15,6 +18,7 @@
 #include <cups/cups.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/socket.h>
 #endif
 
 // ============================================================================
@@ -23,22 +27,26 @@
 
 static const size_t MAX_PRINTER_NAME_LENGTH = 256;
 
-// List of virtual printers that should be blocked (case-insensitive check)
-static const std::vector<std::string> BLOCKED_VIRTUAL_PRINTERS = {
-    "microsoft print to pdf",
-    "microsoft xps document writer",
-    "onenote",
-    "fax",
-    "send to onenote",
-    "adobe pdf",
-    "cute pdf",
-    "cutepdf",
-    "bullzip pdf",
-    "foxit pdf",
-    "pdf24",
-    "dopdf",
-    "pdfcreator"
-};
+// Default ESC/POS drawer configuration
+static const unsigned char DEFAULT_DRAWER_PIN = 0x00;      // Pin 0 (some drawers use 0x01)
+static const unsigned char DEFAULT_PULSE_ON_TIME = 0x32;   // ~100ms
+static const unsigned char DEFAULT_PULSE_OFF_TIME = 0xFA;  // ~500ms
+
+// openCashDrawers() fan-out
+static const int DEFAULT_BATCH_CONCURRENCY = 8;
+static const int MAX_BATCH_CONCURRENCY = 64;
+
+// Direct TCP transport defaults
+static const int DEFAULT_RAW_TCP_PORT = 9100;
+static const int DEFAULT_CONNECT_TIMEOUT_MS = 3000;
+static const int DEFAULT_WRITE_TIMEOUT_MS = 3000;
+static const int DEFAULT_KEEP_ALIVE_MS = 30000;
+
+// Direct device transport defaults
+static const int DEFAULT_SERIAL_BAUD_RATE = 9600;
+
+// awaitCompletion: how long a spooler job may take to finish
+static const int DEFAULT_COMPLETION_TIMEOUT_MS = 30000;
 
 // ============================================================================
 // Error Codes - Single source of truth
@@ -54,7 +62,13 @@ enum PrinterErrorCodes {
     PRINTER_INCOMPLETE_WRITE = 1005,
     PRINTER_INVALID_NAME = 1006,
     PRINTER_OTHER_ERROR = 1007,
-    PRINTER_VIRTUAL_BLOCKED = 1008
+    PRINTER_VIRTUAL_BLOCKED = 1008,
+    PRINTER_QUEUE_FULL = 1009,
+    PRINTER_HANDLE_CLOSED = 1010,
+    PRINTER_TIMEOUT = 1011,
+    PRINTER_STATUS_UNAVAILABLE = 1012,
+    PRINTER_JOB_FAILED = 1013,
+    PRINTER_AMBIGUOUS_NAME = 1014
 };
 
 // ============================================================================
@@ -94,16 +108,6 @@ inline std::string toLowercase(const std::string& str) {
     return result;
 }
 
-inline bool isBlockedVirtualPrinter(const std::string& printerName) {
-    std::string lowerName = toLowercase(printerName);
-    for (const auto& blocked : BLOCKED_VIRTUAL_PRINTERS) {
-        if (lowerName.find(blocked) != std::string::npos) {
-            return true;
-        }
-    }
-    return false;
-}
-
 // Helper function to extract printer name from JS argument
 inline bool GetPrinterNameFromArg(napi_env env, napi_value arg, std::string& printer_name) {
     napi_valuetype valuetype;
@@ -141,18 +145,64 @@ struct PrinterInfo {
     std::string status;
     std::string type;
     std::string ipAddress;
+    std::string hostname;
     int port;
     std::string bluetoothAddress;
 
     PrinterInfo() : isDefault(false), port(0) {}
 };
 
+// Difference between two enumerations
+enum PrinterChangeKind {
+    PRINTER_ADDED,
+    PRINTER_REMOVED,
+    PRINTER_CHANGED
+};
+
+struct PrinterChange {
+    PrinterChangeKind kind;
+    PrinterInfo printer;  // Last known state for removals
+};
+
+// Builds the JS side of printer lists. One instance per batch: property keys
+// and repeated values (status, type) are created once and reused for every
+// printer in the batch. Handles are only valid in the current scope.
+class PrinterMarshaller {
+public:
+    static const int KEY_COUNT = 8;
+
+    explicit PrinterMarshaller(napi_env env);
+
+    napi_value toObject(const PrinterInfo& printer);
+    napi_value toColumns(const std::vector<PrinterInfo>& printers);
+
+private:
+    napi_value key(int index);
+    napi_value sharedString(const std::string& value);
+
+    napi_env env_;
+    napi_value keys_[KEY_COUNT];
+    std::vector<std::pair<std::string, napi_value>> shared_;
+};
+
+// getAvailablePrinters({ since }) result
+struct PrinterDelta {
+    uint64_t generation;
+    bool full;  // `added` holds the complete list; the caller's generation was unknown
+    std::vector<PrinterInfo> added;
+    std::vector<PrinterInfo> changed;
+    std::vector<PrinterInfo> removed;  // Last known state
+
+    PrinterDelta() : generation(0), full(false) {}
+};
+
 struct OperationResult {
     bool success;
     int errorCode;
     std::string errorMessage;
+    int64_t value;  // Operation-specific outcome for the result formatter (e.g. drawer state)
 
-    OperationResult() : success(true), errorCode(0) {}
+    OperationResult() : success(true), errorCode(0), value(0) {}
 
     void setError(int code, const std::string& message) {
         success = false;
@@ -161,15 +211,585 @@ struct OperationResult {
     }
 };
 
+// Bytes sent as they are, without copying them into one buffer first (e.g. a
+// caller's Buffer followed by the drawer command)
+struct DataSegment {
+    const unsigned char* data;
+    size_t length;
+};
+
+// Network printer reached directly over raw TCP
+struct TcpEndpoint {
+    std::string host;
+    int port;
+    int connectTimeoutMs;
+    int writeTimeoutMs;
+    int keepAliveMs;
+
+    TcpEndpoint()
+        : port(DEFAULT_RAW_TCP_PORT)
+        , connectTimeoutMs(DEFAULT_CONNECT_TIMEOUT_MS)
+        , writeTimeoutMs(DEFAULT_WRITE_TIMEOUT_MS)
+        , keepAliveMs(DEFAULT_KEEP_ALIVE_MS) {}
+};
+
+#ifndef _WIN32
+// One address a TcpEndpoint's host resolved to
+struct ResolvedAddress {
+    int family;
+    int socktype;
+    int protocol;
+    struct sockaddr_storage address;
+    socklen_t length;
+};
+#endif
+
+enum SerialParity {
+    PARITY_NONE,
+    PARITY_EVEN,
+    PARITY_ODD
+};
+
+enum SerialFlowControl {
+    FLOW_NONE,
+    FLOW_HARDWARE,  // RTS/CTS
+    FLOW_SOFTWARE   // XON/XOFF
+};
+
+// termios settings applied when the device node is a serial port
+struct SerialSettings {
+    int baudRate;
+    int dataBits;
+    int stopBits;
+    SerialParity parity;
+    SerialFlowControl flowControl;
+
+    SerialSettings()
+        : baudRate(DEFAULT_SERIAL_BAUD_RATE)
+        , dataBits(8)
+        , stopBits(1)
+        , parity(PARITY_NONE)
+        , flowControl(FLOW_NONE) {}
+};
+
+// Printer device node written to directly (/dev/usb/lp*, /dev/lp*, /dev/tty*)
+struct DeviceTarget {
+    std::string path;
+    SerialSettings serial;
+    int writeTimeoutMs;
+
+    DeviceTarget() : writeTimeoutMs(DEFAULT_WRITE_TIMEOUT_MS) {}
+};
+
+// Resolved CUPS queue, copied out of the destination cache
+struct PrinterDestination {
+    std::string name;
+    std::string deviceUri;
+};
+
+// How the command is handed to CUPS (ignored on Windows)
+enum SpoolMode {
+    SPOOL_STREAM,  // Create-Job + Send-Document straight from memory
+    SPOOL_FILE     // Write a temporary file and cupsPrintFile() it
+};
+
+// Which path the command takes to the printer
+enum TransportKind {
+    TRANSPORT_SPOOLER,  // Windows spooler or CUPS
+    TRANSPORT_TCP,      // Raw TCP straight to the printer (port 9100)
+    TRANSPORT_DEVICE    // Write to the USB, parallel or serial device node
+};
+
+struct DrawerConfig {
+    unsigned char pin;
+    unsigned char pulseOnTime;
+    unsigned char pulseOffTime;
+    SpoolMode spool;
+    TransportKind transport;
+    TcpEndpoint tcp;
+    DeviceTarget device;
+    bool serialOptionsGiven;
+    bool awaitCompletion;     // Settle once the spooler reports the job finished
+    int completionTimeoutMs;
+
+    DrawerConfig()
+        : pin(DEFAULT_DRAWER_PIN)
+        , pulseOnTime(DEFAULT_PULSE_ON_TIME)
+        , pulseOffTime(DEFAULT_PULSE_OFF_TIME)
+        , spool(SPOOL_STREAM)
+        , transport(TRANSPORT_SPOOLER)
+        , serialOptionsGiven(false)
+        , awaitCompletion(false)
+        , completionTimeoutMs(DEFAULT_COMPLETION_TIMEOUT_MS) {}
+
+    DrawerConfig(unsigned char p, unsigned char onTime, unsigned char offTime)
+        : pin(p), pulseOnTime(onTime), pulseOffTime(offTime)
+        , spool(SPOOL_STREAM), transport(TRANSPORT_SPOOLER), serialOptionsGiven(false)
+        , awaitCompletion(false), completionTimeoutMs(DEFAULT_COMPLETION_TIMEOUT_MS) {}
+
+    // Build the ESC/POS command for opening the drawer
+    std::vector<unsigned char> buildCommand() const {
+        return { 0x1B, 0x70, pin, pulseOnTime, pulseOffTime };
+    }
+};
+
+// Scheduler lanes; lower lanes are always drained first
+enum JobLane {
+    LANE_KICK = 0,  // Drawer kicks
+    LANE_BULK = 1   // Everything else
+};
+
+// Converts a finished job's result into the value its promise resolves to
+typedef std::function<napi_value(napi_env env, const OperationResult& result)> ResultFormatter;
+
+// Called once with a tracked spooler job's outcome; value is the
+// queue-to-completion latency in microseconds
+typedef std::function<void(const OperationResult& result)> JobCompletionCallback;
+
+struct CompletionChannel;
+
+// A promise waiting for a result from a native thread, or a native waiter
+// (done set) that is called on the thread delivering the result instead
+struct JobWaiter {
+    std::shared_ptr<CompletionChannel> channel;
+    napi_deferred deferred;
+    ResultFormatter format;
+    JobCompletionCallback done;
+    napi_ref retained;  // JS value the job reads (e.g. a Buffer); released on the JS thread once settled
+    uint64_t traceOperation;  // 0 unless tracing was on when the promise was created
+    const char* traceName;
+    std::chrono::steady_clock::time_point createdAt;
+
+    JobWaiter() : deferred(nullptr), format(nullptr), retained(nullptr), traceOperation(0), traceName(nullptr) {}
+};
+
+// Takes over settling a finished job's waiters (e.g. until the spooler has
+// printed it). Returns false to have the scheduler settle them with the result.
+typedef std::function<bool(const OperationResult& result, const std::vector<JobWaiter>& waiters)> JobHandoff;
+
+struct WorkChannel;
+struct WorkCompletion;
+
+// Per-environment addon state (napi_set_instance_data)
+struct AddonData {
+    std::shared_ptr<CompletionChannel> completions;
+    std::shared_ptr<WorkChannel> workCompletions;
+    napi_ref drawerHandleConstructor;
+
+    AddonData() : drawerHandleConstructor(nullptr) {}
+};
+
+// ============================================================================
+// Latency metrics (stats.cc)
+// ============================================================================
+
+// Stages timed into getStats() histograms
+enum StatStage {
+    STAGE_VALIDATE,    // Printer name checks
+    STAGE_QUEUE_WAIT,  // Waiting in the printer's job queue
+    STAGE_LOOKUP,      // Destination, endpoint or device resolution
+    STAGE_SPOOL_FILE,  // Temporary file write (spool: "file"), part of submit
+    STAGE_SUBMIT,      // Job submission or direct write
+    STAGE_COMPLETION,  // Result waiting for the JS thread to settle the promise
+    STAGE_ENUMERATE,   // Printer enumeration
+    STAGE_MARSHAL,     // Printer list conversion on the JS thread
+    STAGE_COUNT
+};
+
+typedef std::chrono::steady_clock StatsClock;
+
+void recordStage(StatStage stage, StatsClock::time_point start);
+void recordPrinterResult(const std::string& printerName, const OperationResult& result,
+                         StatsClock::time_point start);
+
+// Times the enclosing scope, or up to stop(), into a stage histogram
+class StageTimer {
+public:
+    explicit StageTimer(StatStage stage) : stage_(stage), start_(StatsClock::now()), stopped_(false) {}
+    ~StageTimer() { stop(); }
+
+    void stop() {
+        if (stopped_) return;
+        stopped_ = true;
+        recordStage(stage_, start_);
+    }
+
+private:
+    StatStage stage_;
+    StatsClock::time_point start_;
+    bool stopped_;
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+};
+
+// ============================================================================
+// Tracing (trace.cc)
+// ============================================================================
+
+// Spans cover work on one thread; async events cover a stage that crosses
+// threads (queue wait, completion) or a whole operation
+enum TracePhase {
+    TRACE_SPAN,
+    TRACE_ASYNC
+};
+
+// The operation and printer that trace events on this thread belong to
+struct TraceContext {
+    uint64_t operation;  // 0 outside a traced operation
+    const char* label;
+};
+
+bool traceEnabled();
+uint64_t beginTraceOperation();
+TraceContext swapTraceContext(TraceContext context);
+void traceEvent(const char* name, TracePhase phase, StatsClock::time_point start, StatsClock::time_point end);
+
+// Attributes trace events on this thread to an operation until the scope ends;
+// label must outlive the scope
+class TraceScope {
+public:
+    TraceScope(uint64_t operation, const char* label) : previous_(swapTraceContext(TraceContext{ operation, label })) {}
+    ~TraceScope() { swapTraceContext(previous_); }
+
+private:
+    TraceContext previous_;
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+// Trace state for one worker pool item: queue wait in the pool runs from
+// construction to Execute, completion from Execute's end to Complete
+struct AsyncWorkTrace {
+    uint64_t operation;
+    StatsClock::time_point queuedAt;
+    StatsClock::time_point executedAt;
+
+    AsyncWorkTrace() : operation(beginTraceOperation()), queuedAt(StatsClock::now()) {}
+};
+
+// Traces the enclosing scope as a span (e.g. one CUPS call) while tracing is on
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name) : name_(name), enabled_(traceEnabled()) {
+        if (enabled_) start_ = StatsClock::now();
+    }
+    ~TraceSpan() {
+        if (enabled_) traceEvent(name_, TRACE_SPAN, start_, StatsClock::now());
+    }
+
+private:
+    const char* name_;
+    bool enabled_;
+    StatsClock::time_point start_;
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+// ============================================================================
+// Windows RAII Printer Handle
+// ============================================================================
+
+#ifdef _WIN32
+class PrinterHandle {
+public:
+    PrinterHandle() : handle_(NULL), jobId_(0), docStarted_(false), pageStarted_(false) {}
+
+    ~PrinterHandle() {
+        close();
+    }
+
+    bool open(const std::string& printerName, DWORD* errorCode) {
+        if (!OpenPrinterA(const_cast<char*>(printerName.c_str()), &handle_, NULL)) {
+            if (errorCode) *errorCode = GetLastError();
+            handle_ = NULL;
+            return false;
+        }
+        return true;
+    }
+
+    bool startDoc(const char* docName, DWORD* errorCode) {
+        DOC_INFO_1A docInfo;
+        docInfo.pDocName = const_cast<LPSTR>(docName);
+        docInfo.pOutputFile = nullptr;
+        docInfo.pDatatype = const_cast<LPSTR>("RAW");
+
+        DWORD jobId = StartDocPrinterA(handle_, 1, reinterpret_cast<LPBYTE>(&docInfo));
+        if (jobId == 0) {
+            if (errorCode) *errorCode = GetLastError();
+            return false;
+        }
+        jobId_ = jobId;
+        docStarted_ = true;
+        return true;
+    }
+
+    bool startPage(DWORD* errorCode) {
+        if (!StartPagePrinter(handle_)) {
+            if (errorCode) *errorCode = GetLastError();
+            return false;
+        }
+        pageStarted_ = true;
+        return true;
+    }
+
+    bool write(const std::vector<unsigned char>& data, DWORD* bytesWritten, DWORD* errorCode) {
+        return write(data.data(), data.size(), bytesWritten, errorCode);
+    }
+
+    bool write(const unsigned char* data, size_t length, DWORD* bytesWritten, DWORD* errorCode) {
+        if (!WritePrinter(handle_, const_cast<unsigned char*>(data),
+                          static_cast<DWORD>(length), bytesWritten)) {
+            if (errorCode) *errorCode = GetLastError();
+            return false;
+        }
+        return true;
+    }
+
+    // Finish the current document but keep the printer open for the next one
+    void endDoc() {
+        if (pageStarted_) {
+            EndPagePrinter(handle_);
+            pageStarted_ = false;
+        }
+        if (docStarted_) {
+            EndDocPrinter(handle_);
+            docStarted_ = false;
+        }
+    }
+
+    void close() {
+        endDoc();
+        if (handle_ != NULL) {
+            ClosePrinter(handle_);
+            handle_ = NULL;
+        }
+    }
+
+    bool isValid() const { return handle_ != NULL; }
+    DWORD jobId() const { return jobId_; }  // Spooler job of the last document started
+
+private:
+    HANDLE handle_;
+    DWORD jobId_;
+    bool docStarted_;
+    bool pageStarted_;
+
+    PrinterHandle(const PrinterHandle&) = delete;
+    PrinterHandle& operator=(const PrinterHandle&) = delete;
+};
+#endif
+
+// ============================================================================
+// Pooled CUPS connection (cupspool.cc)
+// ============================================================================
+
+#ifndef _WIN32
+// An http_t connection to cupsd borrowed from the per-server pool. It goes
+// back to the pool on release() or destruction; one that failed below the
+// IPP level is closed instead. Not thread-safe: use from one thread at a time.
+class CupsConnection {
+public:
+    CupsConnection() : http_(nullptr), broken_(false) {}
+
+    ~CupsConnection() {
+        release();
+    }
+
+    bool acquire(std::string& error);
+    bool reconnect();
+    bool refresh();          // Reconnect a held connection the server closed
+    void discardIfBroken();  // Call after a failed CUPS call
+    void release();
+
+    http_t* get() const { return http_; }
+    bool isOpen() const { return http_ != nullptr; }
+
+private:
+    http_t* http_;
+    std::string server_;
+    bool broken_;
+
+    CupsConnection(const CupsConnection&) = delete;
+    CupsConnection& operator=(const CupsConnection&) = delete;
+};
+#endif
+
 // ============================================================================
 // Function Declarations (implemented in separate files)
 // ============================================================================
 
+// addon.cc
+AddonData* GetAddonData(napi_env env);
+
 // printers.cc
 napi_value GetAvailablePrinters(napi_env env, napi_callback_info info);
+bool extractSocketEndpoint(const std::string& deviceUri, std::string& host, int& port);
+bool extractDevicePath(const std::string& deviceUri, std::string& path, SerialSettings& serial);
+bool enumeratePrinters(std::vector<PrinterInfo>& printers);
+napi_value PrinterToObject(napi_env env, const PrinterInfo& printer);
+napi_value PrintersToArray(napi_env env, const std::vector<PrinterInfo>& printers);
+#ifndef _WIN32
+PrinterInfo printerInfoFromDest(const cups_dest_t& dest);
+#endif
 
 // cashdrawer.cc
 napi_value OpenCashDrawer(napi_env env, napi_callback_info info);
+napi_value OpenCashDrawers(napi_env env, napi_callback_info info);
+napi_value SendRaw(napi_env env, napi_callback_info info);
+bool ParseDrawerConfig(napi_env env, napi_value options, DrawerConfig& config, std::string& error);
+OperationResult open_cash_drawer(const std::string& printerName, const DrawerConfig& config = DrawerConfig());
+bool validateDrawerPrinter(const std::string& printerName, OperationResult& result);
+bool resolveTcpEndpoint(const std::string& printerName, const DrawerConfig& config,
+                        TcpEndpoint& endpoint, OperationResult& result);
+bool resolveDeviceTarget(const std::string& printerName, const DrawerConfig& config,
+                         DeviceTarget& target, OperationResult& result);
+std::string CoalesceKey(const DrawerConfig& config);
+napi_value CreateResultObject(napi_env env, const OperationResult& result);
+napi_value SettledResult(napi_env env, const OperationResult& result);
+bool GetOptionalStringProperty(napi_env env, napi_value object, const char* key, std::string& value, bool& present);
+bool GetOptionalInt32Property(napi_env env, napi_value object, const char* key, int32_t& value, bool& present);
+bool GetRawData(napi_env env, napi_value value, const unsigned char*& data, size_t& length);
+#ifdef _WIN32
+OperationResult printRawDocument(PrinterHandle& printer, const std::vector<unsigned char>& data);
+OperationResult printRawDocument(PrinterHandle& printer, const char* title, const DataSegment* segments, size_t count);
+#else
+int submitCupsJob(CupsConnection& cups, const std::string& queue, const std::vector<unsigned char>& data,
+                  SpoolMode spool, OperationResult& result);
+int submitCupsJob(CupsConnection& cups, const std::string& queue, const char* title,
+                  const DataSegment* segments, size_t count, SpoolMode spool, OperationResult& result);
+#endif
+
+// drawerhandle.cc
+napi_value DefineDrawerHandle(napi_env env, AddonData* data);
+napi_value OpenDrawerHandle(napi_env env, napi_callback_info info);
+
+// cupspool.cc
+napi_value GetCupsConnectionStats(napi_env env, napi_callback_info info);
+
+// drawerstatus.cc
+napi_value GetDrawerStatus(napi_env env, napi_callback_info info);
+napi_value WaitForDrawerClosed(napi_env env, napi_callback_info info);
+
+// escpos.cc
+struct EscPosCodePage;
+napi_value EncodeReceipt(napi_env env, napi_callback_info info);
+const EscPosCodePage* findCodePage(const std::string& name);
+size_t encodedTextLength(const unsigned char* text, size_t length);
+unsigned char* encodeText(const EscPosCodePage& page, const unsigned char* text, size_t length, unsigned char* out);
+
+// destcache.cc
+napi_value RefreshPrinters(napi_env env, napi_callback_info info);
+napi_value SetPrinterCacheTtl(napi_env env, napi_callback_info info);
+
+#ifndef _WIN32
+bool resolvePrinterDestination(const std::string& printerName, PrinterDestination& dest, bool* fromCache = nullptr);
+void cachePrinterDestinations(int num_dests, cups_dest_t* dests);
+void prefetchPrinterDestinations(const std::vector<std::string>& printerNames);
+void invalidatePrinterDestination(const std::string& printerName);
+void invalidatePrinterDestinations();
+#endif
+
+// scheduler.cc
+bool InitScheduler(napi_env env, AddonData* data);
+napi_value ScheduleJob(napi_env env, const char* operationName, const std::string& printerName,
+                       JobLane lane, const std::string& coalesceKey, std::function<OperationResult()> run,
+                       ResultFormatter format, napi_ref retained = nullptr, JobHandoff handoff = nullptr);
+void ScheduleNativeJob(const JobWaiter& waiter, const std::string& printerName, JobLane lane,
+                       const std::string& coalesceKey, std::function<OperationResult()> run,
+                       JobHandoff handoff = nullptr);
+napi_value CreatePendingResult(napi_env env, ResultFormatter format, JobWaiter& waiter);
+void DeliverResult(const JobWaiter& waiter, const OperationResult& result);
+size_t GetPrinterQueueDepth(const std::string& printerName);
+napi_value ConfigureScheduler(napi_env env, napi_callback_info info);
+napi_value GetQueueDepth(napi_env env, napi_callback_info info);
+
+// workpool.cc
+bool InitWorkerPool(napi_env env, AddonData* data);
+void SubmitPoolTask(std::function<void()> task);
+WorkCompletion* BeginWorkCompletion(napi_env env, napi_async_complete_callback complete, void* data);
+void FinishWorkCompletion(WorkCompletion* completion);
+void QueuePoolWork(napi_env env, napi_async_execute_callback execute,
+                   napi_async_complete_callback complete, void* data);
+napi_value ConfigureWorkerPool(napi_env env, napi_callback_info info);
+napi_value GetWorkerPoolStats(napi_env env, napi_callback_info info);
+
+// jobtracker.cc
+void trackPrintJob(const std::string& printerName, int jobId, std::chrono::steady_clock::time_point queuedAt,
+                   int timeoutMs, JobCompletionCallback done);
+JobHandoff AwaitCompletionHandoff(const std::string& printerName, const DrawerConfig& config);
+napi_value CompletionResultObject(napi_env env, const OperationResult& result);
+
+// failover.cc
+napi_value OpenCashDrawerFailover(napi_env env, napi_value printers, napi_value options);
+
+// stats.cc
+napi_value GetStats(napi_env env, napi_callback_info info);
+napi_value ResetStats(napi_env env, napi_callback_info info);
+
+// nameindex.cc
+enum NameMatch {
+    NAME_NONE,        // Not indexed; used as given
+    NAME_EXACT,
+    NAME_ALIAS,
+    NAME_NORMALIZED,  // Same queue after folding case and separators
+    NAME_AMBIGUOUS
+};
+
+std::string normalizePrinterName(const std::string& name);
+void indexPrinterNames(const std::vector<PrinterInfo>& printers);
+void indexQueueNames(const std::vector<std::string>& queues);
+bool printerNameIndexBuilt();
+bool resolvePrinterName(const std::string& requested, std::string& resolved, OperationResult& result,
+                        NameMatch* matchedBy = nullptr, std::vector<std::string>* candidates = nullptr);
+napi_value SetPrinterAliases(napi_env env, napi_callback_info info);
+napi_value ResolvePrinterName(napi_env env, napi_callback_info info);
+
+// blocklist.cc
+bool isBlockedVirtualPrinter(const std::string& printerName);
+napi_value ConfigureBlocklist(napi_env env, napi_callback_info info);
+
+// trace.cc
+napi_value StartTrace(napi_env env, napi_callback_info info);
+napi_value StopTrace(napi_env env, napi_callback_info info);
+napi_value DumpTrace(napi_env env, napi_callback_info info);
+
+// raster.cc
+napi_value EncodeRasterImage(napi_env env, napi_callback_info info);
+
+// snapshot.cc
+uint64_t applyPrinterSnapshot(const std::vector<PrinterInfo>& printers);
+void printerDeltaSince(uint64_t since, PrinterDelta& delta);
+
+// watcher.cc
+napi_value WatchPrinters(napi_env env, napi_callback_info info);
+napi_value UnwatchPrinters(napi_env env, napi_callback_info info);
+
+// transport.cc
+OperationResult sendOverTcp(const TcpEndpoint& endpoint, const unsigned char* data, size_t length);
+OperationResult sendToDevice(const DeviceTarget& target, const unsigned char* data, size_t length);
+OperationResult sendOverTcp(const TcpEndpoint& endpoint, const DataSegment* segments, size_t count);
+OperationResult sendToDevice(const DeviceTarget& target, const DataSegment* segments, size_t count);
+OperationResult openTcpEndpoint(const TcpEndpoint& endpoint);
+OperationResult openDeviceTarget(const DeviceTarget& target);
+#ifndef _WIN32
+bool resolveStatusEndpoint(const TcpEndpoint& endpoint, std::vector<ResolvedAddress>& addresses,
+                           std::string& error);
+int takeStatusSocket(const TcpEndpoint& endpoint);
+int startStatusConnect(const ResolvedAddress& address, std::string& error);
+bool finishStatusConnect(int fd, std::string& error);
+ssize_t sendStatusBytes(int fd, const unsigned char* data, size_t length, std::string& error);
+void releaseStatusSocket(const TcpEndpoint& endpoint, int fd);
+int openDeviceStatusFd(const DeviceTarget& target, std::string& error);
+#endif
+
+#ifdef NODE_PRINTER_BENCHMARKS
+// bench/native_bench.cc (node_printer_bench target only)
+napi_value RunNativeBenchmarks(napi_env env, napi_callback_info info);
+napi_value MarshalPrinters(napi_env env, napi_callback_info info);
+#endif
 
 // Export error codes as JS object
 napi_value GetErrorCodes(napi_env env);
@@ -0,0 +1,264 @@
+#include "common.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#endif
+
+// ============================================================================
+// Pooled cupsd connections
+// ============================================================================
+//
+// Passing CUPS_HTTP_DEFAULT to libcups gives every thread its own implicit
+// connection, opened on first use and closed whenever libcups decides to,
+// so bursts of kicks across worker threads churn through short-lived
+// sockets to cupsd. Every CUPS call now borrows an explicit http_t from a
+// small per-server pool instead. Idle connections are checked before reuse,
+// and a reaper thread closes them before cupsd's own keep-alive timeout
+// would, so a burst doesn't leave connections open once printing stops.
+
+static const size_t MAX_IDLE_PER_SERVER = 8;
+static const int IDLE_CONNECTION_MS = 20000;  // cupsd's KeepAliveTimeout defaults to 30s
+static const int CUPS_CONNECT_TIMEOUT_MS = 30000;
+
+namespace {
+
+struct CupsPoolCounters {
+    uint64_t opened;       // New connections, including reconnects
+    uint64_t reused;       // Borrowed from the pool
+    uint64_t reconnected;  // Re-established after the server dropped them
+    uint64_t discarded;    // Closed: stale, broken, or the pool was full
+
+    CupsPoolCounters() : opened(0), reused(0), reconnected(0), discarded(0) {}
+};
+
+#ifndef _WIN32
+typedef std::chrono::steady_clock Clock;
+
+struct IdleConnection {
+    http_t* http;
+    Clock::time_point expiresAt;
+};
+
+// Intentionally leaked: detached worker threads may still release connections
+// during exit, and the reaper still waits on the condition variable
+std::mutex& g_cupsPoolMutex = *new std::mutex();
+std::condition_variable& g_cupsReaperCond = *new std::condition_variable();
+bool g_cupsReaperRunning = false;
+std::unordered_map<std::string, std::vector<IdleConnection>>& g_idleConnections =
+    *new std::unordered_map<std::string, std::vector<IdleConnection>>();
+CupsPoolCounters g_cupsCounters;
+size_t g_connectionsInUse = 0;
+
+// libcups reads the server settings per thread, so key on what this thread would use
+std::string currentServerKey() {
+    return std::string(cupsServer()) + ":" + std::to_string(ippPort()) + ":" +
+           std::to_string(static_cast<int>(cupsEncryption()));
+}
+
+// An idle HTTP connection has nothing to read; anything readable means the
+// server closed it (or sent something we can't make sense of)
+bool isConnectionIdle(http_t* http) {
+    int fd = httpGetFd(http);
+    if (fd < 0) return false;
+
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    int ready;
+    do {
+        ready = poll(&pfd, 1, 0);
+    } while (ready < 0 && errno == EINTR);
+    return ready == 0;
+}
+
+// Closes idle connections once they expire; exits when none are left and is
+// started again by the next release
+void cupsReaperLoop() {
+    std::unique_lock<std::mutex> lock(g_cupsPoolMutex);
+    for (;;) {
+        Clock::time_point now = Clock::now();
+        Clock::time_point next = Clock::time_point::max();
+        std::vector<http_t*> expired;
+
+        for (auto it = g_idleConnections.begin(); it != g_idleConnections.end();) {
+            std::vector<IdleConnection>& idle = it->second;
+            for (size_t i = 0; i < idle.size();) {
+                if (idle[i].expiresAt <= now) {
+                    expired.push_back(idle[i].http);
+                    idle.erase(idle.begin() + i);
+                } else {
+                    if (idle[i].expiresAt < next) next = idle[i].expiresAt;
+                    i++;
+                }
+            }
+            it = idle.empty() ? g_idleConnections.erase(it) : std::next(it);
+        }
+        g_cupsCounters.discarded += expired.size();
+
+        if (!expired.empty()) {
+            lock.unlock();
+            for (http_t* http : expired) httpClose(http);
+            lock.lock();
+            continue;
+        }
+        if (next == Clock::time_point::max()) {
+            g_cupsReaperRunning = false;
+            return;
+        }
+        g_cupsReaperCond.wait_until(lock, next);
+    }
+}
+#endif
+
+} // namespace
+
+#ifndef _WIN32
+bool CupsConnection::acquire(std::string& error) {
+    release();
+    server_ = currentServerKey();
+
+    std::vector<http_t*> stale;
+    {
+        std::lock_guard<std::mutex> lock(g_cupsPoolMutex);
+        auto it = g_idleConnections.find(server_);
+        if (it != g_idleConnections.end()) {
+            std::vector<IdleConnection>& idle = it->second;
+            while (!idle.empty()) {
+                IdleConnection entry = idle.back();
+                idle.pop_back();
+                if (entry.expiresAt > Clock::now() && isConnectionIdle(entry.http)) {
+                    http_ = entry.http;
+                    break;
+                }
+                stale.push_back(entry.http);
+            }
+        }
+        g_cupsCounters.discarded += stale.size();
+        if (http_ != nullptr) {
+            g_cupsCounters.reused++;
+            g_connectionsInUse++;
+        }
+    }
+
+    for (http_t* http : stale) httpClose(http);
+    if (http_ != nullptr) return true;
+
+    {
+        TraceSpan span("httpConnect2");
+        http_ = httpConnect2(cupsServer(), ippPort(), nullptr, AF_UNSPEC, cupsEncryption(), 1,
+                             CUPS_CONNECT_TIMEOUT_MS, nullptr);
+    }
+    if (http_ == nullptr) {
+        error = "Failed to connect to the CUPS server at " + std::string(cupsServer());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(g_cupsPoolMutex);
+    g_cupsCounters.opened++;
+    g_connectionsInUse++;
+    return true;
+}
+
+bool CupsConnection::reconnect() {
+    if (http_ == nullptr || httpReconnect2(http_, CUPS_CONNECT_TIMEOUT_MS, nullptr) != 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(g_cupsPoolMutex);
+    g_cupsCounters.opened++;
+    g_cupsCounters.reconnected++;
+    return true;
+}
+
+// For a connection held between calls; closes it if it can't be re-established
+bool CupsConnection::refresh() {
+    if (http_ == nullptr) return false;
+    if (isConnectionIdle(http_) || reconnect()) return true;
+
+    broken_ = true;
+    release();
+    return false;
+}
+
+void CupsConnection::discardIfBroken() {
+    // Client errors (4xx) are clean IPP answers; anything at or past
+    // internal-error covers libcups' own transport failures
+    if (http_ != nullptr && cupsLastError() >= IPP_STATUS_ERROR_INTERNAL) {
+        broken_ = true;
+        release();
+    }
+}
+
+void CupsConnection::release() {
+    if (http_ == nullptr) return;
+    http_t* http = http_;
+    http_ = nullptr;
+
+    bool keep = false;
+    {
+        std::lock_guard<std::mutex> lock(g_cupsPoolMutex);
+        g_connectionsInUse--;
+        if (!broken_) {
+            std::vector<IdleConnection>& idle = g_idleConnections[server_];
+            if (idle.size() < MAX_IDLE_PER_SERVER) {
+                idle.push_back(IdleConnection{ http, Clock::now() + std::chrono::milliseconds(IDLE_CONNECTION_MS) });
+                keep = true;
+                if (!g_cupsReaperRunning) {
+                    g_cupsReaperRunning = true;
+                    std::thread(cupsReaperLoop).detach();
+                }
+            }
+        }
+        if (!keep) g_cupsCounters.discarded++;
+    }
+    broken_ = false;
+
+    if (!keep) httpClose(http);
+}
+#endif
+
+// ============================================================================
+// Exported N-API functions
+// ============================================================================
+
+// getCupsConnectionStats() -> { opened, reused, reconnected, discarded, idle, inUse }
+napi_value GetCupsConnectionStats(napi_env env, napi_callback_info info) {
+    CupsPoolCounters counters;
+    size_t idle = 0;
+    size_t inUse = 0;
+
+#ifndef _WIN32
+    {
+        std::lock_guard<std::mutex> lock(g_cupsPoolMutex);
+        counters = g_cupsCounters;
+        inUse = g_connectionsInUse;
+        for (const auto& entry : g_idleConnections) idle += entry.second.size();
+    }
+#endif
+
+    napi_value stats, value;
+    NAPI_CALL(env, napi_create_object(env, &stats));
+
+    napi_create_double(env, static_cast<double>(counters.opened), &value);
+    napi_set_named_property(env, stats, "opened", value);
+    napi_create_double(env, static_cast<double>(counters.reused), &value);
+    napi_set_named_property(env, stats, "reused", value);
+    napi_create_double(env, static_cast<double>(counters.reconnected), &value);
+    napi_set_named_property(env, stats, "reconnected", value);
+    napi_create_double(env, static_cast<double>(counters.discarded), &value);
+    napi_set_named_property(env, stats, "discarded", value);
+    napi_create_uint32(env, static_cast<uint32_t>(idle), &value);
+    napi_set_named_property(env, stats, "idle", value);
+    napi_create_uint32(env, static_cast<uint32_t>(inUse), &value);
+    napi_set_named_property(env, stats, "inUse", value);
+
+    return stats;
+}
@@ -0,0 +1,215 @@
+#include "common.h"
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+
+// ============================================================================
+// Process-wide printer destination cache
+// ============================================================================
+//
+// Resolving a queue name used to mean a full cupsGetDests() enumeration on
+// every kick. Destinations are now cached by name for a configurable TTL so
+// the common case is a hash lookup that never talks to cupsd. Misses fetch
+// only the requested queue (cupsGetNamedDest), and enumerate_printers() warms
+// the whole cache as a side effect. Every enumeration also rebuilds the
+// printer name index (nameindex.cc).
+
+static const int64_t DEFAULT_DEST_CACHE_TTL_MS = 60000;
+
+#ifndef _WIN32
+namespace {
+
+struct CachedDestination {
+    PrinterDestination dest;
+    std::chrono::steady_clock::time_point fetchedAt;
+};
+
+std::mutex g_destMutex;
+std::unordered_map<std::string, CachedDestination> g_destCache;
+int64_t g_destTtlMs = DEFAULT_DEST_CACHE_TTL_MS;
+
+void fillDestination(const cups_dest_t& src, PrinterDestination& dest) {
+    dest.name = src.name ? src.name : "";
+    const char* deviceUri = cupsGetOption("device-uri", src.num_options, src.options);
+    dest.deviceUri = deviceUri ? deviceUri : "";
+}
+
+// One cupsGetDests() into the cache and the name index. An empty list is a
+// successful enumeration too; only a failed one leaves both untouched.
+bool loadPrinterDestinations() {
+    CupsConnection cups;
+    std::string error;
+    if (!cups.acquire(error)) return false;
+
+    cups_dest_t* dests = nullptr;
+    int num_dests;
+    {
+        TraceSpan span("cupsGetDests2");
+        num_dests = cupsGetDests2(cups.get(), &dests);
+    }
+    if (num_dests == 0 && cupsLastError() > IPP_STATUS_OK_EVENTS_COMPLETE &&
+        cupsLastError() != IPP_STATUS_ERROR_NOT_FOUND) {
+        cups.discardIfBroken();
+        return false;
+    }
+    cachePrinterDestinations(num_dests, dests);
+    cupsFreeDests(num_dests, dests);
+    return true;
+}
+
+// cupsd doesn't know the name. If nothing has been enumerated yet, the JS
+// side had no index to map a drifted spelling with, so enumerate once and
+// try the queue the index maps it to.
+bool resolveDriftedDestination(const std::string& printerName, PrinterDestination& dest) {
+    if (printerNameIndexBuilt() || !loadPrinterDestinations()) return false;
+
+    std::string resolved;
+    OperationResult ignored;
+    if (!resolvePrinterName(printerName, resolved, ignored) || resolved == printerName) return false;
+    return resolvePrinterDestination(resolved, dest);
+}
+
+} // namespace
+
+bool resolvePrinterDestination(const std::string& printerName, PrinterDestination& dest, bool* fromCache) {
+    if (fromCache) *fromCache = false;
+
+    {
+        std::lock_guard<std::mutex> lock(g_destMutex);
+        auto it = g_destCache.find(printerName);
+        if (it != g_destCache.end()) {
+            auto age = std::chrono::steady_clock::now() - it->second.fetchedAt;
+            if (std::chrono::duration_cast<std::chrono::milliseconds>(age).count() < g_destTtlMs) {
+                dest = it->second.dest;
+                if (fromCache) *fromCache = true;
+                return true;
+            }
+            g_destCache.erase(it);
+        }
+    }
+
+    // Miss or expired: ask cupsd for this one queue only
+    CupsConnection cups;
+    std::string error;
+    if (!cups.acquire(error)) {
+        return false;
+    }
+    cups_dest_t* named;
+    {
+        TraceSpan span("cupsGetNamedDest");
+        named = cupsGetNamedDest(cups.get(), printerName.c_str(), NULL);
+    }
+    if (!named) {
+        cups.discardIfBroken();
+        cups.release();
+        return resolveDriftedDestination(printerName, dest);
+    }
+    fillDestination(*named, dest);
+    cupsFreeDests(1, named);
+
+    std::lock_guard<std::mutex> lock(g_destMutex);
+    if (g_destTtlMs > 0) {
+        CachedDestination& entry = g_destCache[printerName];
+        entry.dest = dest;
+        entry.fetchedAt = std::chrono::steady_clock::now();
+    }
+    return true;
+}
+
+void cachePrinterDestinations(int num_dests, cups_dest_t* dests) {
+    auto now = std::chrono::steady_clock::now();
+
+    // Callers only pass successful enumerations, so an empty one still
+    // counts as building the index and misses don't enumerate again
+    std::vector<std::string> names;
+    for (int i = 0; i < num_dests; i++) {
+        if (dests[i].name && !dests[i].instance) names.push_back(dests[i].name);
+    }
+    indexQueueNames(names);
+
+    std::lock_guard<std::mutex> lock(g_destMutex);
+    // A full enumeration is authoritative: drop queues that have disappeared
+    g_destCache.clear();
+    if (g_destTtlMs <= 0) return;
+
+    for (int i = 0; i < num_dests; i++) {
+        if (!dests[i].name || dests[i].instance) continue;
+        CachedDestination& entry = g_destCache[dests[i].name];
+        fillDestination(dests[i], entry.dest);
+        entry.fetchedAt = now;
+    }
+}
+
+// Resolve a batch of names with at most one enumeration: when several of
+// them are missing from the cache, one cupsGetDests() is cheaper than a
+// cupsGetNamedDest() round trip per name.
+void prefetchPrinterDestinations(const std::vector<std::string>& printerNames) {
+    size_t misses = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_destMutex);
+        if (g_destTtlMs <= 0) return;
+
+        auto now = std::chrono::steady_clock::now();
+        for (const auto& name : printerNames) {
+            auto it = g_destCache.find(name);
+            if (it == g_destCache.end() ||
+                std::chrono::duration_cast<std::chrono::milliseconds>(now - it->second.fetchedAt).count() >= g_destTtlMs) {
+                misses++;
+            }
+        }
+    }
+    if (misses < 2) return;
+
+    loadPrinterDestinations();
+}
+
+void invalidatePrinterDestination(const std::string& printerName) {
+    std::lock_guard<std::mutex> lock(g_destMutex);
+    g_destCache.erase(printerName);
+}
+
+void invalidatePrinterDestinations() {
+    std::lock_guard<std::mutex> lock(g_destMutex);
+    g_destCache.clear();
+}
+
+static void setPrinterDestinationTtl(int64_t ttlMs) {
+    std::lock_guard<std::mutex> lock(g_destMutex);
+    g_destTtlMs = ttlMs;
+    if (ttlMs <= 0) g_destCache.clear();
+}
+#endif
+
+// ============================================================================
+// Exported N-API functions
+// ============================================================================
+
+napi_value RefreshPrinters(napi_env env, napi_callback_info info) {
+#ifndef _WIN32
+    invalidatePrinterDestinations();
+#endif
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    return undefined;
+}
+
+napi_value SetPrinterCacheTtl(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    int64_t ttlMs = 0;
+    if (argc < 1 || napi_get_value_int64(env, args[0], &ttlMs) != napi_ok || ttlMs < 0) {
+        napi_throw_error(env, nullptr, "Expected a non-negative TTL in milliseconds");
+        return nullptr;
+    }
+
+#ifndef _WIN32
+    setPrinterDestinationTtl(ttlMs);
+#endif
+
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    return undefined;
+}
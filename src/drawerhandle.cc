@@ -0,0 +1,438 @@
+#include "common.h"
+
+// ============================================================================
+// Persistent drawer handle
+// ============================================================================
+//
+// openDrawerHandle() validates the printer and resolves its transport once,
+// then keeps that transport open between kicks: a connection to cupsd held
+// out of the pool (an open printer handle on Windows) or the device node.
+// A raw TCP connection stays in the shared pool instead: receipt printers
+// often accept one client at a time, so an idle handle must not lock out
+// other callers beyond keepAliveMs. kick() then only submits the command. Kicks still go through the
+// printer's job queue (scheduler.cc), so they never interleave with
+// openCashDrawer() jobs for the same printer.
+
+namespace {
+
+// Native side of a handle. The JS object and every queued job hold a
+// reference; whichever lets go last closes the transport. Apart from open(),
+// which runs before the handle is visible to JS, everything runs on the
+// printer's queue worker, one call at a time.
+class DrawerSession {
+public:
+    DrawerSession(const std::string& printerName, const DrawerConfig& config)
+        : printerName(printerName), config(config), command(config.buildCommand())
+        , coalesceKey(CoalesceKey(config)) {}
+
+    ~DrawerSession() { shutdown(); }
+
+    OperationResult open();
+    OperationResult kick();
+    void shutdown();
+
+    const std::string printerName;
+    const DrawerConfig config;
+    const std::vector<unsigned char> command;
+    const std::string coalesceKey;
+
+private:
+    OperationResult kickSpooler();
+
+    TcpEndpoint endpoint_;
+    DeviceTarget device_;
+#ifdef _WIN32
+    PrinterHandle printer_;
+#else
+    std::string queue_;
+    CupsConnection cups_;
+#endif
+
+    DrawerSession(const DrawerSession&) = delete;
+    DrawerSession& operator=(const DrawerSession&) = delete;
+};
+
+OperationResult DrawerSession::open() {
+    OperationResult result;
+    if (!validateDrawerPrinter(printerName, result)) {
+        return result;
+    }
+
+    if (config.transport == TRANSPORT_TCP) {
+        if (!resolveTcpEndpoint(printerName, config, endpoint_, result)) return result;
+        return openTcpEndpoint(endpoint_);
+    }
+    if (config.transport == TRANSPORT_DEVICE) {
+        if (!resolveDeviceTarget(printerName, config, device_, result)) return result;
+        return openDeviceTarget(device_);
+    }
+
+#ifdef _WIN32
+    DWORD winError = 0;
+    if (!printer_.open(printerName, &winError)) {
+        result.setError(
+            PRINTER_OPEN_ERROR,
+            "Failed to open printer '" + printerName + "'. Windows Error: " + std::to_string(winError) +
+            ". Make sure the printer is installed and accessible."
+        );
+    }
+#else
+    PrinterDestination dest;
+    if (!resolvePrinterDestination(printerName, dest)) {
+        result.setError(
+            PRINTER_OPEN_ERROR,
+            "Printer not found: '" + printerName + "'. Check printer name and installation."
+        );
+        return result;
+    }
+    queue_ = dest.name;
+
+    // Held for the handle's lifetime rather than per kick
+    std::string error;
+    if (!cups_.acquire(error)) {
+        result.setError(PRINTER_OPEN_ERROR, error);
+    }
+#endif
+    return result;
+}
+
+OperationResult DrawerSession::kick() {
+    StatsClock::time_point start = StatsClock::now();
+    OperationResult result;
+    {
+        StageTimer submit(STAGE_SUBMIT);
+        if (config.transport == TRANSPORT_TCP) {
+            result = sendOverTcp(endpoint_, command.data(), command.size());
+        } else if (config.transport == TRANSPORT_DEVICE) {
+            result = sendToDevice(device_, command.data(), command.size());
+        } else {
+            result = kickSpooler();
+        }
+    }
+    recordPrinterResult(printerName, result, start);
+    return result;
+}
+
+#ifdef _WIN32
+OperationResult DrawerSession::kickSpooler() {
+    OperationResult result = printRawDocument(printer_, command);
+
+    // The printer may have been reinstalled or the spooler restarted since
+    // the handle was opened; reopen once
+    if (result.errorCode == PRINTER_START_DOC_ERROR) {
+        DWORD winError = 0;
+        printer_.close();
+        if (printer_.open(printerName, &winError)) {
+            result = printRawDocument(printer_, command);
+        }
+    }
+    return result;
+}
+#else
+OperationResult DrawerSession::kickSpooler() {
+    // submitCupsJob() reconnects a dropped connection itself
+    OperationResult result;
+    if (submitCupsJob(cups_, queue_, command, config.spool, result) == 0 &&
+        cupsLastError() == IPP_STATUS_ERROR_NOT_FOUND) {
+        // The queue was removed or renamed since the handle was opened. The
+        // same name would fail the same way, so report it once and keep
+        // other kicks from using the stale destination.
+        invalidatePrinterDestination(printerName);
+    }
+    return result;
+}
+#endif
+
+void DrawerSession::shutdown() {
+#ifdef _WIN32
+    printer_.close();
+#else
+    cups_.release();
+#endif
+}
+
+// The JS object's share of the session; session is empty once close() was called
+struct DrawerHandleWrap {
+    std::shared_ptr<DrawerSession> session;
+    std::string printerName;
+    TransportKind transport;
+};
+
+const char* transportName(TransportKind transport) {
+    switch (transport) {
+    case TRANSPORT_TCP: return "tcp";
+    case TRANSPORT_DEVICE: return "device";
+    default: return "spooler";
+    }
+}
+
+void FinalizeDrawerHandle(napi_env env, void* data, void* hint) {
+    delete static_cast<DrawerHandleWrap*>(data);
+}
+
+DrawerHandleWrap* UnwrapHandle(napi_env env, napi_callback_info info) {
+    napi_value self;
+    void* data = nullptr;
+    if (napi_get_cb_info(env, info, nullptr, nullptr, &self, nullptr) != napi_ok ||
+        napi_unwrap(env, self, &data) != napi_ok) {
+        napi_throw_type_error(env, nullptr, "Not a DrawerHandle");
+        return nullptr;
+    }
+    return static_cast<DrawerHandleWrap*>(data);
+}
+
+napi_value UndefinedResult(napi_env env, const OperationResult& result) {
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    return undefined;
+}
+
+// Only openDrawerHandle() constructs handles; it passes the session as an external
+napi_value DrawerHandleConstructor(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_value self;
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) napi_typeof(env, args[0], &type);
+    if (type != napi_external) {
+        napi_throw_type_error(env, nullptr, "DrawerHandle cannot be constructed directly; use openDrawerHandle()");
+        return nullptr;
+    }
+
+    void* session = nullptr;
+    NAPI_CALL(env, napi_get_value_external(env, args[0], &session));
+
+    DrawerHandleWrap* wrap = new DrawerHandleWrap();
+    wrap->session = *static_cast<std::shared_ptr<DrawerSession>*>(session);
+    wrap->printerName = wrap->session->printerName;
+    wrap->transport = wrap->session->config.transport;
+    if (napi_wrap(env, self, wrap, FinalizeDrawerHandle, nullptr, nullptr) != napi_ok) {
+        delete wrap;
+        napi_throw_error(env, nullptr, "Failed to create the drawer handle");
+        return nullptr;
+    }
+    return self;
+}
+
+// kick() -> Promise<{ success, errorCode, errorMessage }>
+napi_value DrawerHandleKick(napi_env env, napi_callback_info info) {
+    DrawerHandleWrap* wrap = UnwrapHandle(env, info);
+    if (wrap == nullptr) return nullptr;
+
+    if (!wrap->session) {
+        OperationResult closed;
+        closed.setError(PRINTER_HANDLE_CLOSED, "Drawer handle is closed");
+
+        napi_deferred deferred;
+        napi_value promise;
+        NAPI_CALL(env, napi_create_promise(env, &deferred, &promise));
+        napi_resolve_deferred(env, deferred, CreateResultObject(env, closed));
+        return promise;
+    }
+
+    std::shared_ptr<DrawerSession> session = wrap->session;
+    napi_value promise = ScheduleJob(
+        env,
+        "DrawerHandle.kick",
+        session->printerName,
+        LANE_KICK,
+        session->coalesceKey,
+        [session]() { return session->kick(); },
+        CreateResultObject,
+        nullptr,
+        AwaitCompletionHandoff(session->printerName, session->config)
+    );
+    if (promise == nullptr) {
+        napi_throw_error(env, nullptr, "Failed to schedule cash drawer job");
+        return nullptr;
+    }
+    return promise;
+}
+
+// close() -> Promise<void>, settled once kicks queued before it have run and
+// the transport is closed
+napi_value DrawerHandleClose(napi_env env, napi_callback_info info) {
+    DrawerHandleWrap* wrap = UnwrapHandle(env, info);
+    if (wrap == nullptr) return nullptr;
+
+    std::shared_ptr<DrawerSession> session;
+    session.swap(wrap->session);
+
+    if (!session) {
+        napi_deferred deferred;
+        napi_value promise, undefined;
+        NAPI_CALL(env, napi_create_promise(env, &deferred, &promise));
+        napi_get_undefined(env, &undefined);
+        napi_resolve_deferred(env, deferred, undefined);
+        return promise;
+    }
+
+    // If the queue is full the job is refused, and the transport closes when
+    // the last queued kick lets go of the session instead
+    std::string printerName = session->printerName;
+    napi_value promise = ScheduleJob(
+        env,
+        "DrawerHandle.close",
+        printerName,
+        LANE_KICK,
+        std::string(),
+        [session]() { session->shutdown(); return OperationResult(); },
+        UndefinedResult
+    );
+    if (promise == nullptr) {
+        napi_throw_error(env, nullptr, "Failed to schedule closing the drawer handle");
+        return nullptr;
+    }
+    return promise;
+}
+
+napi_value DrawerHandlePrinterName(napi_env env, napi_callback_info info) {
+    DrawerHandleWrap* wrap = UnwrapHandle(env, info);
+    if (wrap == nullptr) return nullptr;
+
+    napi_value name;
+    NAPI_CALL(env, napi_create_string_utf8(env, wrap->printerName.c_str(), NAPI_AUTO_LENGTH, &name));
+    return name;
+}
+
+napi_value DrawerHandleTransport(napi_env env, napi_callback_info info) {
+    DrawerHandleWrap* wrap = UnwrapHandle(env, info);
+    if (wrap == nullptr) return nullptr;
+
+    napi_value transport;
+    NAPI_CALL(env, napi_create_string_utf8(env, transportName(wrap->transport), NAPI_AUTO_LENGTH, &transport));
+    return transport;
+}
+
+napi_value DrawerHandleClosed(napi_env env, napi_callback_info info) {
+    DrawerHandleWrap* wrap = UnwrapHandle(env, info);
+    if (wrap == nullptr) return nullptr;
+
+    napi_value closed;
+    NAPI_CALL(env, napi_get_boolean(env, !wrap->session, &closed));
+    return closed;
+}
+
+// ============================================================================
+// Pool work for openDrawerHandle
+// ============================================================================
+
+struct AsyncOpenHandleWork {
+    napi_deferred deferred;
+    std::shared_ptr<DrawerSession> session;
+    OperationResult result;
+    AsyncWorkTrace trace;
+};
+
+void ExecuteOpenHandle(napi_env env, void* data) {
+    AsyncOpenHandleWork* asyncWork = static_cast<AsyncOpenHandleWork*>(data);
+    TraceScope scope(asyncWork->trace.operation, asyncWork->session->printerName.c_str());
+    traceEvent("queueWait", TRACE_ASYNC, asyncWork->trace.queuedAt, StatsClock::now());
+    {
+        TraceSpan execute("execute");
+        if (asyncWork->result.success) asyncWork->result = asyncWork->session->open();
+    }
+    asyncWork->trace.executedAt = StatsClock::now();
+}
+
+void CompleteOpenHandle(napi_env env, napi_status status, void* data) {
+    AsyncOpenHandleWork* asyncWork = static_cast<AsyncOpenHandleWork*>(data);
+    const OperationResult& result = asyncWork->result;
+
+    napi_value outcome = nullptr;
+    bool resolved = false;
+
+    if (result.success) {
+        napi_value constructor, external;
+        AddonData* addon = GetAddonData(env);
+        resolved = napi_get_reference_value(env, addon->drawerHandleConstructor, &constructor) == napi_ok &&
+                   napi_create_external(env, &asyncWork->session, nullptr, nullptr, &external) == napi_ok &&
+                   napi_new_instance(env, constructor, 1, &external, &outcome) == napi_ok;
+    }
+
+    if (!resolved) {
+        napi_value message, code;
+        const std::string text = result.success ? std::string("Failed to create the drawer handle") : result.errorMessage;
+        napi_create_string_utf8(env, text.c_str(), NAPI_AUTO_LENGTH, &message);
+        napi_create_error(env, nullptr, message, &outcome);
+        napi_create_int32(env, result.success ? PRINTER_OTHER_ERROR : result.errorCode, &code);
+        napi_set_named_property(env, outcome, "errorCode", code);
+        napi_reject_deferred(env, asyncWork->deferred, outcome);
+    } else {
+        napi_resolve_deferred(env, asyncWork->deferred, outcome);
+    }
+    TraceScope scope(asyncWork->trace.operation, nullptr);
+    traceEvent("completion", TRACE_ASYNC, asyncWork->trace.executedAt, StatsClock::now());
+    traceEvent("openDrawerHandle", TRACE_ASYNC, asyncWork->trace.queuedAt, StatsClock::now());
+
+    delete asyncWork;
+}
+
+} // namespace
+
+// ============================================================================
+// Exported N-API functions
+// ============================================================================
+
+// Defines the DrawerHandle class and keeps its constructor for openDrawerHandle()
+napi_value DefineDrawerHandle(napi_env env, AddonData* data) {
+    napi_property_descriptor properties[] = {
+        { "kick", nullptr, DrawerHandleKick, nullptr, nullptr, nullptr, napi_default_method, nullptr },
+        { "close", nullptr, DrawerHandleClose, nullptr, nullptr, nullptr, napi_default_method, nullptr },
+        { "printerName", nullptr, nullptr, DrawerHandlePrinterName, nullptr, nullptr, napi_enumerable, nullptr },
+        { "transport", nullptr, nullptr, DrawerHandleTransport, nullptr, nullptr, napi_enumerable, nullptr },
+        { "closed", nullptr, nullptr, DrawerHandleClosed, nullptr, nullptr, napi_enumerable, nullptr }
+    };
+
+    napi_value constructor;
+    if (napi_define_class(env, "DrawerHandle", NAPI_AUTO_LENGTH, DrawerHandleConstructor, nullptr,
+                          sizeof(properties) / sizeof(properties[0]), properties, &constructor) != napi_ok ||
+        napi_create_reference(env, constructor, 1, &data->drawerHandleConstructor) != napi_ok) {
+        return nullptr;
+    }
+    return constructor;
+}
+
+// openDrawerHandle(printerName, options) -> Promise<DrawerHandle>
+napi_value OpenDrawerHandle(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    if (argc < 1) {
+        napi_throw_error(env, nullptr, "Expected at least 1 argument: printer name");
+        return nullptr;
+    }
+
+    std::string printer_name;
+    if (!GetPrinterNameFromArg(env, args[0], printer_name)) {
+        napi_throw_error(env, nullptr, "First argument must be a string (printer name) with max 256 characters");
+        return nullptr;
+    }
+
+    DrawerConfig config;
+    if (argc >= 2) {
+        std::string error;
+        if (!ParseDrawerConfig(env, args[1], config, error)) {
+            napi_throw_error(env, nullptr, error.c_str());
+            return nullptr;
+        }
+    }
+
+    napi_value promise;
+    napi_deferred deferred;
+    NAPI_CALL(env, napi_create_promise(env, &deferred, &promise));
+
+    // An ambiguous name rejects like a failed open
+    AsyncOpenHandleWork* asyncWork = new AsyncOpenHandleWork();
+    asyncWork->deferred = deferred;
+    resolvePrinterName(printer_name, printer_name, asyncWork->result);
+    asyncWork->session = std::make_shared<DrawerSession>(printer_name, config);
+
+    QueuePoolWork(env, ExecuteOpenHandle, CompleteOpenHandle, asyncWork);
+
+    return promise;
+}
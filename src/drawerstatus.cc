@@ -0,0 +1,722 @@
+#include "common.h"
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#ifndef _WIN32
+#include <poll.h>
+#endif
+
+// ============================================================================
+// Real-time drawer status
+// ============================================================================
+//
+// getDrawerStatus() and waitForDrawerClosed() ask the printer itself with the
+// ESC/POS real-time status request DLE EOT 1. Its answer carries the level of
+// pin 3 on the drawer kick-out connector, which the drawer's switch drives.
+// Reading the answer needs a transport that talks both ways: raw TCP or the
+// device node. One status-reader thread serves every request. It keeps a
+// descriptor per printer and sleeps in poll() on all of them plus a wake-up
+// pipe, so a wait costs nothing between answers and JS never polls. Anything
+// that could block it (CUPS lookups, name resolution, device writes) runs on
+// the worker pool, so one unreachable printer can't hold up the others. A tcp
+// socket goes back to the idle pool after each answer and is taken again for
+// the next query, so kicks can share it during a long wait.
+
+static const unsigned char DRAWER_STATUS_QUERY[] = { 0x10, 0x04, 0x01 };  // DLE EOT 1
+static const unsigned char STATUS_DRAWER_PIN_HIGH = 0x04;
+static const int STATUS_RESPONSE_TIMEOUT_MS = 1000;
+static const int DEFAULT_STATUS_INTERVAL_MS = 200;
+static const int MIN_STATUS_INTERVAL_MS = 50;
+static const int DEFAULT_WAIT_TIMEOUT_MS = 30000;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct StatusRequest {
+    std::string printerName;
+    DrawerConfig config;
+    bool openWhenHigh;   // drawerOpenLevel: "high"
+    bool waitForClosed;  // waitForDrawerClosed() rather than a single reading
+    int timeoutMs;
+    int intervalMs;
+    Clock::time_point deadline;
+    bool answered;
+    JobWaiter waiter;
+
+    StatusRequest()
+        : openWhenHigh(false), waitForClosed(false), timeoutMs(DEFAULT_WAIT_TIMEOUT_MS)
+        , intervalMs(DEFAULT_STATUS_INTERVAL_MS), answered(false) {}
+};
+
+// Answers are 0xx1xx10 (bits 1 and 4 set, 0 and 7 clear), which tells them
+// apart from Automatic Status Back bytes the printer may send on its own
+bool isStatusResponse(unsigned char byte) {
+    return (byte & 0x93) == 0x12;
+}
+
+napi_value DrawerStatusResult(napi_env env, const OperationResult& result) {
+    napi_value object = CreateResultObject(env, result);
+    if (result.success) {
+        napi_value open;
+        napi_get_boolean(env, result.value != 0, &open);
+        napi_set_named_property(env, object, "drawerOpen", open);
+    }
+    return object;
+}
+
+#ifndef _WIN32
+enum QueryState {
+    QUERY_IDLE,
+    QUERY_CONNECTING,    // tcp: connect in progress, polled for POLLOUT
+    QUERY_WRITING,       // tcp: query partly sent, polled for POLLOUT
+    QUERY_DEVICE_WRITE,  // device: query being written on the worker pool
+    QUERY_AWAITING       // query sent, polled for POLLIN
+};
+
+struct StatusChannel {
+    TransportKind transport;  // TRANSPORT_TCP or TRANSPORT_DEVICE
+    TcpEndpoint endpoint;
+    std::vector<ResolvedAddress> addresses;
+    size_t nextAddress;       // Next address to try while connecting
+    DeviceTarget device;
+    int fd;
+    QueryState state;
+    size_t querySent;
+    Clock::time_point stateDeadline;  // Connect, write or answer timeout
+    Clock::time_point nextQueryAt;
+    std::vector<StatusRequest> requests;
+
+    StatusChannel() : transport(TRANSPORT_TCP), nextAddress(0), fd(-1), state(QUERY_IDLE), querySent(0) {}
+};
+
+// A request whose channel was worked out on the worker pool
+struct ResolvedRequest {
+    StatusRequest request;
+    StatusChannel channel;
+    std::string key;
+};
+
+// A device query written on the worker pool, handed back to the reader
+struct DeviceQueryOutcome {
+    std::string key;
+    int fd;  // Newly opened status descriptor, or -1
+    int errorCode;
+    std::string error;
+};
+
+// Intentionally leaked: the detached reader may still touch these during exit
+std::mutex& g_statusMutex = *new std::mutex();
+std::vector<ResolvedRequest>& g_incomingRequests = *new std::vector<ResolvedRequest>();
+std::vector<DeviceQueryOutcome>& g_deviceOutcomes = *new std::vector<DeviceQueryOutcome>();
+bool g_statusReaderRunning = false;
+int g_statusWakePipe[2] = { -1, -1 };
+
+void statusReaderLoop();
+
+void deliverStatus(const StatusRequest& request, const OperationResult& result) {
+    DeliverResult(request.waiter, result);
+}
+
+void deliverError(const StatusRequest& request, int code, const std::string& message) {
+    OperationResult result;
+    result.setError(code, message);
+    deliverStatus(request, result);
+}
+
+// Starts the reader if it has exited, otherwise wakes it; caller holds
+// g_statusMutex
+void wakeStatusReader() {
+    if (!g_statusReaderRunning) {
+        g_statusReaderRunning = true;
+        std::thread(statusReaderLoop).detach();
+    } else {
+        char byte = 0;
+        ssize_t ignored = write(g_statusWakePipe[1], &byte, 1);
+        (void)ignored;
+    }
+}
+
+// Work out where to ask: an explicit tcp or device transport, or the
+// spooler queue's own socket:// or device URI. Runs on the worker pool, as
+// the CUPS lookup and name resolution may block.
+bool resolveStatusChannel(const StatusRequest& request, StatusChannel& channel, std::string& key,
+                          OperationResult& result) {
+    if (!validateDrawerPrinter(request.printerName, result)) return false;
+
+    TransportKind transport = request.config.transport;
+    channel.endpoint = request.config.tcp;
+    channel.device = request.config.device;
+
+    if (transport == TRANSPORT_SPOOLER) {
+        PrinterDestination dest;
+        int port = 0;
+        if (!resolvePrinterDestination(request.printerName, dest)) {
+            result.setError(
+                PRINTER_OPEN_ERROR,
+                "Printer not found: '" + request.printerName + "'. Check printer name and installation."
+            );
+            return false;
+        }
+        if (extractSocketEndpoint(dest.deviceUri, channel.endpoint.host, port)) {
+            channel.endpoint.port = port;
+            transport = TRANSPORT_TCP;
+        } else if (extractDevicePath(dest.deviceUri, channel.device.path, channel.device.serial)) {
+            if (request.config.serialOptionsGiven) channel.device.serial = request.config.device.serial;
+            transport = TRANSPORT_DEVICE;
+        } else {
+            result.setError(
+                PRINTER_STATUS_UNAVAILABLE,
+                "Printer '" + request.printerName + "' can't report its status through the spooler. "
+                "Pass transport 'tcp' or 'device'."
+            );
+            return false;
+        }
+    } else if (transport == TRANSPORT_TCP) {
+        if (!resolveTcpEndpoint(request.printerName, request.config, channel.endpoint, result)) return false;
+    } else {
+        if (!resolveDeviceTarget(request.printerName, request.config, channel.device, result)) return false;
+    }
+
+    if (transport == TRANSPORT_TCP) {
+        std::string error;
+        if (!resolveStatusEndpoint(channel.endpoint, channel.addresses, error)) {
+            result.setError(PRINTER_OPEN_ERROR, error);
+            return false;
+        }
+    }
+
+    channel.transport = transport;
+    key = transport == TRANSPORT_TCP
+        ? "tcp:" + channel.endpoint.host + ":" + std::to_string(channel.endpoint.port)
+        : "device:" + channel.device.path;
+    return true;
+}
+
+void resolveOnPool(const StatusRequest& request) {
+    ResolvedRequest resolved;
+    resolved.request = request;
+    OperationResult result;
+    if (!resolveStatusChannel(request, resolved.channel, resolved.key, result)) {
+        deliverStatus(request, result);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(g_statusMutex);
+    g_incomingRequests.push_back(resolved);
+    wakeStatusReader();
+}
+
+std::string endpointName(const StatusChannel& channel) {
+    return channel.endpoint.host + ":" + std::to_string(channel.endpoint.port);
+}
+
+void closeChannelFd(StatusChannel& channel, bool reusable) {
+    if (channel.fd >= 0) {
+        if (reusable && channel.transport == TRANSPORT_TCP && channel.state == QUERY_IDLE) {
+            releaseStatusSocket(channel.endpoint, channel.fd);
+        } else {
+            close(channel.fd);
+        }
+    }
+    channel.fd = -1;
+    channel.state = QUERY_IDLE;
+}
+
+int channelIntervalMs(const StatusChannel& channel) {
+    int interval = DEFAULT_STATUS_INTERVAL_MS;
+    bool first = true;
+    for (const auto& request : channel.requests) {
+        if (first || request.intervalMs < interval) interval = request.intervalMs;
+        first = false;
+    }
+    return interval;
+}
+
+// The printer could not be reached. Single readings and waits that never got
+// an answer fail now; waits that did keep retrying until their deadline.
+void failChannel(StatusChannel& channel, int code, const std::string& message) {
+    std::vector<StatusRequest> remaining;
+    for (const auto& request : channel.requests) {
+        if (request.waitForClosed && request.answered) {
+            remaining.push_back(request);
+        } else {
+            deliverError(request, code, message);
+        }
+    }
+    channel.requests.swap(remaining);
+    channel.nextQueryAt = Clock::now() + std::chrono::milliseconds(channelIntervalMs(channel));
+}
+
+void handleStatus(StatusChannel& channel, unsigned char status) {
+    bool pinHigh = (status & STATUS_DRAWER_PIN_HIGH) != 0;
+
+    std::vector<StatusRequest> remaining;
+    for (auto& request : channel.requests) {
+        bool open = pinHigh == request.openWhenHigh;
+        if (request.waitForClosed && open) {
+            request.answered = true;
+            remaining.push_back(request);
+            continue;
+        }
+        OperationResult result;
+        result.value = open ? 1 : 0;
+        deliverStatus(request, result);
+    }
+    channel.requests.swap(remaining);
+    channel.state = QUERY_IDLE;
+    // Printers that take one client at a time would refuse the spooler and
+    // tcp kicks for a whole wait, so the socket goes back between queries
+    if (channel.transport == TRANSPORT_TCP) closeChannelFd(channel, true);
+    channel.nextQueryAt = Clock::now() + std::chrono::milliseconds(channelIntervalMs(channel));
+}
+
+void awaitAnswer(StatusChannel& channel) {
+    channel.state = QUERY_AWAITING;
+    channel.stateDeadline = Clock::now() + std::chrono::milliseconds(STATUS_RESPONSE_TIMEOUT_MS);
+}
+
+// Sends what is left of the query without blocking; the rest goes out when
+// poll() reports the socket writable again
+void writeQuery(StatusChannel& channel) {
+    std::string error;
+    ssize_t n = sendStatusBytes(channel.fd, DRAWER_STATUS_QUERY + channel.querySent,
+                                sizeof(DRAWER_STATUS_QUERY) - channel.querySent, error);
+    if (n < 0) {
+        closeChannelFd(channel, false);
+        failChannel(channel, PRINTER_WRITE_ERROR, "Failed to send the status request: " + error);
+        return;
+    }
+    channel.querySent += static_cast<size_t>(n);
+    if (channel.querySent == sizeof(DRAWER_STATUS_QUERY)) awaitAnswer(channel);
+}
+
+void beginWrite(StatusChannel& channel) {
+    channel.state = QUERY_WRITING;
+    channel.querySent = 0;
+    channel.stateDeadline = Clock::now() + std::chrono::milliseconds(channel.endpoint.writeTimeoutMs);
+    writeQuery(channel);
+}
+
+// Starts a non-blocking connect to the next address, which poll() then
+// watches for POLLOUT. The connect timeout spans every address.
+void connectNextAddress(StatusChannel& channel, std::string error) {
+    while (channel.nextAddress < channel.addresses.size()) {
+        int fd = startStatusConnect(channel.addresses[channel.nextAddress++], error);
+        if (fd >= 0) {
+            channel.fd = fd;
+            channel.state = QUERY_CONNECTING;
+            return;
+        }
+    }
+    channel.state = QUERY_IDLE;
+    failChannel(channel, PRINTER_OPEN_ERROR, "Failed to connect to " + endpointName(channel) + ": " + error);
+}
+
+void finishConnect(StatusChannel& channel) {
+    std::string error;
+    if (finishStatusConnect(channel.fd, error)) {
+        beginWrite(channel);
+        return;
+    }
+    close(channel.fd);
+    channel.fd = -1;
+    connectNextAddress(channel, error);
+}
+
+// The query goes through the shared device lock so it never splits a kick,
+// and a kick may hold that lock for its whole write timeout, so the write
+// runs on the worker pool and its outcome comes back through the reader's
+// queue
+void startDeviceQuery(StatusChannel& channel, const std::string& key) {
+    channel.state = QUERY_DEVICE_WRITE;
+    DeviceTarget device = channel.device;
+    bool needFd = channel.fd < 0;
+
+    SubmitPoolTask([key, device, needFd]() {
+        DeviceQueryOutcome outcome;
+        outcome.key = key;
+        outcome.fd = -1;
+        outcome.errorCode = PRINTER_SUCCESS;
+        if (needFd) {
+            outcome.fd = openDeviceStatusFd(device, outcome.error);
+            if (outcome.fd < 0) outcome.errorCode = PRINTER_OPEN_ERROR;
+        }
+        if (outcome.errorCode == PRINTER_SUCCESS) {
+            OperationResult result = sendToDevice(device, DRAWER_STATUS_QUERY, sizeof(DRAWER_STATUS_QUERY));
+            if (!result.success) {
+                outcome.errorCode = PRINTER_WRITE_ERROR;
+                outcome.error = "Failed to send the status request: " + result.errorMessage;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(g_statusMutex);
+        g_deviceOutcomes.push_back(outcome);
+        wakeStatusReader();
+    });
+}
+
+void handleDeviceOutcome(std::map<std::string, StatusChannel>& channels, const DeviceQueryOutcome& outcome) {
+    auto it = channels.find(outcome.key);
+    if (it == channels.end() || it->second.state != QUERY_DEVICE_WRITE) {
+        if (outcome.fd >= 0) close(outcome.fd);
+        return;
+    }
+
+    StatusChannel& channel = it->second;
+    if (outcome.fd >= 0) channel.fd = outcome.fd;
+    if (outcome.errorCode != PRINTER_SUCCESS) {
+        closeChannelFd(channel, false);
+        failChannel(channel, outcome.errorCode, outcome.error);
+        return;
+    }
+    awaitAnswer(channel);
+}
+
+void startQuery(StatusChannel& channel, const std::string& key) {
+    if (channel.transport == TRANSPORT_DEVICE) {
+        startDeviceQuery(channel, key);
+        return;
+    }
+    if (channel.fd >= 0) {
+        beginWrite(channel);
+        return;
+    }
+
+    channel.fd = takeStatusSocket(channel.endpoint);
+    if (channel.fd >= 0) {
+        beginWrite(channel);
+        return;
+    }
+    channel.nextAddress = 0;
+    channel.stateDeadline = Clock::now() + std::chrono::milliseconds(channel.endpoint.connectTimeoutMs);
+    connectNextAddress(channel, "no address to connect to");
+}
+
+// Drain what the printer sent; 1 with the latest answer, 0 if none yet, -1 if
+// the connection is gone
+int readStatus(StatusChannel& channel, unsigned char& status) {
+    bool found = false;
+    bool readAny = false;
+    unsigned char buffer[64];
+
+    for (;;) {
+        ssize_t n = read(channel.fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            readAny = true;
+            for (ssize_t i = 0; i < n; i++) {
+                if (isStatusResponse(buffer[i])) {
+                    status = buffer[i];
+                    found = true;
+                }
+            }
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        // End of file, or a read error; a device may also report 0 once drained
+        if (!readAny) return -1;
+        break;
+    }
+    return found ? 1 : 0;
+}
+
+int millisUntil(Clock::time_point deadline, Clock::time_point now) {
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+    return remaining > 0 ? static_cast<int>(remaining) + 1 : 0;
+}
+
+void addRequest(std::map<std::string, StatusChannel>& channels, ResolvedRequest& resolved) {
+    auto it = channels.find(resolved.key);
+    if (it == channels.end()) {
+        resolved.channel.nextQueryAt = Clock::now();
+        it = channels.insert(std::make_pair(resolved.key, resolved.channel)).first;
+    } else if (it->second.state == QUERY_IDLE) {
+        it->second.nextQueryAt = Clock::now();
+    }
+    it->second.requests.push_back(resolved.request);
+}
+
+void expireRequests(StatusChannel& channel, Clock::time_point now) {
+    if ((channel.state == QUERY_CONNECTING || channel.state == QUERY_WRITING) && now >= channel.stateDeadline) {
+        bool connecting = channel.state == QUERY_CONNECTING;
+        closeChannelFd(channel, false);
+        if (connecting) {
+            failChannel(channel, PRINTER_OPEN_ERROR, "Connection to " + endpointName(channel) + " timed out");
+        } else {
+            failChannel(channel, PRINTER_WRITE_ERROR, "Timed out sending the status request to " + endpointName(channel));
+        }
+    }
+
+    if (channel.state == QUERY_AWAITING && now >= channel.stateDeadline) {
+        // No answer: the printer is busy with something that blocks real-time
+        // commands, or doesn't support them. A device descriptor may also be
+        // stale after a kick reopened the device, so start afresh.
+        closeChannelFd(channel, false);
+        std::vector<StatusRequest> remaining;
+        for (const auto& request : channel.requests) {
+            if (request.waitForClosed) {
+                remaining.push_back(request);
+            } else {
+                deliverError(request, PRINTER_STATUS_UNAVAILABLE,
+                             "Printer '" + request.printerName + "' did not answer the status request within " +
+                             std::to_string(STATUS_RESPONSE_TIMEOUT_MS) + " ms");
+            }
+        }
+        channel.requests.swap(remaining);
+        channel.nextQueryAt = now;
+    }
+
+    std::vector<StatusRequest> remaining;
+    for (const auto& request : channel.requests) {
+        if (!request.waitForClosed || now < request.deadline) {
+            remaining.push_back(request);
+        } else if (request.answered) {
+            deliverError(request, PRINTER_TIMEOUT,
+                         "Drawer on '" + request.printerName + "' still open after " +
+                         std::to_string(request.timeoutMs) + " ms");
+        } else {
+            deliverError(request, PRINTER_STATUS_UNAVAILABLE,
+                         "Printer '" + request.printerName + "' did not report its drawer status within " +
+                         std::to_string(request.timeoutMs) + " ms");
+        }
+    }
+    channel.requests.swap(remaining);
+}
+
+// Only ever waits in poll(): lookups and device writes run on the worker
+// pool, and connects and socket writes are non-blocking
+void statusReaderLoop() {
+    std::map<std::string, StatusChannel> channels;
+
+    for (;;) {
+        std::vector<ResolvedRequest> incoming;
+        std::vector<DeviceQueryOutcome> outcomes;
+        {
+            std::lock_guard<std::mutex> lock(g_statusMutex);
+            incoming.swap(g_incomingRequests);
+            outcomes.swap(g_deviceOutcomes);
+            if (incoming.empty() && outcomes.empty() && channels.empty()) {
+                g_statusReaderRunning = false;
+                return;
+            }
+        }
+        for (const auto& outcome : outcomes) {
+            handleDeviceOutcome(channels, outcome);
+        }
+        for (auto& resolved : incoming) {
+            addRequest(channels, resolved);
+        }
+
+        Clock::time_point now = Clock::now();
+        for (auto it = channels.begin(); it != channels.end();) {
+            StatusChannel& channel = it->second;
+            expireRequests(channel, now);
+            if (!channel.requests.empty() && channel.state == QUERY_IDLE && channel.nextQueryAt <= now) {
+                startQuery(channel, it->first);
+            }
+            // A device write in flight reports back to its channel, so the
+            // channel stays until then
+            if (channel.requests.empty() && channel.state != QUERY_DEVICE_WRITE) {
+                closeChannelFd(channel, true);
+                it = channels.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        // Sleep until an answer arrives, a connect or write can go on, new
+        // work wakes us, or the next query, timeout or wait deadline is due
+        std::vector<struct pollfd> fds;
+        std::vector<StatusChannel*> polled;
+        struct pollfd wake;
+        wake.fd = g_statusWakePipe[0];
+        wake.events = POLLIN;
+        wake.revents = 0;
+        fds.push_back(wake);
+
+        now = Clock::now();
+        int timeoutMs = -1;
+        for (auto& entry : channels) {
+            StatusChannel& channel = entry.second;
+            bool due = channel.state != QUERY_DEVICE_WRITE;
+            Clock::time_point dueAt = channel.state == QUERY_IDLE ? channel.nextQueryAt : channel.stateDeadline;
+            for (const auto& request : channel.requests) {
+                if (request.waitForClosed && (!due || request.deadline < dueAt)) {
+                    dueAt = request.deadline;
+                    due = true;
+                }
+            }
+            if (due) {
+                int wait = millisUntil(dueAt, now);
+                if (timeoutMs < 0 || wait < timeoutMs) timeoutMs = wait;
+            }
+
+            short events = 0;
+            if (channel.state == QUERY_CONNECTING || channel.state == QUERY_WRITING) events = POLLOUT;
+            if (channel.state == QUERY_AWAITING) events = POLLIN;
+            if (events != 0) {
+                struct pollfd pfd;
+                pfd.fd = channel.fd;
+                pfd.events = events;
+                pfd.revents = 0;
+                fds.push_back(pfd);
+                polled.push_back(&channel);
+            }
+        }
+
+        int ready = poll(fds.data(), fds.size(), timeoutMs);
+        if (ready <= 0) continue;
+
+        if (fds[0].revents & POLLIN) {
+            char drain[64];
+            while (read(g_statusWakePipe[0], drain, sizeof(drain)) > 0) {}
+        }
+
+        for (size_t i = 0; i < polled.size(); i++) {
+            short revents = fds[i + 1].revents;
+            if (revents == 0) continue;
+
+            StatusChannel& channel = *polled[i];
+            if (channel.state == QUERY_CONNECTING) {
+                finishConnect(channel);
+            } else if (channel.state == QUERY_WRITING) {
+                if (revents & POLLOUT) {
+                    writeQuery(channel);
+                } else {
+                    closeChannelFd(channel, false);
+                    failChannel(channel, PRINTER_WRITE_ERROR, "The printer closed the connection");
+                }
+            } else {
+                unsigned char status = 0;
+                int outcome = (revents & (POLLIN | POLLHUP | POLLERR)) ? readStatus(channel, status) : -1;
+                if (outcome > 0) {
+                    handleStatus(channel, status);
+                } else if (outcome < 0) {
+                    closeChannelFd(channel, false);
+                    failChannel(channel, PRINTER_WRITE_ERROR, "The printer closed the connection");
+                }
+            }
+        }
+    }
+}
+
+void submitStatusRequest(StatusRequest& request) {
+    {
+        std::lock_guard<std::mutex> lock(g_statusMutex);
+        if (g_statusWakePipe[0] < 0) {
+            if (pipe(g_statusWakePipe) != 0) {
+                deliverError(request, PRINTER_OTHER_ERROR, "Failed to start the status reader: " + std::string(std::strerror(errno)));
+                return;
+            }
+            for (int fd : g_statusWakePipe) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+                fcntl(fd, F_SETFD, FD_CLOEXEC);
+            }
+        }
+    }
+
+    // Waits run from the call, not from when the lookup finished
+    request.deadline = Clock::now() + std::chrono::milliseconds(request.timeoutMs);
+    StatusRequest copy = request;
+    SubmitPoolTask([copy]() { resolveOnPool(copy); });
+}
+#else
+void submitStatusRequest(StatusRequest& request) {
+    OperationResult result;
+    result.setError(PRINTER_STATUS_UNAVAILABLE, "Drawer status is not supported on Windows");
+    DeliverResult(request.waiter, result);
+}
+#endif
+
+// Shared argument handling; false once a JS exception is pending
+bool ParseStatusArguments(napi_env env, napi_callback_info info, bool waiting, StatusRequest& request) {
+    size_t argc = 2;
+    napi_value args[2];
+
+    if (napi_get_cb_info(env, info, &argc, args, nullptr, nullptr) != napi_ok) return false;
+
+    if (argc < 1) {
+        napi_throw_error(env, nullptr, "Expected at least 1 argument: printer name");
+        return false;
+    }
+    if (!GetPrinterNameFromArg(env, args[0], request.printerName)) {
+        napi_throw_error(env, nullptr, "First argument must be a string (printer name) with max 256 characters");
+        return false;
+    }
+    request.waitForClosed = waiting;
+
+    napi_valuetype type = napi_undefined;
+    if (argc >= 2) napi_typeof(env, args[1], &type);
+    if (type != napi_object) return true;
+
+    std::string error;
+    if (!ParseDrawerConfig(env, args[1], request.config, error)) {
+        napi_throw_error(env, nullptr, error.c_str());
+        return false;
+    }
+
+    std::string level;
+    bool present;
+    if (!GetOptionalStringProperty(env, args[1], "drawerOpenLevel", level, present) ||
+        (present && level != "low" && level != "high")) {
+        napi_throw_error(env, nullptr, "Invalid options: drawerOpenLevel must be 'low' or 'high'");
+        return false;
+    }
+    request.openWhenHigh = present && level == "high";
+
+    if (!waiting) return true;
+
+    int32_t value = 0;
+    if (!GetOptionalInt32Property(env, args[1], "timeout", value, present) || (present && value <= 0)) {
+        napi_throw_error(env, nullptr, "Invalid options: timeout must be a positive number of milliseconds");
+        return false;
+    }
+    if (present) request.timeoutMs = value;
+
+    if (!GetOptionalInt32Property(env, args[1], "intervalMs", value, present) ||
+        (present && value < MIN_STATUS_INTERVAL_MS)) {
+        napi_throw_error(env, nullptr, "Invalid options: intervalMs must be at least 50");
+        return false;
+    }
+    if (present) request.intervalMs = value;
+    return true;
+}
+
+napi_value StartStatusRequest(napi_env env, napi_callback_info info, bool waiting) {
+    StatusRequest request;
+    if (!ParseStatusArguments(env, info, waiting, request)) return nullptr;
+
+    OperationResult resolution;
+    bool resolved = resolvePrinterName(request.printerName, request.printerName, resolution);
+
+    napi_value promise = CreatePendingResult(env, DrawerStatusResult, request.waiter);
+    if (promise == nullptr) {
+        napi_throw_error(env, nullptr, "Failed to create the status request");
+        return nullptr;
+    }
+    if (resolved) {
+        submitStatusRequest(request);
+    } else {
+        DeliverResult(request.waiter, resolution);
+    }
+    return promise;
+}
+
+} // namespace
+
+// ============================================================================
+// Exported N-API functions
+// ============================================================================
+
+// getDrawerStatus(printerName, options) -> Promise<{ success, errorCode, errorMessage, drawerOpen }>
+napi_value GetDrawerStatus(napi_env env, napi_callback_info info) {
+    return StartStatusRequest(env, info, false);
+}
+
+// waitForDrawerClosed(printerName, { timeout, intervalMs }) -> Promise<{ success, errorCode, errorMessage, drawerOpen }>
+napi_value WaitForDrawerClosed(napi_env env, napi_callback_info info) {
+    return StartStatusRequest(env, info, true);
+}
@@ -0,0 +1,511 @@
+#include "common.h"
+#include <algorithm>
+#include <initializer_list>
+
+// ============================================================================
+// ESC/POS text encoder
+// ============================================================================
+//
+// encodeReceipt() turns strings and formatting directives into one ESC/POS
+// byte stream. Text is transcoded from UTF-8 to the printer's single-byte
+// code page with precomputed tables: Latin-1 code points index straight into
+// a 128-entry table and the few others are binary-searched. Runs of ASCII,
+// most of any receipt, are checked and copied eight bytes at a time. Every
+// code point becomes exactly one byte, so the output size is known before
+// anything is written and the stream is encoded straight into a Buffer of
+// that size.
+
+static const unsigned char UNMAPPED_REPLACEMENT = '?';
+static const int MAX_FEED_LINES = 255;
+
+struct CodePointMapping {
+    uint16_t codePoint;
+    unsigned char byte;
+};
+
+// U+0080-U+00FF -> CP437 byte (0 = not in the code page)
+static const unsigned char CP437_LATIN1[128] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xFF, 0xAD, 0x9B, 0x9C, 0x00, 0x9D, 0x00, 0x00, 0x00, 0x00, 0xA6, 0xAE, 0xAA, 0x00, 0x00, 0x00,
+    0xF8, 0xF1, 0xFD, 0x00, 0x00, 0xE6, 0x00, 0xFA, 0x00, 0x00, 0xA7, 0xAF, 0xAC, 0xAB, 0x00, 0xA8,
+    0x00, 0x00, 0x00, 0x00, 0x8E, 0x8F, 0x92, 0x80, 0x00, 0x90, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0xA5, 0x00, 0x00, 0x00, 0x00, 0x99, 0x00, 0x00, 0x00, 0x00, 0x00, 0x9A, 0x00, 0x00, 0xE1,
+    0x85, 0xA0, 0x83, 0x00, 0x84, 0x86, 0x91, 0x87, 0x8A, 0x82, 0x88, 0x89, 0x8D, 0xA1, 0x8C, 0x8B,
+    0x00, 0xA4, 0x95, 0xA2, 0x93, 0x00, 0x94, 0xF6, 0x00, 0x97, 0xA3, 0x96, 0x81, 0x00, 0x00, 0x98,
+};
+
+// Everything above U+00FF, sorted by code point
+static const CodePointMapping CP437_EXTENDED[] = {
+    { 0x0192, 0x9F }, { 0x0393, 0xE2 }, { 0x0398, 0xE9 }, { 0x03A3, 0xE4 }, { 0x03A6, 0xE8 }, { 0x03A9, 0xEA },
+    { 0x03B1, 0xE0 }, { 0x03B4, 0xEB }, { 0x03B5, 0xEE }, { 0x03C0, 0xE3 }, { 0x03C3, 0xE5 }, { 0x03C4, 0xE7 },
+    { 0x03C6, 0xED }, { 0x207F, 0xFC }, { 0x20A7, 0x9E }, { 0x2219, 0xF9 }, { 0x221A, 0xFB }, { 0x221E, 0xEC },
+    { 0x2229, 0xEF }, { 0x2248, 0xF7 }, { 0x2261, 0xF0 }, { 0x2264, 0xF3 }, { 0x2265, 0xF2 }, { 0x2310, 0xA9 },
+    { 0x2320, 0xF4 }, { 0x2321, 0xF5 }, { 0x2500, 0xC4 }, { 0x2502, 0xB3 }, { 0x250C, 0xDA }, { 0x2510, 0xBF },
+    { 0x2514, 0xC0 }, { 0x2518, 0xD9 }, { 0x251C, 0xC3 }, { 0x2524, 0xB4 }, { 0x252C, 0xC2 }, { 0x2534, 0xC1 },
+    { 0x253C, 0xC5 }, { 0x2550, 0xCD }, { 0x2551, 0xBA }, { 0x2552, 0xD5 }, { 0x2553, 0xD6 }, { 0x2554, 0xC9 },
+    { 0x2555, 0xB8 }, { 0x2556, 0xB7 }, { 0x2557, 0xBB }, { 0x2558, 0xD4 }, { 0x2559, 0xD3 }, { 0x255A, 0xC8 },
+    { 0x255B, 0xBE }, { 0x255C, 0xBD }, { 0x255D, 0xBC }, { 0x255E, 0xC6 }, { 0x255F, 0xC7 }, { 0x2560, 0xCC },
+    { 0x2561, 0xB5 }, { 0x2562, 0xB6 }, { 0x2563, 0xB9 }, { 0x2564, 0xD1 }, { 0x2565, 0xD2 }, { 0x2566, 0xCB },
+    { 0x2567, 0xCF }, { 0x2568, 0xD0 }, { 0x2569, 0xCA }, { 0x256A, 0xD8 }, { 0x256B, 0xD7 }, { 0x256C, 0xCE },
+    { 0x2580, 0xDF }, { 0x2584, 0xDC }, { 0x2588, 0xDB }, { 0x258C, 0xDD }, { 0x2590, 0xDE }, { 0x2591, 0xB0 },
+    { 0x2592, 0xB1 }, { 0x2593, 0xB2 }, { 0x25A0, 0xFE },
+};
+
+// U+0080-U+00FF -> CP858 byte (0 = not in the code page)
+static const unsigned char CP858_LATIN1[128] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xFF, 0xAD, 0xBD, 0x9C, 0xCF, 0xBE, 0xDD, 0xF5, 0xF9, 0xB8, 0xA6, 0xAE, 0xAA, 0xF0, 0xA9, 0xEE,
+    0xF8, 0xF1, 0xFD, 0xFC, 0xEF, 0xE6, 0xF4, 0xFA, 0xF7, 0xFB, 0xA7, 0xAF, 0xAC, 0xAB, 0xF3, 0xA8,
+    0xB7, 0xB5, 0xB6, 0xC7, 0x8E, 0x8F, 0x92, 0x80, 0xD4, 0x90, 0xD2, 0xD3, 0xDE, 0xD6, 0xD7, 0xD8,
+    0xD1, 0xA5, 0xE3, 0xE0, 0xE2, 0xE5, 0x99, 0x9E, 0x9D, 0xEB, 0xE9, 0xEA, 0x9A, 0xED, 0xE8, 0xE1,
+    0x85, 0xA0, 0x83, 0xC6, 0x84, 0x86, 0x91, 0x87, 0x8A, 0x82, 0x88, 0x89, 0x8D, 0xA1, 0x8C, 0x8B,
+    0xD0, 0xA4, 0x95, 0xA2, 0x93, 0xE4, 0x94, 0xF6, 0x9B, 0x97, 0xA3, 0x96, 0x81, 0xEC, 0xE7, 0x98,
+};
+
+// Everything above U+00FF, sorted by code point
+static const CodePointMapping CP858_EXTENDED[] = {
+    { 0x0192, 0x9F }, { 0x2017, 0xF2 }, { 0x20AC, 0xD5 }, { 0x2500, 0xC4 }, { 0x2502, 0xB3 }, { 0x250C, 0xDA },
+    { 0x2510, 0xBF }, { 0x2514, 0xC0 }, { 0x2518, 0xD9 }, { 0x251C, 0xC3 }, { 0x2524, 0xB4 }, { 0x252C, 0xC2 },
+    { 0x2534, 0xC1 }, { 0x253C, 0xC5 }, { 0x2550, 0xCD }, { 0x2551, 0xBA }, { 0x2554, 0xC9 }, { 0x2557, 0xBB },
+    { 0x255A, 0xC8 }, { 0x255D, 0xBC }, { 0x2560, 0xCC }, { 0x2563, 0xB9 }, { 0x2566, 0xCB }, { 0x2569, 0xCA },
+    { 0x256C, 0xCE }, { 0x2580, 0xDF }, { 0x2584, 0xDC }, { 0x2588, 0xDB }, { 0x2591, 0xB0 }, { 0x2592, 0xB1 },
+    { 0x2593, 0xB2 }, { 0x25A0, 0xFE },
+};
+
+// U+0080-U+00FF -> CP1252 byte (0 = not in the code page)
+static const unsigned char CP1252_LATIN1[128] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF,
+    0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
+    0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,
+    0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF,
+    0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF,
+    0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF,
+};
+
+// Everything above U+00FF, sorted by code point
+static const CodePointMapping CP1252_EXTENDED[] = {
+    { 0x0152, 0x8C }, { 0x0153, 0x9C }, { 0x0160, 0x8A }, { 0x0161, 0x9A }, { 0x0178, 0x9F }, { 0x017D, 0x8E },
+    { 0x017E, 0x9E }, { 0x0192, 0x83 }, { 0x02C6, 0x88 }, { 0x02DC, 0x98 }, { 0x2013, 0x96 }, { 0x2014, 0x97 },
+    { 0x2018, 0x91 }, { 0x2019, 0x92 }, { 0x201A, 0x82 }, { 0x201C, 0x93 }, { 0x201D, 0x94 }, { 0x201E, 0x84 },
+    { 0x2020, 0x86 }, { 0x2021, 0x87 }, { 0x2022, 0x95 }, { 0x2026, 0x85 }, { 0x2030, 0x89 }, { 0x2039, 0x8B },
+    { 0x203A, 0x9B }, { 0x20AC, 0x80 }, { 0x2122, 0x99 },
+};
+
+struct EscPosCodePage {
+    const char* name;
+    unsigned char selector;  // n in ESC t n (Epson numbering)
+    const unsigned char* latin1;
+    const CodePointMapping* extended;
+    size_t extendedCount;
+};
+
+static const EscPosCodePage CODE_PAGES[] = {
+    { "cp437", 0, CP437_LATIN1, CP437_EXTENDED, sizeof(CP437_EXTENDED) / sizeof(CP437_EXTENDED[0]) },
+    { "cp858", 19, CP858_LATIN1, CP858_EXTENDED, sizeof(CP858_EXTENDED) / sizeof(CP858_EXTENDED[0]) },
+    { "cp1252", 16, CP1252_LATIN1, CP1252_EXTENDED, sizeof(CP1252_EXTENDED) / sizeof(CP1252_EXTENDED[0]) }
+};
+
+namespace {
+
+const uint64_t ASCII_HIGH_BITS = 0x8080808080808080ULL;
+
+unsigned char mapCodePoint(const EscPosCodePage& page, uint32_t codePoint) {
+    unsigned char byte = 0;
+    if (codePoint >= 0x80 && codePoint <= 0xFF) {
+        byte = page.latin1[codePoint - 0x80];
+    } else if (codePoint <= 0xFFFF) {
+        const CodePointMapping* end = page.extended + page.extendedCount;
+        const CodePointMapping* it = std::lower_bound(
+            page.extended, end, codePoint,
+            [](const CodePointMapping& mapping, uint32_t value) { return mapping.codePoint < value; });
+        if (it != end && it->codePoint == codePoint) byte = it->byte;
+    }
+    return byte != 0 ? byte : UNMAPPED_REPLACEMENT;
+}
+
+// Length of the ASCII run at the start of text
+size_t asciiPrefix(const unsigned char* text, size_t length) {
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, text + i, 8);
+        if (word & ASCII_HIGH_BITS) break;
+    }
+    while (i < length && text[i] < 0x80) i++;
+    return i;
+}
+
+// Copies the ASCII run at the start of text; returns its length
+size_t copyAscii(const unsigned char* text, size_t length, unsigned char* out) {
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, text + i, 8);
+        if (word & ASCII_HIGH_BITS) break;
+        std::memcpy(out + i, &word, 8);
+    }
+    for (; i < length && text[i] < 0x80; i++) out[i] = text[i];
+    return i;
+}
+
+// Decodes the sequence at text[0], a non-ASCII byte. Malformed input decodes
+// to U+FFFD one byte at a time, so sizing and encoding always agree. The
+// second byte's range follows the Unicode well-formed byte table, which
+// rules out overlong forms, surrogates and code points past U+10FFFF.
+size_t decodeUtf8(const unsigned char* text, size_t length, uint32_t& codePoint) {
+    unsigned char lead = text[0];
+    size_t needed;
+    uint32_t value;
+    unsigned char secondMin = 0x80;
+    unsigned char secondMax = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        needed = 1;
+        value = lead & 0x1F;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        needed = 2;
+        value = lead & 0x0F;
+        if (lead == 0xE0) secondMin = 0xA0;
+        if (lead == 0xED) secondMax = 0x9F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        needed = 3;
+        value = lead & 0x07;
+        if (lead == 0xF0) secondMin = 0x90;
+        if (lead == 0xF4) secondMax = 0x8F;
+    } else {
+        codePoint = 0xFFFD;
+        return 1;
+    }
+
+    if (length <= needed || text[1] < secondMin || text[1] > secondMax) {
+        codePoint = 0xFFFD;
+        return 1;
+    }
+    for (size_t i = 1; i <= needed; i++) {
+        if ((text[i] & 0xC0) != 0x80) {
+            codePoint = 0xFFFD;
+            return 1;
+        }
+        value = (value << 6) | (text[i] & 0x3F);
+    }
+    codePoint = value;
+    return needed + 1;
+}
+
+} // namespace
+
+const EscPosCodePage* findCodePage(const std::string& name) {
+    for (const auto& page : CODE_PAGES) {
+        if (name == page.name) return &page;
+    }
+    return nullptr;
+}
+
+// Bytes encodeText() will write for this UTF-8 text
+size_t encodedTextLength(const unsigned char* text, size_t length) {
+    size_t encoded = 0;
+    while (length > 0) {
+        size_t run = asciiPrefix(text, length);
+        encoded += run;
+        text += run;
+        length -= run;
+        if (length == 0) break;
+
+        uint32_t codePoint;
+        size_t used = decodeUtf8(text, length, codePoint);
+        encoded++;
+        text += used;
+        length -= used;
+    }
+    return encoded;
+}
+
+// Transcode UTF-8 text into the code page; returns the end of the output.
+// Characters the code page lacks become '?'.
+unsigned char* encodeText(const EscPosCodePage& page, const unsigned char* text, size_t length, unsigned char* out) {
+    while (length > 0) {
+        size_t run = copyAscii(text, length, out);
+        out += run;
+        text += run;
+        length -= run;
+        if (length == 0) break;
+
+        uint32_t codePoint;
+        size_t used = decodeUtf8(text, length, codePoint);
+        *out++ = mapCodePoint(page, codePoint);
+        text += used;
+        length -= used;
+    }
+    return out;
+}
+
+// ============================================================================
+// Receipt items
+// ============================================================================
+
+namespace {
+
+// A span of the scratch buffer: UTF-8 text to transcode, or (page ==
+// nullptr) command bytes copied as they are
+struct EncodeOp {
+    const EscPosCodePage* page;
+    size_t offset;
+    size_t length;
+    size_t encodedLength;
+};
+
+class ReceiptEncoder {
+public:
+    explicit ReceiptEncoder(const EscPosCodePage* page) : page_(page), size_(0) {}
+
+    void command(std::initializer_list<unsigned char> bytes) {
+        size_t offset = scratch_.size();
+        scratch_.append(bytes.begin(), bytes.end());
+        ops_.push_back(EncodeOp{ nullptr, offset, bytes.size(), bytes.size() });
+        size_ += bytes.size();
+    }
+
+    void selectCodePage(const EscPosCodePage* page) {
+        page_ = page;
+        command({ 0x1B, 0x74, page->selector });  // ESC t n
+    }
+
+    const EscPosCodePage* codePage() const { return page_; }
+
+    void text(napi_env env, napi_value value) {
+        size_t length = 0;
+        napi_get_value_string_utf8(env, value, nullptr, 0, &length);
+        if (length == 0) return;
+
+        size_t offset = scratch_.size();
+        scratch_.resize(offset + length + 1);
+        napi_get_value_string_utf8(env, value, &scratch_[offset], length + 1, &length);
+        scratch_.resize(offset + length);
+        addText(offset, length);
+    }
+
+    // UTF-8 bytes as read from a file or socket, which may be malformed
+    void textBytes(const unsigned char* data, size_t length) {
+        if (length == 0) return;
+        size_t offset = scratch_.size();
+        scratch_.append(reinterpret_cast<const char*>(data), length);
+        addText(offset, length);
+    }
+
+    // Write the whole stream into a Buffer of exactly the encoded size
+    napi_value finish(napi_env env) {
+        void* data = nullptr;
+        napi_value buffer;
+        if (napi_create_buffer(env, size_, &data, &buffer) != napi_ok) return nullptr;
+
+        unsigned char* out = static_cast<unsigned char*>(data);
+        for (const auto& op : ops_) {
+            if (op.page == nullptr) {
+                std::memcpy(out, bytes(op.offset), op.length);
+                out += op.length;
+            } else {
+                out = encodeText(*op.page, bytes(op.offset), op.length, out);
+            }
+        }
+        return buffer;
+    }
+
+private:
+    void addText(size_t offset, size_t length) {
+        size_t encoded = encodedTextLength(bytes(offset), length);
+        ops_.push_back(EncodeOp{ page_, offset, length, encoded });
+        size_ += encoded;
+    }
+
+    const unsigned char* bytes(size_t offset) const {
+        return reinterpret_cast<const unsigned char*>(scratch_.data()) + offset;
+    }
+
+    const EscPosCodePage* page_;
+    std::string scratch_;
+    std::vector<EncodeOp> ops_;
+    size_t size_;
+};
+
+bool hasProperty(napi_env env, napi_value object, const char* key, napi_value& value) {
+    bool present = false;
+    napi_has_named_property(env, object, key, &present);
+    if (!present) return false;
+    napi_get_named_property(env, object, key, &value);
+
+    napi_valuetype type;
+    napi_typeof(env, value, &type);
+    return type != napi_undefined;
+}
+
+// One directive object; settings apply before its text, then feed and cut
+bool encodeDirective(napi_env env, napi_value item, ReceiptEncoder& encoder, std::string& error) {
+    napi_value value;
+    std::string text;
+    bool present;
+
+    if (!GetOptionalStringProperty(env, item, "codePage", text, present)) {
+        error = "codePage must be a string";
+        return false;
+    }
+    if (present) {
+        const EscPosCodePage* page = findCodePage(text);
+        if (page == nullptr) {
+            error = "codePage must be 'cp437', 'cp858' or 'cp1252'";
+            return false;
+        }
+        if (page != encoder.codePage()) encoder.selectCodePage(page);
+    }
+
+    if (!GetOptionalStringProperty(env, item, "align", text, present)) {
+        error = "align must be a string";
+        return false;
+    }
+    if (present) {
+        unsigned char n;
+        if (text == "left") {
+            n = 0;
+        } else if (text == "center") {
+            n = 1;
+        } else if (text == "right") {
+            n = 2;
+        } else {
+            error = "align must be 'left', 'center' or 'right'";
+            return false;
+        }
+        encoder.command({ 0x1B, 0x61, n });  // ESC a n
+    }
+
+    if (hasProperty(env, item, "bold", value)) {
+        bool bold;
+        if (napi_get_value_bool(env, value, &bold) != napi_ok) {
+            error = "bold must be a boolean";
+            return false;
+        }
+        encoder.command({ 0x1B, 0x45, static_cast<unsigned char>(bold ? 1 : 0) });  // ESC E n
+    }
+
+    if (hasProperty(env, item, "text", value)) {
+        napi_valuetype type;
+        napi_typeof(env, value, &type);
+        const unsigned char* data = nullptr;
+        size_t length = 0;
+        if (type == napi_string) {
+            encoder.text(env, value);
+        } else if (GetRawData(env, value, data, length)) {
+            encoder.textBytes(data, length);
+        } else {
+            error = "text must be a string or a Buffer of UTF-8";
+            return false;
+        }
+    }
+
+    int32_t lines;
+    if (!GetOptionalInt32Property(env, item, "feed", lines, present) ||
+        (present && (lines < 0 || lines > MAX_FEED_LINES))) {
+        error = "feed must be 0-255";
+        return false;
+    }
+    if (present) encoder.command({ 0x1B, 0x64, static_cast<unsigned char>(lines) });  // ESC d n
+
+    if (hasProperty(env, item, "cut", value)) {
+        napi_valuetype type;
+        napi_typeof(env, value, &type);
+        bool cut = false;
+        bool partial = false;
+        if (type == napi_boolean) {
+            napi_get_value_bool(env, value, &cut);
+        } else if (type == napi_string && GetOptionalStringProperty(env, item, "cut", text, present) &&
+                   (text == "full" || text == "partial")) {
+            cut = true;
+            partial = text == "partial";
+        } else {
+            error = "cut must be true, 'full' or 'partial'";
+            return false;
+        }
+        if (cut) encoder.command({ 0x1D, 0x56, static_cast<unsigned char>(partial ? 1 : 0) });  // GS V m
+    }
+
+    return true;
+}
+
+} // namespace
+
+// ============================================================================
+// Exported N-API functions
+// ============================================================================
+
+// encodeReceipt(items, { codePage, initialize }) -> Buffer
+napi_value EncodeReceipt(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    bool is_array = false;
+    if (argc >= 1) napi_is_array(env, args[0], &is_array);
+    if (!is_array) {
+        napi_throw_type_error(env, nullptr, "First argument must be an array of strings and directives");
+        return nullptr;
+    }
+
+    const EscPosCodePage* page = &CODE_PAGES[0];
+    bool initialize = true;
+    napi_valuetype options_type = napi_undefined;
+    if (argc >= 2) napi_typeof(env, args[1], &options_type);
+    if (options_type == napi_object) {
+        std::string name;
+        bool present;
+        if (!GetOptionalStringProperty(env, args[1], "codePage", name, present) ||
+            (present && (page = findCodePage(name)) == nullptr)) {
+            napi_throw_error(env, nullptr, "Invalid options: codePage must be 'cp437', 'cp858' or 'cp1252'");
+            return nullptr;
+        }
+
+        napi_value value;
+        if (hasProperty(env, args[1], "initialize", value) &&
+            napi_get_value_bool(env, value, &initialize) != napi_ok) {
+            napi_throw_error(env, nullptr, "Invalid options: initialize must be a boolean");
+            return nullptr;
+        }
+    }
+
+    ReceiptEncoder encoder(page);
+    if (initialize) encoder.command({ 0x1B, 0x40 });  // ESC @
+    encoder.selectCodePage(page);
+
+    uint32_t length;
+    NAPI_CALL(env, napi_get_array_length(env, args[0], &length));
+
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value item;
+        napi_get_element(env, args[0], i, &item);
+
+        napi_valuetype type;
+        napi_typeof(env, item, &type);
+        std::string error;
+        if (type == napi_string) {
+            encoder.text(env, item);
+            continue;
+        }
+        if (type != napi_object) {
+            error = "must be a string or a directive object";
+        } else if (encodeDirective(env, item, encoder, error)) {
+            continue;
+        }
+
+        std::string message = "Invalid receipt item " + std::to_string(i) + ": " + error;
+        napi_throw_error(env, nullptr, message.c_str());
+        return nullptr;
+    }
+
+    napi_value buffer = encoder.finish(env);
+    if (buffer == nullptr) {
+        napi_throw_error(env, nullptr, "Failed to allocate the receipt buffer");
+        return nullptr;
+    }
+    return buffer;
+}
@@ -0,0 +1,346 @@
+#include "common.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// ============================================================================
+// Drawer kick failover and hedging
+// ============================================================================
+//
+// openCashDrawer([primary, backup, ...]) kicks the first printer and moves on
+// to the next one when an attempt fails, so a lane with two printers wired to
+// one drawer keeps opening while either works. With hedgeAfterMs, the next
+// printer is also tried once the running attempts have taken that long
+// without an answer; the first success settles the call. Every attempt is an
+// ordinary job on its printer's queue, so failover never races other jobs
+// for a device. Each attempt's completion starts the next one, and one timer
+// thread shared by every call starts the hedged ones. Attempts still running
+// when the call settles are left to finish, since a job can't be taken back
+// from the spooler. A hedged call may therefore kick twice, which opens a
+// shared drawer once.
+
+static const uint32_t MAX_FAILOVER_PRINTERS = 16;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct FailoverAttempt {
+    std::string printerName;
+    bool hedged;    // Started while an earlier attempt was still running
+    bool finished;
+    OperationResult result;
+    Clock::time_point startedAt;
+    double elapsedMs;
+
+    FailoverAttempt() : hedged(false), finished(false), elapsedMs(0) {}
+};
+
+struct FailoverKick {
+    std::mutex mutex;
+    std::vector<std::string> printers;
+    std::vector<OperationResult> resolutions;  // Name resolution failures are failed attempts
+    DrawerConfig config;
+    int hedgeAfterMs;  // -1: only move on once an attempt has failed
+    std::vector<FailoverAttempt> attempts;
+    size_t inFlight;
+    int winner;        // Index into attempts, -1 until one succeeds
+    int lastFinished;  // Index into attempts of the latest to finish
+    size_t replacementsDue;  // Failed attempts whose next printer isn't started yet
+    bool settled;
+    Clock::time_point hedgeArmedFor;  // Start time of the attempt the hedge timer waits on
+    JobWaiter waiter;
+
+    FailoverKick() : hedgeAfterMs(-1), inFlight(0), winner(-1), lastFinished(-1), replacementsDue(1), settled(false) {}
+};
+
+// What the call settled with, fixed before the result goes back to JS
+struct FailoverOutcome {
+    std::vector<FailoverAttempt> attempts;
+    int winner;
+    bool awaited;
+};
+
+struct HedgeTimer {
+    Clock::time_point at;
+    std::weak_ptr<FailoverKick> kick;  // Settled calls aren't kept alive
+};
+
+// Intentionally leaked: the detached timer thread may still touch these during exit
+std::mutex& g_hedgeMutex = *new std::mutex();
+std::condition_variable& g_hedgeWake = *new std::condition_variable();
+std::vector<HedgeTimer>& g_hedgeTimers = *new std::vector<HedgeTimer>();
+bool g_hedgeTimerRunning = false;
+
+void advanceFailover(const std::shared_ptr<FailoverKick>& kick, std::unique_lock<std::mutex>& lock);
+
+void finishAttempt(const std::shared_ptr<FailoverKick>& kick, size_t index, const OperationResult& result) {
+    std::unique_lock<std::mutex> lock(kick->mutex);
+    FailoverAttempt& attempt = kick->attempts[index];
+    attempt.finished = true;
+    attempt.result = result;
+    attempt.elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - attempt.startedAt).count();
+    if (result.success && kick->winner < 0) kick->winner = static_cast<int>(index);
+    kick->lastFinished = static_cast<int>(index);
+    if (!result.success) kick->replacementsDue++;
+    kick->inFlight--;
+    advanceFailover(kick, lock);
+}
+
+// Starts the next printer's attempt. The lock is released while scheduling,
+// because a job settled right away calls back into finishAttempt.
+void startAttempt(const std::shared_ptr<FailoverKick>& kick, std::unique_lock<std::mutex>& lock, bool hedged) {
+    size_t index = kick->attempts.size();
+    kick->attempts.push_back(FailoverAttempt());
+    FailoverAttempt& attempt = kick->attempts.back();
+    attempt.printerName = kick->printers[index];
+    attempt.hedged = hedged;
+    attempt.startedAt = Clock::now();
+    kick->inFlight++;
+
+    if (!kick->resolutions[index].success) {
+        lock.unlock();
+        finishAttempt(kick, index, kick->resolutions[index]);
+        lock.lock();
+        return;
+    }
+
+    JobWaiter native;
+    native.traceOperation = kick->waiter.traceOperation;
+    native.done = [kick, index](const OperationResult& result) { finishAttempt(kick, index, result); };
+    std::string printerName = attempt.printerName;
+    DrawerConfig config = kick->config;
+
+    lock.unlock();
+    ScheduleNativeJob(
+        native,
+        printerName,
+        LANE_KICK,
+        CoalesceKey(config),
+        [printerName, config]() { return open_cash_drawer(printerName, config); },
+        AwaitCompletionHandoff(printerName, config)
+    );
+    lock.lock();
+}
+
+napi_value AttemptToObject(napi_env env, const FailoverAttempt& attempt) {
+    napi_value object, value;
+    napi_create_object(env, &object);
+    napi_create_string_utf8(env, attempt.printerName.c_str(), attempt.printerName.size(), &value);
+    napi_set_named_property(env, object, "printerName", value);
+    napi_get_boolean(env, attempt.hedged, &value);
+    napi_set_named_property(env, object, "hedged", value);
+    napi_get_boolean(env, !attempt.finished, &value);
+    napi_set_named_property(env, object, "pending", value);
+    if (attempt.finished) {
+        napi_get_boolean(env, attempt.result.success, &value);
+        napi_set_named_property(env, object, "success", value);
+        napi_create_int32(env, attempt.result.errorCode, &value);
+        napi_set_named_property(env, object, "errorCode", value);
+        napi_create_string_utf8(env, attempt.result.errorMessage.c_str(), NAPI_AUTO_LENGTH, &value);
+        napi_set_named_property(env, object, "errorMessage", value);
+        napi_create_double(env, attempt.elapsedMs, &value);
+        napi_set_named_property(env, object, "elapsedMs", value);
+    }
+    return object;
+}
+
+// { success, errorCode, errorMessage, completionMs?, printerName, hedged, attempts }
+napi_value FailoverResultObject(napi_env env, const FailoverOutcome& outcome, const OperationResult& result) {
+    napi_value object = outcome.awaited ? CompletionResultObject(env, result) : CreateResultObject(env, result);
+    napi_value value;
+
+    if (outcome.winner >= 0) {
+        const FailoverAttempt& winner = outcome.attempts[outcome.winner];
+        napi_create_string_utf8(env, winner.printerName.c_str(), winner.printerName.size(), &value);
+    } else {
+        napi_get_null(env, &value);
+    }
+    napi_set_named_property(env, object, "printerName", value);
+    napi_get_boolean(env, outcome.winner >= 0 && outcome.attempts[outcome.winner].hedged, &value);
+    napi_set_named_property(env, object, "hedged", value);
+
+    napi_value attempts;
+    napi_create_array_with_length(env, outcome.attempts.size(), &attempts);
+    for (size_t i = 0; i < outcome.attempts.size(); i++) {
+        napi_set_element(env, attempts, static_cast<uint32_t>(i), AttemptToObject(env, outcome.attempts[i]));
+    }
+    napi_set_named_property(env, object, "attempts", attempts);
+    return object;
+}
+
+// Fixes the outcome and settles the promise; the lock is released meanwhile
+void settleFailover(const std::shared_ptr<FailoverKick>& kick, std::unique_lock<std::mutex>& lock) {
+    kick->settled = true;
+    std::shared_ptr<FailoverOutcome> outcome = std::make_shared<FailoverOutcome>();
+    outcome->attempts = kick->attempts;
+    outcome->winner = kick->winner;
+    outcome->awaited = kick->config.awaitCompletion && kick->config.transport == TRANSPORT_SPOOLER;
+    int lastFinished = kick->lastFinished;
+    JobWaiter waiter = kick->waiter;
+    lock.unlock();
+
+    OperationResult result;
+    if (outcome->winner >= 0) {
+        result = outcome->attempts[outcome->winner].result;
+    } else {
+        // Hedged attempts can finish out of order; the code is from the last to fail
+        std::string failures;
+        for (const auto& attempt : outcome->attempts) {
+            failures += (failures.empty() ? "'" : "; '") + attempt.printerName + "': " + attempt.result.errorMessage;
+        }
+        result.setError(outcome->attempts[lastFinished].result.errorCode,
+                        "Cash drawer could not be opened on any printer: " + failures);
+    }
+
+    waiter.format = [outcome](napi_env env, const OperationResult& settled) {
+        return FailoverResultObject(env, *outcome, settled);
+    };
+    DeliverResult(waiter, result);
+    lock.lock();
+}
+
+void hedgeTimerLoop() {
+    std::unique_lock<std::mutex> lock(g_hedgeMutex);
+
+    while (!g_hedgeTimers.empty()) {
+        Clock::time_point now = Clock::now();
+        Clock::time_point wakeAt = Clock::time_point::max();
+        std::vector<std::shared_ptr<FailoverKick>> due;
+        for (auto it = g_hedgeTimers.begin(); it != g_hedgeTimers.end();) {
+            if (it->at <= now) {
+                std::shared_ptr<FailoverKick> kick = it->kick.lock();
+                if (kick) due.push_back(kick);
+                it = g_hedgeTimers.erase(it);
+            } else {
+                wakeAt = std::min(wakeAt, it->at);
+                ++it;
+            }
+        }
+
+        if (!due.empty()) {
+            lock.unlock();
+            for (const auto& kick : due) {
+                TraceScope scope(kick->waiter.traceOperation, nullptr);
+                std::unique_lock<std::mutex> kickLock(kick->mutex);
+                advanceFailover(kick, kickLock);
+            }
+            lock.lock();
+            continue;
+        }
+        g_hedgeWake.wait_until(lock, wakeAt);
+    }
+
+    g_hedgeTimerRunning = false;
+}
+
+void armHedgeTimer(const std::shared_ptr<FailoverKick>& kick, Clock::time_point at) {
+    {
+        std::lock_guard<std::mutex> lock(g_hedgeMutex);
+        g_hedgeTimers.push_back(HedgeTimer{ at, kick });
+        if (!g_hedgeTimerRunning) {
+            g_hedgeTimerRunning = true;
+            std::thread(hedgeTimerLoop).detach();
+        }
+    }
+    g_hedgeWake.notify_all();
+}
+
+// Starts the next printer at once for the call itself and for every failed
+// attempt, and otherwise once the hedge is due; settles once one attempt
+// succeeded or every printer failed. Called when the call starts, when an
+// attempt finishes and when a hedge timer fires.
+void advanceFailover(const std::shared_ptr<FailoverKick>& kick, std::unique_lock<std::mutex>& lock) {
+    while (!kick->settled) {
+        bool morePrinters = kick->attempts.size() < kick->printers.size();
+        if (kick->winner >= 0 || (kick->inFlight == 0 && !morePrinters)) {
+            settleFailover(kick, lock);
+            return;
+        }
+        if (morePrinters && kick->replacementsDue > 0) {
+            kick->replacementsDue--;
+            startAttempt(kick, lock, kick->inFlight > 0);
+            continue;
+        }
+        if (!morePrinters || kick->hedgeAfterMs < 0) return;
+
+        Clock::time_point startedAt = kick->attempts.back().startedAt;
+        Clock::time_point hedgeAt = startedAt + std::chrono::milliseconds(kick->hedgeAfterMs);
+        if (Clock::now() >= hedgeAt) {
+            startAttempt(kick, lock, true);
+            continue;
+        }
+        if (kick->hedgeArmedFor != startedAt) {
+            kick->hedgeArmedFor = startedAt;
+            armHedgeTimer(kick, hedgeAt);
+        }
+        return;
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// Exported N-API function
+// ============================================================================
+
+// openCashDrawer([printer, ...], options) with options.hedgeAfterMs; the
+// drawer options apply to every printer
+napi_value OpenCashDrawerFailover(napi_env env, napi_value printers, napi_value options) {
+    std::shared_ptr<FailoverKick> kick = std::make_shared<FailoverKick>();
+
+    uint32_t length = 0;
+    napi_get_array_length(env, printers, &length);
+    if (length == 0 || length > MAX_FAILOVER_PRINTERS) {
+        napi_throw_range_error(env, nullptr, "Expected between 1 and 16 printer names");
+        return nullptr;
+    }
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value element;
+        napi_get_element(env, printers, i, &element);
+        std::string printer_name;
+        if (!GetPrinterNameFromArg(env, element, printer_name) || printer_name.empty()) {
+            napi_throw_error(env, nullptr, "Printer names must be non-empty strings with max 256 characters");
+            return nullptr;
+        }
+        // Configured spellings and aliases map onto one queue before scheduling
+        OperationResult resolution;
+        resolvePrinterName(printer_name, printer_name, resolution);
+        kick->printers.push_back(printer_name);
+        kick->resolutions.push_back(resolution);
+    }
+
+    if (options != nullptr) {
+        std::string error;
+        if (!ParseDrawerConfig(env, options, kick->config, error)) {
+            napi_throw_error(env, nullptr, error.c_str());
+            return nullptr;
+        }
+        int32_t hedgeAfterMs = -1;
+        bool present;
+        if (!GetOptionalInt32Property(env, options, "hedgeAfterMs", hedgeAfterMs, present) ||
+            (present && hedgeAfterMs < 0)) {
+            napi_throw_range_error(env, nullptr, "hedgeAfterMs must be a non-negative number");
+            return nullptr;
+        }
+        kick->hedgeAfterMs = present ? hedgeAfterMs : -1;
+    }
+
+    kick->attempts.reserve(kick->printers.size());
+    kick->waiter.traceOperation = beginTraceOperation();
+    kick->waiter.traceName = "openCashDrawer";
+    kick->waiter.createdAt = Clock::now();
+    napi_value promise = CreatePendingResult(env, CreateResultObject, kick->waiter);
+    if (promise == nullptr) {
+        napi_throw_error(env, nullptr, "Failed to schedule cash drawer job");
+        return nullptr;
+    }
+
+    TraceScope scope(kick->waiter.traceOperation, nullptr);
+    std::unique_lock<std::mutex> lock(kick->mutex);
+    advanceFailover(kick, lock);
+    return promise;
+}
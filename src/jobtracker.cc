@@ -0,0 +1,426 @@
+#include "common.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+// ============================================================================
+// Spooler job tracker
+// ============================================================================
+//
+// With awaitCompletion, a spooler job's promise settles only once the
+// spooler reports the job completed, canceled or aborted, so a stuck queue no
+// longer looks like a successful kick. One native thread polls on behalf of
+// every outstanding job. On CUPS, each round asks for the active jobs of the
+// queues that have tracked jobs, one Get-Jobs request per queue. A job that
+// has left its queue's active list is looked up on its own with
+// Get-Job-Attributes, so the server's job history is never listed. Each job
+// is polled soon after it is queued and less often the longer it waits.
+
+static const int FIRST_POLL_MS = 25;
+static const int MAX_POLL_INTERVAL_MS = 1000;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+enum JobState {
+    JOB_ACTIVE,
+    JOB_COMPLETED,
+    JOB_CANCELED,
+    JOB_ABORTED,
+    JOB_UNKNOWN   // The spooler could not be asked
+};
+
+struct JobQuery {
+    std::string printerName;
+    int jobId;
+    JobState state;
+    std::string detail;  // Spooler's state name, or why it is unknown
+};
+
+struct TrackedJob {
+    std::string printerName;
+    int jobId;
+    int timeoutMs;
+    Clock::time_point queuedAt;
+    Clock::time_point deadline;
+    Clock::time_point nextPollAt;
+    int pollIntervalMs;
+    int queryIndex;         // Entry in the current round's queries, or -1
+    std::string lastState;  // Reported if the job times out
+    JobCompletionCallback done;
+};
+
+// Intentionally leaked: the detached tracker may still touch these during exit
+std::mutex& g_trackerMutex = *new std::mutex();
+std::condition_variable& g_trackerWake = *new std::condition_variable();
+std::vector<TrackedJob>& g_trackedJobs = *new std::vector<TrackedJob>();
+bool g_trackerRunning = false;
+
+#ifdef _WIN32
+// The spooler deletes a job once it has printed, so a job that is gone
+// finished normally
+void queryJobState(HANDLE printer, JobQuery& query) {
+    DWORD needed = 0;
+    GetJobA(printer, static_cast<DWORD>(query.jobId), 1, NULL, 0, &needed);
+    if (needed == 0) {
+        DWORD winError = GetLastError();
+        if (winError == ERROR_INVALID_PARAMETER) {
+            query.state = JOB_COMPLETED;
+            query.detail = "completed";
+        } else {
+            query.state = JOB_UNKNOWN;
+            query.detail = "state unavailable, Windows Error: " + std::to_string(winError);
+        }
+        return;
+    }
+
+    std::vector<BYTE> buffer(needed);
+    if (!GetJobA(printer, static_cast<DWORD>(query.jobId), 1, buffer.data(), needed, &needed)) {
+        query.state = JOB_COMPLETED;
+        query.detail = "completed";
+        return;
+    }
+
+    DWORD status = reinterpret_cast<JOB_INFO_1A*>(buffer.data())->Status;
+    if (status & (JOB_STATUS_PRINTED | JOB_STATUS_COMPLETE)) {
+        query.state = JOB_COMPLETED;
+        query.detail = "completed";
+    } else if (status & (JOB_STATUS_DELETING | JOB_STATUS_DELETED)) {
+        query.state = JOB_CANCELED;
+        query.detail = "canceled";
+    } else {
+        query.state = JOB_ACTIVE;
+        if (status & JOB_STATUS_PAUSED) query.detail = "paused";
+        else if (status & JOB_STATUS_OFFLINE) query.detail = "printer offline";
+        else if (status & JOB_STATUS_PAPEROUT) query.detail = "out of paper";
+        else if (status & JOB_STATUS_ERROR) query.detail = "error";
+        else if (status & JOB_STATUS_PRINTING) query.detail = "printing";
+        else query.detail = "queued";
+    }
+}
+
+void queryJobStates(std::vector<JobQuery>& queries) {
+    // GetJob needs a handle to the job's printer; open each printer once
+    std::unordered_map<std::string, HANDLE> printers;
+    for (auto& query : queries) {
+        auto it = printers.find(query.printerName);
+        if (it == printers.end()) {
+            HANDLE printer = NULL;
+            if (!OpenPrinterA(const_cast<char*>(query.printerName.c_str()), &printer, NULL)) {
+                printer = NULL;
+            }
+            it = printers.insert(std::make_pair(query.printerName, printer)).first;
+        }
+        if (it->second == NULL) {
+            query.state = JOB_UNKNOWN;
+            query.detail = "state unavailable, the printer could not be opened";
+            continue;
+        }
+        queryJobState(it->second, query);
+    }
+    for (const auto& entry : printers) {
+        if (entry.second != NULL) ClosePrinter(entry.second);
+    }
+}
+#else
+const char* jobStateName(ipp_jstate_t state) {
+    switch (state) {
+    case IPP_JSTATE_PENDING: return "pending";
+    case IPP_JSTATE_HELD: return "held";
+    case IPP_JSTATE_PROCESSING: return "processing";
+    case IPP_JSTATE_STOPPED: return "stopped";
+    case IPP_JSTATE_CANCELED: return "canceled";
+    case IPP_JSTATE_ABORTED: return "aborted";
+    default: return "completed";
+    }
+}
+
+// Job id -> state for the active jobs of one queue
+bool fetchActiveJobs(http_t* http, const std::string& queue, std::unordered_map<int, ipp_jstate_t>& states) {
+    TraceSpan span("cupsGetJobs2");
+    cups_job_t* jobs = nullptr;
+    int count = cupsGetJobs2(http, &jobs, queue.c_str(), 0, CUPS_WHICHJOBS_ACTIVE);
+    if (count < 0) return false;
+    for (int i = 0; i < count; i++) {
+        states[jobs[i].id] = jobs[i].state;
+    }
+    cupsFreeJobs(count, jobs);
+    return true;
+}
+
+// State of one job that is no longer active. Returns false if cupsd could
+// not be asked; found is false once the job was purged from the history.
+bool fetchJobState(http_t* http, int jobId, ipp_jstate_t& state, bool& found) {
+    TraceSpan span("cupsDoRequest");
+    std::string jobUri = "ipp://localhost/jobs/" + std::to_string(jobId);
+    static const char* const requested[] = { "job-state" };
+
+    ipp_t* request = ippNewRequest(IPP_OP_GET_JOB_ATTRIBUTES);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "job-uri", nullptr, jobUri.c_str());
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", nullptr, cupsUser());
+    ippAddStrings(request, IPP_TAG_OPERATION, IPP_TAG_KEYWORD, "requested-attributes", 1, nullptr, requested);
+
+    ipp_t* response = cupsDoRequest(http, request, "/");
+    found = false;
+    if (cupsLastError() == IPP_STATUS_ERROR_NOT_FOUND) {
+        ippDelete(response);
+        return true;
+    }
+    if (response == nullptr || cupsLastError() > IPP_STATUS_OK_EVENTS_COMPLETE) {
+        ippDelete(response);
+        return false;
+    }
+
+    ipp_attribute_t* attribute = ippFindAttribute(response, "job-state", IPP_TAG_ENUM);
+    if (attribute != nullptr) {
+        state = static_cast<ipp_jstate_t>(ippGetInteger(attribute, 0));
+        found = true;
+    }
+    ippDelete(response);
+    return true;
+}
+
+void queryFailed(std::vector<JobQuery>& queries, const std::string& error) {
+    for (auto& query : queries) {
+        query.state = JOB_UNKNOWN;
+        query.detail = "state unavailable: " + error;
+    }
+}
+
+void queryJobStates(std::vector<JobQuery>& queries) {
+    CupsConnection cups;
+    std::string error;
+    if (!cups.acquire(error)) {
+        queryFailed(queries, error);
+        return;
+    }
+
+    // One active-jobs request per queue with tracked jobs. A name cupsd
+    // doesn't know as a queue (e.g. an instance) leaves the list empty, and
+    // its jobs are looked up one by one.
+    std::unordered_map<std::string, std::unordered_map<int, ipp_jstate_t>> active;
+    for (const auto& query : queries) {
+        if (active.count(query.printerName)) continue;
+        if (!fetchActiveJobs(cups.get(), query.printerName, active[query.printerName]) &&
+            cupsLastError() != IPP_STATUS_ERROR_NOT_FOUND) {
+            queryFailed(queries, cupsLastErrorString());
+            cups.discardIfBroken();
+            return;
+        }
+    }
+
+    for (auto& query : queries) {
+        const std::unordered_map<int, ipp_jstate_t>& queueJobs = active[query.printerName];
+        ipp_jstate_t state = IPP_JSTATE_PENDING;
+        auto it = queueJobs.find(query.jobId);
+        if (it != queueJobs.end()) {
+            state = it->second;
+        } else {
+            bool found = false;
+            if (!fetchJobState(cups.get(), query.jobId, state, found)) {
+                query.state = JOB_UNKNOWN;
+                query.detail = std::string("state unavailable: ") + cupsLastErrorString();
+                cups.discardIfBroken();
+                if (!cups.isOpen() && !cups.acquire(error)) {
+                    queryFailed(queries, error);
+                    return;
+                }
+                continue;
+            }
+            // No longer active and already purged from the job history
+            // (PreserveJobHistory No): cupsd only purges finished jobs
+            if (!found) {
+                query.state = JOB_COMPLETED;
+                query.detail = "completed";
+                continue;
+            }
+        }
+
+        switch (state) {
+        case IPP_JSTATE_COMPLETED: query.state = JOB_COMPLETED; break;
+        case IPP_JSTATE_CANCELED: query.state = JOB_CANCELED; break;
+        case IPP_JSTATE_ABORTED: query.state = JOB_ABORTED; break;
+        default: query.state = JOB_ACTIVE; break;
+        }
+        query.detail = jobStateName(state);
+    }
+}
+#endif
+
+std::string describeJob(const TrackedJob& job) {
+    return "Job " + std::to_string(job.jobId) + " on '" + job.printerName + "'";
+}
+
+// Called with g_trackerMutex held. Returns true and fills in result once the
+// job is finished or out of time.
+bool settleJob(TrackedJob& job, const std::vector<JobQuery>& queries, Clock::time_point now,
+               OperationResult& result) {
+    if (job.queryIndex >= 0) {
+        const JobQuery& query = queries[job.queryIndex];
+        job.queryIndex = -1;
+        job.lastState = query.detail;
+
+        if (query.state == JOB_COMPLETED) {
+            result.value = std::chrono::duration_cast<std::chrono::microseconds>(now - job.queuedAt).count();
+            return true;
+        }
+        if (query.state == JOB_CANCELED || query.state == JOB_ABORTED) {
+            result.setError(PRINTER_JOB_FAILED, describeJob(job) + " was " + query.detail + " by the spooler");
+            return true;
+        }
+
+        job.pollIntervalMs = std::min(job.pollIntervalMs * 2, MAX_POLL_INTERVAL_MS);
+        job.nextPollAt = now + std::chrono::milliseconds(job.pollIntervalMs);
+    }
+
+    if (now >= job.deadline) {
+        result.setError(
+            PRINTER_TIMEOUT,
+            describeJob(job) + " did not finish within " + std::to_string(job.timeoutMs) + " ms (" +
+            (job.lastState.empty() ? std::string("not checked yet") : job.lastState) + ")"
+        );
+        return true;
+    }
+    return false;
+}
+
+void trackerLoop() {
+    std::unique_lock<std::mutex> lock(g_trackerMutex);
+
+    while (!g_trackedJobs.empty()) {
+        // Jobs are only removed by this thread, so they stay in place while
+        // the spooler is asked; new ones are appended and wait for next round
+        Clock::time_point now = Clock::now();
+        std::vector<JobQuery> queries;
+        for (auto& job : g_trackedJobs) {
+            if (job.nextPollAt <= now) {
+                job.queryIndex = static_cast<int>(queries.size());
+                queries.push_back(JobQuery{ job.printerName, job.jobId, JOB_UNKNOWN, std::string() });
+            }
+        }
+
+        if (!queries.empty()) {
+            lock.unlock();
+            queryJobStates(queries);
+            lock.lock();
+        }
+
+        now = Clock::now();
+        std::vector<std::pair<JobCompletionCallback, OperationResult>> settled;
+        for (auto it = g_trackedJobs.begin(); it != g_trackedJobs.end();) {
+            OperationResult result;
+            if (settleJob(*it, queries, now, result)) {
+                settled.push_back(std::make_pair(std::move(it->done), result));
+                it = g_trackedJobs.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        if (!settled.empty()) {
+            lock.unlock();
+            for (const auto& entry : settled) {
+                entry.first(entry.second);
+            }
+            lock.lock();
+            continue;
+        }
+
+        Clock::time_point wakeAt = Clock::time_point::max();
+        for (const auto& job : g_trackedJobs) {
+            wakeAt = std::min(wakeAt, std::min(job.nextPollAt, job.deadline));
+        }
+        if (wakeAt != Clock::time_point::max()) {
+            g_trackerWake.wait_until(lock, wakeAt);
+        }
+    }
+
+    g_trackerRunning = false;
+}
+
+} // namespace
+
+// ============================================================================
+// Tracker API
+// ============================================================================
+
+// Calls done once the spooler job finishes, fails or runs out of time. On
+// success the result's value is the latency from queuedAt (when the job was
+// scheduled, before its queue wait and submission) to completion, in
+// microseconds and accurate to the polling interval. The timeout runs from
+// the submission.
+void trackPrintJob(const std::string& printerName, int jobId, Clock::time_point queuedAt, int timeoutMs,
+                   JobCompletionCallback done) {
+    Clock::time_point now = Clock::now();
+    TrackedJob job;
+    job.printerName = printerName;
+    job.jobId = jobId;
+    job.timeoutMs = timeoutMs;
+    job.queuedAt = queuedAt;
+    job.deadline = now + std::chrono::milliseconds(timeoutMs);
+    job.pollIntervalMs = FIRST_POLL_MS;
+    job.nextPollAt = now + std::chrono::milliseconds(FIRST_POLL_MS);
+    job.queryIndex = -1;
+    job.done = std::move(done);
+
+    {
+        std::lock_guard<std::mutex> lock(g_trackerMutex);
+        g_trackedJobs.push_back(std::move(job));
+        if (!g_trackerRunning) {
+            g_trackerRunning = true;
+            std::thread(trackerLoop).detach();
+        }
+    }
+    g_trackerWake.notify_all();
+}
+
+// Scheduler handoff for config.awaitCompletion: a queued spooler job's
+// waiters are settled by the tracker instead of as soon as the job is queued.
+// Direct transports have no queue; their result already means the printer
+// took the bytes.
+JobHandoff AwaitCompletionHandoff(const std::string& printerName, const DrawerConfig& config) {
+    if (!config.awaitCompletion || config.transport != TRANSPORT_SPOOLER) {
+        return nullptr;
+    }
+
+    int timeoutMs = config.completionTimeoutMs;
+    return [printerName, timeoutMs](const OperationResult& result, const std::vector<JobWaiter>& waiters) {
+        if (!result.success || result.value <= 0) return false;
+
+        // Measured from the earliest waiter; later (coalesced) ones are
+        // credited with the time they joined
+        std::vector<JobWaiter> tracked(waiters);
+        Clock::time_point queuedAt = Clock::now();
+        for (auto& waiter : tracked) {
+            waiter.format = CompletionResultObject;
+            queuedAt = std::min(queuedAt, waiter.createdAt);
+        }
+        trackPrintJob(printerName, static_cast<int>(result.value), queuedAt, timeoutMs,
+            [tracked, queuedAt](const OperationResult& outcome) {
+                for (const auto& waiter : tracked) {
+                    OperationResult own = outcome;
+                    if (own.success) {
+                        own.value -= std::chrono::duration_cast<std::chrono::microseconds>(
+                            waiter.createdAt - queuedAt).count();
+                    }
+                    DeliverResult(waiter, own);
+                }
+            });
+        return true;
+    };
+}
+
+// { success, errorCode, errorMessage, completionMs } for an awaited job
+napi_value CompletionResultObject(napi_env env, const OperationResult& result) {
+    napi_value object = CreateResultObject(env, result);
+    if (result.success) {
+        napi_value latency;
+        napi_create_double(env, static_cast<double>(result.value) / 1000.0, &latency);
+        napi_set_named_property(env, object, "completionMs", latency);
+    }
+    return object;
+}
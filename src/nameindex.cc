@@ -0,0 +1,249 @@
+#include "common.h"
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+// ============================================================================
+// Printer name index
+// ============================================================================
+//
+// Config files drift from the spooler's queue names: "EPSON_TM_T20III",
+// "epson tm-t20iii" and "Lane 3 Drawer" may all mean the same queue. Every
+// successful printer enumeration, including the ones that fill the
+// destination cache on the kick path, rebuilds an index of the queue names
+// under a normalised key (ASCII case folded, each run of spaces, '_', '-'
+// and '.' collapsed to one separator), and aliases registered from JS map
+// further names onto queues. Names are resolved on the JS thread before a
+// job is scheduled, so every spelling shares one queue, with a few hash
+// lookups and no round trip to the print system. An exact queue name always
+// wins; a name the index doesn't know is passed on as given.
+
+namespace {
+
+// Intentionally leaked: worker threads may still rebuild the index during exit
+std::mutex& g_nameIndexMutex = *new std::mutex();
+std::unordered_set<std::string>& g_queueNames = *new std::unordered_set<std::string>();
+std::unordered_map<std::string, std::vector<std::string>>& g_normalizedNames =
+    *new std::unordered_map<std::string, std::vector<std::string>>();
+std::unordered_map<std::string, std::string>& g_aliases = *new std::unordered_map<std::string, std::string>();
+bool g_nameIndexBuilt = false;
+
+bool isNameSeparator(char c) {
+    return c == ' ' || c == '_' || c == '-' || c == '.' || c == '\t';
+}
+
+const char* matchName(NameMatch match) {
+    switch (match) {
+        case NAME_EXACT: return "exact";
+        case NAME_ALIAS: return "alias";
+        case NAME_NORMALIZED: return "normalized";
+        case NAME_AMBIGUOUS: return "ambiguous";
+        default: return "none";
+    }
+}
+
+// Looks a name up among the indexed queues; the caller holds the lock
+NameMatch lookupQueue(const std::string& name, const std::string& key, std::string& resolved,
+                      std::vector<std::string>& candidates) {
+    if (g_queueNames.count(name)) {
+        resolved = name;
+        return NAME_EXACT;
+    }
+    auto it = g_normalizedNames.find(key);
+    if (it == g_normalizedNames.end()) return NAME_NONE;
+    if (it->second.size() > 1) {
+        candidates = it->second;
+        return NAME_AMBIGUOUS;
+    }
+    resolved = it->second.front();
+    return NAME_NORMALIZED;
+}
+
+} // namespace
+
+std::string normalizePrinterName(const std::string& name) {
+    std::string key;
+    key.reserve(name.size());
+    bool pendingSeparator = false;
+    for (char c : name) {
+        if (isNameSeparator(c)) {
+            pendingSeparator = !key.empty();
+            continue;
+        }
+        if (pendingSeparator) key += ' ';
+        pendingSeparator = false;
+        key += (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+    return key;
+}
+
+// Replaces the index with the queue names from one successful enumeration
+void indexQueueNames(const std::vector<std::string>& queues) {
+    std::unordered_set<std::string> names;
+    std::unordered_map<std::string, std::vector<std::string>> normalized;
+    for (const auto& name : queues) {
+        if (!names.insert(name).second) continue;
+        normalized[normalizePrinterName(name)].push_back(name);
+    }
+    for (auto& entry : normalized) std::sort(entry.second.begin(), entry.second.end());
+
+    std::lock_guard<std::mutex> lock(g_nameIndexMutex);
+    g_queueNames.swap(names);
+    g_normalizedNames.swap(normalized);
+    g_nameIndexBuilt = true;
+}
+
+void indexPrinterNames(const std::vector<PrinterInfo>& printers) {
+    std::vector<std::string> names;
+    names.reserve(printers.size());
+    for (const auto& printer : printers) names.push_back(printer.name);
+    indexQueueNames(names);
+}
+
+// False until the first enumeration, when only exact names and aliases resolve
+bool printerNameIndexBuilt() {
+    std::lock_guard<std::mutex> lock(g_nameIndexMutex);
+    return g_nameIndexBuilt;
+}
+
+// Maps a configured name onto the queue it means. Returns false, with the
+// error in result, when the name matches more than one queue.
+bool resolvePrinterName(const std::string& requested, std::string& resolved, OperationResult& result,
+                        NameMatch* matchedBy, std::vector<std::string>* candidates) {
+    std::string key = normalizePrinterName(requested);
+    std::vector<std::string> ambiguous;
+    std::string target;
+    NameMatch match;
+
+    {
+        std::lock_guard<std::mutex> lock(g_nameIndexMutex);
+        match = lookupQueue(requested, key, target, ambiguous);
+        if (match != NAME_EXACT) {
+            auto alias = g_aliases.find(key);
+            if (alias != g_aliases.end()) {
+                // An alias may itself use a drifted spelling of its queue
+                ambiguous.clear();
+                NameMatch aliased = lookupQueue(alias->second, normalizePrinterName(alias->second), target, ambiguous);
+                if (aliased == NAME_NONE) target = alias->second;
+                match = aliased == NAME_AMBIGUOUS ? NAME_AMBIGUOUS : NAME_ALIAS;
+            }
+        }
+    }
+
+    if (matchedBy) *matchedBy = match;
+    if (match == NAME_AMBIGUOUS) {
+        std::string names;
+        for (const auto& name : ambiguous) names += (names.empty() ? "'" : ", '") + name + "'";
+        result.setError(
+            PRINTER_AMBIGUOUS_NAME,
+            "Printer name '" + requested + "' matches more than one queue: " + names +
+            ". Use the exact queue name or register an alias."
+        );
+        if (candidates) candidates->swap(ambiguous);
+        resolved = requested;
+        return false;
+    }
+
+    resolved = match == NAME_NONE ? requested : target;
+    return true;
+}
+
+// ============================================================================
+// Exported N-API functions
+// ============================================================================
+
+// setPrinterAliases({ alias: queueName, ... }) replaces the alias table
+napi_value SetPrinterAliases(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) napi_typeof(env, args[0], &type);
+    bool is_array = false;
+    if (type == napi_object) napi_is_array(env, args[0], &is_array);
+    if (type != napi_object || is_array) {
+        napi_throw_type_error(env, nullptr, "Expected an object mapping aliases to printer names");
+        return nullptr;
+    }
+
+    napi_value keys;
+    uint32_t length = 0;
+    NAPI_CALL(env, napi_get_property_names(env, args[0], &keys));
+    NAPI_CALL(env, napi_get_array_length(env, keys, &length));
+
+    std::unordered_map<std::string, std::string> aliases;
+    std::unordered_map<std::string, std::string> spelledAs;
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value key, value;
+        napi_get_element(env, keys, i, &key);
+        napi_get_property(env, args[0], key, &value);
+
+        std::string alias, target;
+        if (!GetPrinterNameFromArg(env, key, alias) || !GetPrinterNameFromArg(env, value, target) ||
+            normalizePrinterName(alias).empty() || target.empty()) {
+            napi_throw_type_error(env, nullptr,
+                "Aliases and printer names must be non-empty strings with max 256 characters");
+            return nullptr;
+        }
+
+        std::string normalized = normalizePrinterName(alias);
+        auto clash = spelledAs.find(normalized);
+        if (clash != spelledAs.end()) {
+            std::string message = "Aliases '" + clash->second + "' and '" + alias + "' differ only in case or separators";
+            napi_throw_type_error(env, nullptr, message.c_str());
+            return nullptr;
+        }
+        spelledAs[normalized] = alias;
+        aliases[normalized] = target;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_nameIndexMutex);
+        g_aliases.swap(aliases);
+    }
+
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    return undefined;
+}
+
+// resolvePrinterName(name) -> { printerName, matchedBy, candidates? }
+napi_value ResolvePrinterName(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    std::string printer_name;
+    if (argc < 1 || !GetPrinterNameFromArg(env, args[0], printer_name)) {
+        napi_throw_error(env, nullptr, "First argument must be a string (printer name) with max 256 characters");
+        return nullptr;
+    }
+
+    std::string resolved;
+    OperationResult result;
+    NameMatch match = NAME_NONE;
+    std::vector<std::string> candidates;
+    resolvePrinterName(printer_name, resolved, result, &match, &candidates);
+
+    napi_value object, value;
+    NAPI_CALL(env, napi_create_object(env, &object));
+    napi_create_string_utf8(env, resolved.c_str(), resolved.size(), &value);
+    napi_set_named_property(env, object, "printerName", value);
+    napi_create_string_utf8(env, matchName(match), NAPI_AUTO_LENGTH, &value);
+    napi_set_named_property(env, object, "matchedBy", value);
+
+    if (match == NAME_AMBIGUOUS) {
+        napi_value list;
+        napi_create_array_with_length(env, candidates.size(), &list);
+        for (size_t i = 0; i < candidates.size(); i++) {
+            napi_create_string_utf8(env, candidates[i].c_str(), candidates[i].size(), &value);
+            napi_set_element(env, list, static_cast<uint32_t>(i), value);
+        }
+        napi_set_named_property(env, object, "candidates", list);
+    }
+    return object;
+}
@@ -1,48 +1,122 @@
 #include "common.h"
-#include <regex>
+#include "uri.h"
 
 // ============================================================================
 // Helper functions to parse connection details
 // ============================================================================
 
-// Extract IP address from a string (e.g., "192.168.1.100" or "192.168.1.100:9100")
+// Copy a URI host, decoding the "%25" that introduces an IPv6 zone id
+static void assignHost(const UriParts& parts, std::string& host) {
+    host.assign(parts.host.data, parts.host.length);
+    if (parts.hostKind == HOST_IPV6) {
+        size_t zone = host.find("%25");
+        if (zone != std::string::npos) host.erase(zone + 1, 2);
+    }
+}
+
+#ifdef _WIN32
+// Extract IP address from a string (e.g., "192.168.1.100" or "IP_192.168.1.100:9100")
 static bool extractIPv4(const std::string& str, std::string& ip, int& port) {
-    // Pattern for IPv4 with optional port: xxx.xxx.xxx.xxx[:port]
-    std::regex ipPattern(R"((\d{1,3}\.\d{1,3}\.\d{1,3}\.\d{1,3})(?::(\d+))?)");
-    std::smatch match;
-
-    if (std::regex_search(str, match, ipPattern)) {
-        ip = match[1].str();
-        if (match[2].matched) {
-            port = std::stoi(match[2].str());
-        }
-        return true;
+    TextSpan address;
+    if (!scanIPv4(str.data(), str.size(), address, port)) {
+        return false;
     }
-    return false;
+    ip.assign(address.data, address.length);
+    return true;
 }
 
 // Extract Bluetooth address (e.g., "00:11:22:33:44:55" or "001122334455")
 static bool extractBluetoothAddress(const std::string& str, std::string& btAddr) {
-    // Pattern for Bluetooth address with colons or dashes
-    std::regex btPattern(R"(([0-9A-Fa-f]{2}[:\-]){5}[0-9A-Fa-f]{2})");
-    std::smatch match;
+    char formatted[18];
+    if (!scanBluetoothAddress(str.data(), str.size(), formatted)) {
+        return false;
+    }
+    btAddr = formatted;
+    return true;
+}
+#else
+// Fill address details from a network URI; IP literals (including IPv6)
+// go to ipAddress and anything else to hostname
+static void extractNetworkAddress(const UriParts& parts, int defaultPort, PrinterInfo& info) {
+    if (parts.hostKind == HOST_IPV4 || parts.hostKind == HOST_IPV6) {
+        assignHost(parts, info.ipAddress);
+    } else if (parts.hostKind == HOST_NAME) {
+        assignHost(parts, info.hostname);
+    }
+    info.port = parts.port > 0 ? parts.port : defaultPort;
+}
+#endif
 
-    if (std::regex_search(str, match, btPattern)) {
-        btAddr = match[0].str();
-        return true;
+// Extract the host and port of a socket://host[:port] device URI. Hostnames
+// and bracketed IPv6 literals are accepted; the port defaults to 9100.
+bool extractSocketEndpoint(const std::string& deviceUri, std::string& host, int& port) {
+    UriParts parts;
+    if (!parseUri(deviceUri.data(), deviceUri.size(), parts) ||
+        !startsWithNoCase(parts.scheme.data, parts.scheme.length, "socket") ||
+        parts.scheme.length != 6 || parts.host.empty()) {
+        return false;
     }
 
-    // Pattern for Bluetooth address without separators (12 hex chars)
-    std::regex btPatternNoSep(R"(([0-9A-Fa-f]{12}))");
-    if (std::regex_search(str, match, btPatternNoSep)) {
-        // Format it with colons
-        std::string raw = match[1].str();
-        btAddr = raw.substr(0, 2) + ":" + raw.substr(2, 2) + ":" +
-                 raw.substr(4, 2) + ":" + raw.substr(6, 2) + ":" +
-                 raw.substr(8, 2) + ":" + raw.substr(10, 2);
+    assignHost(parts, host);
+    port = parts.port > 0 ? parts.port : DEFAULT_RAW_TCP_PORT;
+    return true;
+}
+
+// Extract the device node of a serial:, parallel: or usb: device URI that
+// names one (e.g. "serial:/dev/ttyS0?baud=115200+parity=even+flow=hard"),
+// or of any other URI whose path, with no host, starts with /dev/ (e.g.
+// "file:///dev/usb/lp0"). A network URI never names a local device, even
+// when its path contains /dev/. Serial line settings in the query string are
+// copied into serial.
+bool extractDevicePath(const std::string& deviceUri, std::string& path, SerialSettings& serial) {
+    size_t colon = deviceUri.find(':');
+    if (colon == std::string::npos) {
+        return false;
+    }
+
+    size_t start = colon + 1;
+    if (deviceUri.compare(start, 2, "//") == 0) {
+        // Only an empty authority leaves a local path
+        start += 2;
+        if (deviceUri.compare(start, 1, "/") != 0) {
+            return false;
+        }
+    }
+    if (deviceUri.compare(start, 5, "/dev/") != 0) {
+        return false;
+    }
+
+    size_t query = deviceUri.find('?', start);
+    path = deviceUri.substr(start, query == std::string::npos ? std::string::npos : query - start);
+    if (query == std::string::npos) {
         return true;
     }
-    return false;
+
+    std::string options = deviceUri.substr(query + 1);
+    size_t pos = 0;
+    while (pos < options.size()) {
+        size_t end = options.find_first_of("+&", pos);
+        if (end == std::string::npos) end = options.size();
+
+        std::string option = toLowercase(options.substr(pos, end - pos));
+        size_t eq = option.find('=');
+        if (eq != std::string::npos) {
+            std::string key = option.substr(0, eq);
+            std::string value = option.substr(eq + 1);
+            if (key == "baud") {
+                serial.baudRate = atoi(value.c_str());
+            } else if (key == "bits") {
+                serial.dataBits = atoi(value.c_str()) == 7 ? 7 : 8;
+            } else if (key == "parity") {
+                serial.parity = value == "even" ? PARITY_EVEN : value == "odd" ? PARITY_ODD : PARITY_NONE;
+            } else if (key == "flow") {
+                serial.flowControl = (value == "hard" || value == "rtscts") ? FLOW_HARDWARE
+                                   : (value == "soft") ? FLOW_SOFTWARE : FLOW_NONE;
+            }
+        }
+        pos = end + 1;
+    }
+    return true;
 }
 
 #ifdef _WIN32
@@ -142,29 +216,112 @@ static void detectConnectionDetails(const char* portName, DWORD attributes, Prin
 }
 #endif
 
+#ifndef _WIN32
+// Detect connection type and extract connection details from a CUPS device URI
+static void classifyDeviceUri(const char* deviceUri, PrinterInfo& info) {
+    if (!deviceUri) {
+        info.type = "UNKNOWN";
+        return;
+    }
+
+    size_t length = std::strlen(deviceUri);
+    UriParts parts;
+    bool hierarchical = parseUri(deviceUri, length, parts);
+
+    if (startsWithNoCase(deviceUri, length, "usb:")) {
+        info.type = "USB";
+    } else if (startsWithNoCase(deviceUri, length, "socket://")) {
+        info.type = "NETWORK";
+        if (hierarchical) extractNetworkAddress(parts, DEFAULT_RAW_TCP_PORT, info);
+    } else if (startsWithNoCase(deviceUri, length, "ipp://") || startsWithNoCase(deviceUri, length, "ipps://")) {
+        info.type = "NETWORK";
+        if (hierarchical) extractNetworkAddress(parts, 631, info);
+    } else if (startsWithNoCase(deviceUri, length, "http://")) {
+        info.type = "NETWORK";
+        if (hierarchical) extractNetworkAddress(parts, 80, info);
+    } else if (startsWithNoCase(deviceUri, length, "https://")) {
+        info.type = "NETWORK";
+        if (hierarchical) extractNetworkAddress(parts, 443, info);
+    } else if (startsWithNoCase(deviceUri, length, "lpd://")) {
+        info.type = "NETWORK";
+        if (hierarchical) extractNetworkAddress(parts, 515, info);
+    } else if (startsWithNoCase(deviceUri, length, "smb://")) {
+        info.type = "NETWORK";
+        if (hierarchical) extractNetworkAddress(parts, 445, info);
+    } else if (startsWithNoCase(deviceUri, length, "bluetooth://") || startsWithNoCase(deviceUri, length, "bth://")) {
+        char formatted[18];
+        info.type = "BLUETOOTH";
+        if (scanBluetoothAddress(deviceUri, length, formatted)) info.bluetoothAddress = formatted;
+    } else if (startsWithNoCase(deviceUri, length, "serial://") || containsNoCase(deviceUri, length, "/dev/tty")) {
+        info.type = "SERIAL";
+    } else if (startsWithNoCase(deviceUri, length, "parallel://") || containsNoCase(deviceUri, length, "/dev/lp")) {
+        info.type = "PARALLEL";
+    } else if (startsWithNoCase(deviceUri, length, "file://") || containsNoCase(deviceUri, length, "cups-pdf")) {
+        info.type = "VIRTUAL";
+    } else {
+        info.type = "UNKNOWN";
+    }
+}
+
+// Build the PrinterInfo for one CUPS destination
+PrinterInfo printerInfoFromDest(const cups_dest_t& dest) {
+    PrinterInfo info;
+    info.name = dest.name ? dest.name : "";
+    info.isDefault = (dest.is_default != 0);
+
+    // Get printer state from options
+    const char* state = cupsGetOption("printer-state", dest.num_options, dest.options);
+    if (state) {
+        int stateVal = atoi(state);
+        // IPP printer states: 3=idle, 4=processing, 5=stopped
+        if (stateVal == 3) {
+            info.status = "IDLE";
+        } else if (stateVal == 4) {
+            info.status = "PROCESSING";
+        } else if (stateVal == 5) {
+            info.status = "OFFLINE";
+        } else {
+            info.status = "UNKNOWN";
+        }
+    } else {
+        info.status = "IDLE";
+    }
+
+    // Detect connection type and extract details from device-uri
+    const char* deviceUri = cupsGetOption("device-uri", dest.num_options, dest.options);
+    classifyDeviceUri(deviceUri, info);
+
+    return info;
+}
+#endif
+
 // ============================================================================
 // Platform-specific printer enumeration
 // ============================================================================
 
-static std::vector<PrinterInfo> enumerate_printers() {
-    std::vector<PrinterInfo> printers;
+// Returns false when the print system could not be queried, so callers can
+// tell a failed enumeration from a machine with no printers
+bool enumeratePrinters(std::vector<PrinterInfo>& printers) {
+    StageTimer timer(STAGE_ENUMERATE);
+    printers.clear();
 
 #ifdef _WIN32
     DWORD needed = 0;
     DWORD returned = 0;
     DWORD flags = PRINTER_ENUM_LOCAL | PRINTER_ENUM_CONNECTIONS;
 
-    // First call to get required buffer size
-    EnumPrintersA(flags, NULL, 2, NULL, 0, &needed, &returned);
+    // First call to get required buffer size; it succeeds outright when
+    // there are no printers
+    BOOL sized = EnumPrintersA(flags, NULL, 2, NULL, 0, &needed, &returned);
 
     if (needed == 0) {
-        return printers;
+        return sized != FALSE;
     }
 
     // Allocate buffer and enumerate
     std::vector<BYTE> buffer(needed);
     if (!EnumPrintersA(flags, NULL, 2, buffer.data(), needed, &needed, &returned)) {
-        return printers;
+        return false;
     }
 
     PRINTER_INFO_2A* pPrinterInfo = reinterpret_cast<PRINTER_INFO_2A*>(buffer.data());
@@ -219,185 +376,370 @@ static std::vector<PrinterInfo> enumerate_printers() {
     }
 #else
     // macOS/Linux: Use CUPS
-    cups_dest_t* dests = nullptr;
-    int num_dests = cupsGetDests(&dests);
+    CupsConnection cups;
+    std::string error;
+    if (!cups.acquire(error)) {
+        return false;
+    }
 
-    for (int i = 0; i < num_dests; i++) {
-        PrinterInfo info;
-        info.name = dests[i].name ? dests[i].name : "";
-        info.isDefault = (dests[i].is_default != 0);
-
-        // Get printer state from options
-        const char* state = cupsGetOption("printer-state", dests[i].num_options, dests[i].options);
-        if (state) {
-            int stateVal = atoi(state);
-            // IPP printer states: 3=idle, 4=processing, 5=stopped
-            if (stateVal == 3) {
-                info.status = "IDLE";
-            } else if (stateVal == 4) {
-                info.status = "PROCESSING";
-            } else if (stateVal == 5) {
-                info.status = "OFFLINE";
-            } else {
-                info.status = "UNKNOWN";
-            }
-        } else {
-            info.status = "IDLE";
-        }
+    cups_dest_t* dests = nullptr;
+    int num_dests;
+    {
+        TraceSpan span("cupsGetDests2");
+        num_dests = cupsGetDests2(cups.get(), &dests);
+    }
+    if (num_dests == 0 && cupsLastError() > IPP_STATUS_OK_EVENTS_COMPLETE &&
+        cupsLastError() != IPP_STATUS_ERROR_NOT_FOUND) {
+        cups.discardIfBroken();
+        return false;
+    }
 
-        // Detect connection type and extract details from device-uri
-        const char* deviceUri = cupsGetOption("device-uri", dests[i].num_options, dests[i].options);
-        if (deviceUri) {
-            std::string uri = deviceUri;
-            std::string uriLower = toLowercase(uri);
-
-            if (uriLower.find("usb://") == 0 || uriLower.find("usb:") == 0) {
-                info.type = "USB";
-            } else if (uriLower.find("socket://") == 0) {
-                info.type = "NETWORK";
-                // Extract IP and port from socket://ip:port
-                extractIPv4(uri.substr(9), info.ipAddress, info.port);
-                if (info.port == 0) info.port = 9100;
-            } else if (uriLower.find("ipp://") == 0 || uriLower.find("ipps://") == 0) {
-                info.type = "NETWORK";
-                size_t start = uriLower.find("://") + 3;
-                extractIPv4(uri.substr(start), info.ipAddress, info.port);
-                if (info.port == 0) info.port = (uriLower.find("ipps://") == 0) ? 631 : 631;
-            } else if (uriLower.find("http://") == 0 || uriLower.find("https://") == 0) {
-                info.type = "NETWORK";
-                size_t start = uriLower.find("://") + 3;
-                extractIPv4(uri.substr(start), info.ipAddress, info.port);
-                if (info.port == 0) info.port = (uriLower.find("https://") == 0) ? 443 : 80;
-            } else if (uriLower.find("lpd://") == 0 || uriLower.find("smb://") == 0) {
-                info.type = "NETWORK";
-                size_t start = uriLower.find("://") + 3;
-                extractIPv4(uri.substr(start), info.ipAddress, info.port);
-            } else if (uriLower.find("bluetooth://") == 0 || uriLower.find("bth://") == 0) {
-                info.type = "BLUETOOTH";
-                extractBluetoothAddress(uri, info.bluetoothAddress);
-            } else if (uriLower.find("serial://") == 0 || uriLower.find("/dev/tty") != std::string::npos) {
-                info.type = "SERIAL";
-            } else if (uriLower.find("parallel://") == 0 || uriLower.find("/dev/lp") != std::string::npos) {
-                info.type = "PARALLEL";
-            } else if (uriLower.find("file://") == 0 || uriLower.find("cups-pdf") != std::string::npos) {
-                info.type = "VIRTUAL";
-            } else {
-                info.type = "UNKNOWN";
-            }
-        } else {
-            info.type = "UNKNOWN";
-        }
+    // Warm the destination cache so the next kick skips the lookup
+    cachePrinterDestinations(num_dests, dests);
 
-        printers.push_back(info);
+    printers.reserve(num_dests);
+    for (int i = 0; i < num_dests; i++) {
+        printers.push_back(printerInfoFromDest(dests[i]));
     }
 
     cupsFreeDests(num_dests, dests);
 #endif
 
-    return printers;
+    return true;
 }
 
 // ============================================================================
-// Async work for getAvailablePrinters
+// JavaScript marshalling
 // ============================================================================
 
-struct AsyncPrintersWork {
-    napi_async_work work;
-    napi_deferred deferred;
-    std::vector<PrinterInfo> printers;
+// Property keys are created once per batch, so the key strings are not
+// re-created and re-hashed per printer; they are not kept across batches.
+// Every object gets all keys, in a fixed order and with undefined for
+// missing fields, from a single napi_define_properties() call, so printers
+// with and without network details end up with the same shape. Status and
+// type repeat across a list and share one handle each.
+
+enum PrinterKey {
+    KEY_NAME,
+    KEY_DEFAULT,
+    KEY_STATUS,
+    KEY_TYPE,
+    KEY_IP_ADDRESS,
+    KEY_PORT,
+    KEY_HOSTNAME,
+    KEY_BLUETOOTH_ADDRESS,
+    PRINTER_KEY_COUNT
 };
 
-static void ExecuteGetPrinters(napi_env env, void* data) {
-    AsyncPrintersWork* asyncWork = static_cast<AsyncPrintersWork*>(data);
-    asyncWork->printers = enumerate_printers();
+static const char* const PRINTER_KEY_NAMES[PRINTER_KEY_COUNT] = {
+    "name", "default", "status", "type", "ipAddress", "port", "hostname", "bluetoothAddress"
+};
+
+static_assert(PRINTER_KEY_COUNT == PrinterMarshaller::KEY_COUNT, "PrinterMarshaller::keys_ must fit every key");
+
+static const size_t MAX_SHARED_VALUES = 16;
+
+PrinterMarshaller::PrinterMarshaller(napi_env env) : env_(env) {
+    for (int i = 0; i < PRINTER_KEY_COUNT; i++) keys_[i] = nullptr;
 }
 
-static void CompleteGetPrinters(napi_env env, napi_status status, void* data) {
-    AsyncPrintersWork* asyncWork = static_cast<AsyncPrintersWork*>(data);
+napi_value PrinterMarshaller::key(int index) {
+    if (keys_[index] == nullptr) {
+        napi_create_string_latin1(env_, PRINTER_KEY_NAMES[index], NAPI_AUTO_LENGTH, &keys_[index]);
+    }
+    return keys_[index];
+}
 
-    napi_value result_array;
-    napi_create_array_with_length(env, asyncWork->printers.size(), &result_array);
+napi_value PrinterMarshaller::sharedString(const std::string& value) {
+    for (const auto& entry : shared_) {
+        if (entry.first == value) return entry.second;
+    }
+
+    napi_value result;
+    napi_create_string_utf8(env_, value.c_str(), value.size(), &result);
+    if (shared_.size() < MAX_SHARED_VALUES) shared_.push_back(std::make_pair(value, result));
+    return result;
+}
 
-    for (size_t i = 0; i < asyncWork->printers.size(); i++) {
-        const PrinterInfo& printer = asyncWork->printers[i];
+static napi_property_descriptor valueProperty(napi_value name, napi_value value) {
+    napi_property_descriptor descriptor = {
+        nullptr, name, nullptr, nullptr, nullptr, value, napi_default_jsproperty, nullptr
+    };
+    return descriptor;
+}
 
-        napi_value printer_obj;
-        napi_create_object(env, &printer_obj);
+// Convert one PrinterInfo into the object shape getAvailablePrinters() uses
+napi_value PrinterMarshaller::toObject(const PrinterInfo& printer) {
+    napi_property_descriptor properties[PRINTER_KEY_COUNT];
+    size_t count = 0;
+    napi_value value;
+
+    napi_create_string_utf8(env_, printer.name.c_str(), printer.name.size(), &value);
+    properties[count++] = valueProperty(key(KEY_NAME), value);
+    napi_get_boolean(env_, printer.isDefault, &value);
+    properties[count++] = valueProperty(key(KEY_DEFAULT), value);
+    properties[count++] = valueProperty(key(KEY_STATUS), sharedString(printer.status));
+    properties[count++] = valueProperty(key(KEY_TYPE), sharedString(printer.type));
+
+    // Optional fields are set to undefined rather than left out
+    napi_value undefined_val;
+    napi_get_undefined(env_, &undefined_val);
+
+    value = undefined_val;
+    if (!printer.ipAddress.empty()) {
+        napi_create_string_utf8(env_, printer.ipAddress.c_str(), printer.ipAddress.size(), &value);
+    }
+    properties[count++] = valueProperty(key(KEY_IP_ADDRESS), value);
+    value = undefined_val;
+    if (printer.port > 0) {
+        napi_create_int32(env_, printer.port, &value);
+    }
+    properties[count++] = valueProperty(key(KEY_PORT), value);
+    value = undefined_val;
+    if (!printer.hostname.empty()) {
+        napi_create_string_utf8(env_, printer.hostname.c_str(), printer.hostname.size(), &value);
+    }
+    properties[count++] = valueProperty(key(KEY_HOSTNAME), value);
+    value = undefined_val;
+    if (!printer.bluetoothAddress.empty()) {
+        napi_create_string_utf8(env_, printer.bluetoothAddress.c_str(), printer.bluetoothAddress.size(), &value);
+    }
+    properties[count++] = valueProperty(key(KEY_BLUETOOTH_ADDRESS), value);
 
-        // name
-        napi_value name_val;
-        napi_create_string_utf8(env, printer.name.c_str(), NAPI_AUTO_LENGTH, &name_val);
-        napi_set_named_property(env, printer_obj, "name", name_val);
+    napi_value printer_obj;
+    napi_create_object(env_, &printer_obj);
+    napi_define_properties(env_, printer_obj, count, properties);
+    return printer_obj;
+}
+
+// Columnar layout: one array per field, null where a printer has no value.
+// Builds 8 arrays instead of one object per printer.
+napi_value PrinterMarshaller::toColumns(const std::vector<PrinterInfo>& printers) {
+    napi_value columns[PRINTER_KEY_COUNT];
+    for (int i = 0; i < PRINTER_KEY_COUNT; i++) {
+        napi_create_array_with_length(env_, printers.size(), &columns[i]);
+    }
 
-        // default
-        napi_value default_val;
-        napi_get_boolean(env, printer.isDefault, &default_val);
-        napi_set_named_property(env, printer_obj, "default", default_val);
+    napi_value null_val;
+    napi_get_null(env_, &null_val);
 
-        // status
-        napi_value status_val;
-        napi_create_string_utf8(env, printer.status.c_str(), NAPI_AUTO_LENGTH, &status_val);
-        napi_set_named_property(env, printer_obj, "status", status_val);
+    for (size_t i = 0; i < printers.size(); i++) {
+        const PrinterInfo& printer = printers[i];
+        uint32_t index = static_cast<uint32_t>(i);
+        napi_value value;
 
-        // type
-        napi_value connection_val;
-        napi_create_string_utf8(env, printer.type.c_str(), NAPI_AUTO_LENGTH, &connection_val);
-        napi_set_named_property(env, printer_obj, "type", connection_val);
+        napi_create_string_utf8(env_, printer.name.c_str(), printer.name.size(), &value);
+        napi_set_element(env_, columns[KEY_NAME], index, value);
+        napi_get_boolean(env_, printer.isDefault, &value);
+        napi_set_element(env_, columns[KEY_DEFAULT], index, value);
+        napi_set_element(env_, columns[KEY_STATUS], index, sharedString(printer.status));
+        napi_set_element(env_, columns[KEY_TYPE], index, sharedString(printer.type));
 
-        // ipAddress (only if not empty)
+        value = null_val;
         if (!printer.ipAddress.empty()) {
-            napi_value ip_val;
-            napi_create_string_utf8(env, printer.ipAddress.c_str(), NAPI_AUTO_LENGTH, &ip_val);
-            napi_set_named_property(env, printer_obj, "ipAddress", ip_val);
+            napi_create_string_utf8(env_, printer.ipAddress.c_str(), printer.ipAddress.size(), &value);
         }
+        napi_set_element(env_, columns[KEY_IP_ADDRESS], index, value);
+
+        value = null_val;
+        if (printer.port > 0) napi_create_int32(env_, printer.port, &value);
+        napi_set_element(env_, columns[KEY_PORT], index, value);
 
-        // port (only if > 0)
-        if (printer.port > 0) {
-            napi_value port_val;
-            napi_create_int32(env, printer.port, &port_val);
-            napi_set_named_property(env, printer_obj, "port", port_val);
+        value = null_val;
+        if (!printer.hostname.empty()) {
+            napi_create_string_utf8(env_, printer.hostname.c_str(), printer.hostname.size(), &value);
         }
+        napi_set_element(env_, columns[KEY_HOSTNAME], index, value);
 
-        // bluetoothAddress (only if not empty)
+        value = null_val;
         if (!printer.bluetoothAddress.empty()) {
-            napi_value bt_val;
-            napi_create_string_utf8(env, printer.bluetoothAddress.c_str(), NAPI_AUTO_LENGTH, &bt_val);
-            napi_set_named_property(env, printer_obj, "bluetoothAddress", bt_val);
+            napi_create_string_utf8(env_, printer.bluetoothAddress.c_str(), printer.bluetoothAddress.size(), &value);
         }
+        napi_set_element(env_, columns[KEY_BLUETOOTH_ADDRESS], index, value);
+    }
+
+    napi_property_descriptor properties[PRINTER_KEY_COUNT + 1];
+    napi_value length_key, length;
+    napi_create_string_latin1(env_, "length", NAPI_AUTO_LENGTH, &length_key);
+    napi_create_uint32(env_, static_cast<uint32_t>(printers.size()), &length);
+    properties[0] = valueProperty(length_key, length);
+    for (int i = 0; i < PRINTER_KEY_COUNT; i++) {
+        properties[i + 1] = valueProperty(key(i), columns[i]);
+    }
+
+    napi_value result;
+    napi_create_object(env_, &result);
+    napi_define_properties(env_, result, PRINTER_KEY_COUNT + 1, properties);
+    return result;
+}
+
+napi_value PrinterToObject(napi_env env, const PrinterInfo& printer) {
+    PrinterMarshaller marshaller(env);
+    return marshaller.toObject(printer);
+}
+
+// ============================================================================
+// Pool work for getAvailablePrinters
+// ============================================================================
+
+struct AsyncPrintersWork {
+    napi_deferred deferred;
+    std::vector<PrinterInfo> printers;
+    bool delta;             // getAvailablePrinters({ since })
+    bool columnar;          // getAvailablePrinters({ layout: "columnar" })
+    uint64_t since;
+    PrinterDelta result;
+    AsyncWorkTrace trace;
+
+    AsyncPrintersWork() : deferred(nullptr), delta(false), columnar(false), since(0) {}
+};
+
+static void ExecuteGetPrinters(napi_env env, void* data) {
+    AsyncPrintersWork* asyncWork = static_cast<AsyncPrintersWork*>(data);
+    TraceScope scope(asyncWork->trace.operation, nullptr);
+    traceEvent("queueWait", TRACE_ASYNC, asyncWork->trace.queuedAt, StatsClock::now());
+    TraceSpan execute("execute");
+
+    // Every successful enumeration feeds the snapshot store, so a later
+    // { since } call sees changes found by plain calls too. A failed one
+    // leaves the store alone and the delta is answered from what it holds.
+    if (enumeratePrinters(asyncWork->printers)) {
+        applyPrinterSnapshot(asyncWork->printers);
+        indexPrinterNames(asyncWork->printers);
+    }
+    if (asyncWork->delta) {
+        printerDeltaSince(asyncWork->since, asyncWork->result);
+    }
+    asyncWork->trace.executedAt = StatsClock::now();
+}
+
+static napi_value PrinterList(PrinterMarshaller& marshaller, napi_env env,
+                              const std::vector<PrinterInfo>& printers, bool columnar) {
+    if (columnar) return marshaller.toColumns(printers);
+
+    napi_value result_array;
+    napi_create_array_with_length(env, printers.size(), &result_array);
+    for (size_t i = 0; i < printers.size(); i++) {
+        napi_set_element(env, result_array, static_cast<uint32_t>(i), marshaller.toObject(printers[i]));
+    }
+    return result_array;
+}
 
-        napi_set_element(env, result_array, static_cast<uint32_t>(i), printer_obj);
+static napi_value PrinterDeltaToObject(napi_env env, PrinterMarshaller& marshaller,
+                                       const PrinterDelta& delta, bool columnar) {
+    napi_value result, value;
+    napi_create_object(env, &result);
+
+    napi_create_int64(env, static_cast<int64_t>(delta.generation), &value);
+    napi_set_named_property(env, result, "generation", value);
+    napi_get_boolean(env, delta.full, &value);
+    napi_set_named_property(env, result, "full", value);
+    napi_set_named_property(env, result, "added", PrinterList(marshaller, env, delta.added, columnar));
+    napi_set_named_property(env, result, "changed", PrinterList(marshaller, env, delta.changed, columnar));
+
+    napi_value removed;
+    napi_create_array_with_length(env, delta.removed.size(), &removed);
+    for (size_t i = 0; i < delta.removed.size(); i++) {
+        napi_create_string_utf8(env, delta.removed[i].name.c_str(), NAPI_AUTO_LENGTH, &value);
+        napi_set_element(env, removed, static_cast<uint32_t>(i), value);
     }
+    napi_set_named_property(env, result, "removed", removed);
 
-    napi_resolve_deferred(env, asyncWork->deferred, result_array);
+    return result;
+}
+
+static void CompleteGetPrinters(napi_env env, napi_status status, void* data) {
+    AsyncPrintersWork* asyncWork = static_cast<AsyncPrintersWork*>(data);
+    TraceScope scope(asyncWork->trace.operation, nullptr);
+
+    // Marshalling runs on the JS thread and is the part of this call that
+    // blocks the event loop; see bench/native_bench.cc
+    StageTimer timer(STAGE_MARSHAL);
+    PrinterMarshaller marshaller(env);
+    napi_value result = asyncWork->delta
+        ? PrinterDeltaToObject(env, marshaller, asyncWork->result, asyncWork->columnar)
+        : PrinterList(marshaller, env, asyncWork->printers, asyncWork->columnar);
+    timer.stop();
+
+    napi_resolve_deferred(env, asyncWork->deferred, result);
+    traceEvent("completion", TRACE_ASYNC, asyncWork->trace.executedAt, StatsClock::now());
+    traceEvent("getAvailablePrinters", TRACE_ASYNC, asyncWork->trace.queuedAt, StatsClock::now());
 
-    napi_delete_async_work(env, asyncWork->work);
     delete asyncWork;
 }
 
+// Convert enumerated printers into the array getAvailablePrinters() resolves to
+napi_value PrintersToArray(napi_env env, const std::vector<PrinterInfo>& printers) {
+    PrinterMarshaller marshaller(env);
+    return PrinterList(marshaller, env, printers, false);
+}
+
 // ============================================================================
 // Exported N-API function
 // ============================================================================
 
+// Generations are handed to JS as numbers, so stay within 2^53
+static const double MAX_SAFE_GENERATION = 9007199254740991.0;
+
+// getAvailablePrinters() -> printers
+// getAvailablePrinters({ since }) -> { generation, full, added, changed, removed }
+// { layout: "columnar" } turns each printer list into { length, name: [], ... }
 napi_value GetAvailablePrinters(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    bool delta = false;
+    bool columnar = false;
+    double since = 0;
+    napi_valuetype options_type = napi_undefined;
+    if (argc >= 1) napi_typeof(env, args[0], &options_type);
+    if (options_type == napi_object) {
+        bool has_layout;
+        napi_has_named_property(env, args[0], "layout", &has_layout);
+        if (has_layout) {
+            napi_value value;
+            char layout[16];
+            size_t length = 0;
+            napi_get_named_property(env, args[0], "layout", &value);
+            if (napi_get_value_string_utf8(env, value, layout, sizeof(layout), &length) != napi_ok ||
+                (strcmp(layout, "objects") != 0 && strcmp(layout, "columnar") != 0)) {
+                napi_throw_type_error(env, nullptr, "layout must be \"objects\" or \"columnar\"");
+                return nullptr;
+            }
+            columnar = strcmp(layout, "columnar") == 0;
+        }
+
+        bool has_since;
+        napi_has_named_property(env, args[0], "since", &has_since);
+        if (has_since) {
+            napi_value value;
+            napi_valuetype since_type;
+            napi_get_named_property(env, args[0], "since", &value);
+            napi_typeof(env, value, &since_type);
+            if (since_type != napi_number || napi_get_value_double(env, value, &since) != napi_ok ||
+                !(since >= 0) || since > MAX_SAFE_GENERATION) {
+                napi_throw_range_error(env, nullptr, "since must be a generation returned by getAvailablePrinters");
+                return nullptr;
+            }
+            delta = true;
+        }
+    } else if (options_type != napi_undefined) {
+        napi_throw_type_error(env, nullptr, "Options must be an object");
+        return nullptr;
+    }
+
     AsyncPrintersWork* asyncWork = new AsyncPrintersWork();
+    asyncWork->delta = delta;
+    asyncWork->columnar = columnar;
+    asyncWork->since = static_cast<uint64_t>(since);
 
     napi_value promise;
     NAPI_CALL(env, napi_create_promise(env, &asyncWork->deferred, &promise));
 
-    napi_value work_name;
-    NAPI_CALL(env, napi_create_string_utf8(env, "GetAvailablePrintersAsync", NAPI_AUTO_LENGTH, &work_name));
-
-    NAPI_CALL(env, napi_create_async_work(
-        env,
-        nullptr,
-        work_name,
-        ExecuteGetPrinters,
-        CompleteGetPrinters,
-        asyncWork,
-        &asyncWork->work
-    ));
-
-    NAPI_CALL(env, napi_queue_async_work(env, asyncWork->work));
+    // Enumeration can block on cupsd; keep it off libuv's pool
+    QueuePoolWork(env, ExecuteGetPrinters, CompleteGetPrinters, asyncWork);
 
     return promise;
 }
@@ -0,0 +1,286 @@
+#include "common.h"
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+// ============================================================================
+// Raster images (GS v 0)
+// ============================================================================
+//
+// encodeRasterImage() turns RGBA pixels into a 1-bit ESC/POS raster image:
+// each row is converted to grayscale (composited over white paper), reduced
+// to black and white with Floyd-Steinberg dithering or a plain threshold, and
+// packed eight dots to a byte. The per-pixel loops are written without
+// branches or cross-iteration state so the compiler can vectorise them;
+// only the dithering itself is inherently sequential.
+//
+// The same logo is printed on every receipt, so results are kept in a small
+// LRU cache keyed by a hash of the pixels and settings. A hit is confirmed
+// against the cached pixels, then costs a hash and a copy.
+
+static const int DEFAULT_RASTER_THRESHOLD = 128;
+static const size_t MAX_RASTER_CACHE_ENTRIES = 32;
+static const size_t MAX_RASTER_CACHE_BYTES = 16 * 1024 * 1024;
+static const uint32_t MAX_RASTER_BYTES_PER_ROW = 0xFFFF;  // xL xH
+static const uint32_t MAX_RASTER_ROWS = 0xFFFF;           // yL yH
+
+namespace {
+
+struct RasterSettings {
+    uint32_t width;
+    uint32_t height;
+    bool dither;
+    int threshold;
+
+    bool operator==(const RasterSettings& other) const {
+        return width == other.width && height == other.height &&
+               dither == other.dither && threshold == other.threshold;
+    }
+};
+
+struct RasterCacheEntry {
+    uint64_t hash;
+    RasterSettings settings;
+    std::vector<unsigned char> pixels;                        // To confirm a hit
+    std::shared_ptr<const std::vector<unsigned char>> encoded;  // GS v 0 command
+};
+
+// Intentionally leaked: a worker_threads environment may still be encoding
+// while static destructors run at exit
+std::mutex& g_rasterCacheMutex = *new std::mutex();
+std::list<RasterCacheEntry>& g_rasterCache = *new std::list<RasterCacheEntry>();  // Most recent first
+std::unordered_multimap<uint64_t, std::list<RasterCacheEntry>::iterator>& g_rasterIndex =
+    *new std::unordered_multimap<uint64_t, std::list<RasterCacheEntry>::iterator>();
+size_t g_rasterCacheBytes = 0;
+
+// 64-bit hash over four independent lanes so the multiplies overlap
+uint64_t hashPixels(const unsigned char* data, size_t length, const RasterSettings& settings) {
+    const uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ULL;
+    uint64_t lanes[4] = {
+        settings.width * MULTIPLIER,
+        settings.height * MULTIPLIER,
+        static_cast<uint64_t>(settings.threshold) * MULTIPLIER,
+        ((settings.dither ? 1 : 2) * MULTIPLIER) ^ length
+    };
+
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        for (int lane = 0; lane < 4; lane++) {
+            uint64_t word;
+            std::memcpy(&word, data + i + lane * 8, 8);
+            lanes[lane] = (lanes[lane] ^ word) * MULTIPLIER;
+            lanes[lane] ^= lanes[lane] >> 29;
+        }
+    }
+    for (; i < length; i++) {
+        lanes[i & 3] = (lanes[i & 3] ^ data[i]) * MULTIPLIER;
+    }
+
+    uint64_t hash = 0;
+    for (int lane = 0; lane < 4; lane++) {
+        hash = (hash ^ lanes[lane]) * MULTIPLIER;
+        hash ^= hash >> 32;
+    }
+    return hash;
+}
+
+std::shared_ptr<const std::vector<unsigned char>> findCachedRaster(
+    uint64_t hash, const RasterSettings& settings, const unsigned char* pixels, size_t length) {
+    std::lock_guard<std::mutex> lock(g_rasterCacheMutex);
+    auto range = g_rasterIndex.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        RasterCacheEntry& entry = *it->second;
+        if (entry.settings == settings && entry.pixels.size() == length &&
+            std::memcmp(entry.pixels.data(), pixels, length) == 0) {
+            g_rasterCache.splice(g_rasterCache.begin(), g_rasterCache, it->second);
+            return entry.encoded;
+        }
+    }
+    return nullptr;
+}
+
+void cacheRaster(uint64_t hash, const RasterSettings& settings, const unsigned char* pixels,
+                 size_t length, const std::shared_ptr<const std::vector<unsigned char>>& encoded) {
+    size_t bytes = length + encoded->size();
+    if (bytes > MAX_RASTER_CACHE_BYTES) return;
+
+    std::lock_guard<std::mutex> lock(g_rasterCacheMutex);
+    g_rasterCache.push_front(RasterCacheEntry{ hash, settings, std::vector<unsigned char>(pixels, pixels + length), encoded });
+    g_rasterIndex.insert(std::make_pair(hash, g_rasterCache.begin()));
+    g_rasterCacheBytes += bytes;
+
+    while (g_rasterCache.size() > MAX_RASTER_CACHE_ENTRIES || g_rasterCacheBytes > MAX_RASTER_CACHE_BYTES) {
+        auto oldest = std::prev(g_rasterCache.end());
+        auto range = g_rasterIndex.equal_range(oldest->hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == oldest) {
+                g_rasterIndex.erase(it);
+                break;
+            }
+        }
+        g_rasterCacheBytes -= oldest->pixels.size() + oldest->encoded->size();
+        g_rasterCache.erase(oldest);
+    }
+}
+
+// Luma (BT.601 weights in 8.8 fixed point) composited over white paper, so
+// transparent pixels don't print
+void grayscaleRow(const unsigned char* rgba, uint32_t width, unsigned char* gray) {
+    for (uint32_t x = 0; x < width; x++) {
+        const unsigned char* p = rgba + x * 4;
+        uint32_t luma = (p[0] * 77u + p[1] * 150u + p[2] * 29u) >> 8;
+        uint32_t ink = (255u - luma) * p[3] + 128u;  // Darkness scaled by alpha, /255 rounded below
+        gray[x] = static_cast<unsigned char>(255u - ((ink + (ink >> 8)) >> 8));
+    }
+}
+
+// One bit per dot, most significant first; 1 prints black
+void packThresholdRow(const unsigned char* gray, uint32_t width, int threshold, unsigned char* out) {
+    uint32_t whole = width / 8;
+    for (uint32_t i = 0; i < whole; i++) {
+        const unsigned char* g = gray + i * 8;
+        out[i] = static_cast<unsigned char>(
+            ((g[0] < threshold) << 7) | ((g[1] < threshold) << 6) | ((g[2] < threshold) << 5) |
+            ((g[3] < threshold) << 4) | ((g[4] < threshold) << 3) | ((g[5] < threshold) << 2) |
+            ((g[6] < threshold) << 1) | (g[7] < threshold));
+    }
+    if (width % 8 != 0) {
+        unsigned char last = 0;
+        for (uint32_t x = whole * 8; x < width; x++) {
+            if (gray[x] < threshold) last |= static_cast<unsigned char>(0x80 >> (x % 8));
+        }
+        out[whole] = last;
+    }
+}
+
+// Floyd-Steinberg: errors carry right into this row and down into the next.
+// The error rows have a guard entry on each side.
+void packDitheredRow(const unsigned char* gray, uint32_t width, int threshold,
+                     std::vector<int>& current, std::vector<int>& next, unsigned char* out) {
+    std::fill(next.begin(), next.end(), 0);
+    std::memset(out, 0, (width + 7) / 8);
+
+    for (uint32_t x = 0; x < width; x++) {
+        int value = gray[x] + current[x + 1];
+        int printed = value < threshold ? 0 : 255;
+        if (printed == 0) out[x / 8] |= static_cast<unsigned char>(0x80 >> (x % 8));
+
+        int error = value - printed;
+        current[x + 2] += error * 7 / 16;
+        next[x] += error * 3 / 16;
+        next[x + 1] += error * 5 / 16;
+        next[x + 2] += error / 16;
+    }
+    current.swap(next);
+}
+
+void encodeRaster(const unsigned char* rgba, const RasterSettings& settings, std::vector<unsigned char>& encoded) {
+    uint32_t bytesPerRow = (settings.width + 7) / 8;
+    encoded.resize(8 + static_cast<size_t>(bytesPerRow) * settings.height);
+
+    // GS v 0 m xL xH yL yH, m = 0 (normal size)
+    unsigned char* out = encoded.data();
+    out[0] = 0x1D;
+    out[1] = 0x76;
+    out[2] = 0x30;
+    out[3] = 0x00;
+    out[4] = static_cast<unsigned char>(bytesPerRow & 0xFF);
+    out[5] = static_cast<unsigned char>(bytesPerRow >> 8);
+    out[6] = static_cast<unsigned char>(settings.height & 0xFF);
+    out[7] = static_cast<unsigned char>(settings.height >> 8);
+    out += 8;
+
+    std::vector<unsigned char> gray(settings.width);
+    std::vector<int> current, next;
+    if (settings.dither) {
+        current.assign(settings.width + 2, 0);
+        next.assign(settings.width + 2, 0);
+    }
+
+    for (uint32_t y = 0; y < settings.height; y++) {
+        grayscaleRow(rgba + static_cast<size_t>(y) * settings.width * 4, settings.width, gray.data());
+        if (settings.dither) {
+            packDitheredRow(gray.data(), settings.width, settings.threshold, current, next, out);
+        } else {
+            packThresholdRow(gray.data(), settings.width, settings.threshold, out);
+        }
+        out += bytesPerRow;
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// Exported N-API functions
+// ============================================================================
+
+// encodeRasterImage(rgba, width, height, { dither, threshold }) -> Buffer
+napi_value EncodeRasterImage(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value args[4];
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    const unsigned char* pixels = nullptr;
+    size_t length = 0;
+    if (argc < 3 || !GetRawData(env, args[0], pixels, length)) {
+        napi_throw_type_error(env, nullptr, "Expected RGBA pixels (Buffer, Uint8Array, Uint8ClampedArray or ArrayBuffer), width and height");
+        return nullptr;
+    }
+
+    RasterSettings settings;
+    settings.dither = true;
+    settings.threshold = DEFAULT_RASTER_THRESHOLD;
+    if (napi_get_value_uint32(env, args[1], &settings.width) != napi_ok ||
+        napi_get_value_uint32(env, args[2], &settings.height) != napi_ok ||
+        settings.width == 0 || settings.height == 0 ||
+        (settings.width + 7) / 8 > MAX_RASTER_BYTES_PER_ROW || settings.height > MAX_RASTER_ROWS) {
+        napi_throw_range_error(env, nullptr, "width and height must be positive and fit a GS v 0 image");
+        return nullptr;
+    }
+    if (length != static_cast<size_t>(settings.width) * settings.height * 4) {
+        napi_throw_range_error(env, nullptr, "Pixel data must be width * height * 4 bytes of RGBA");
+        return nullptr;
+    }
+
+    napi_valuetype options_type = napi_undefined;
+    if (argc >= 4) napi_typeof(env, args[3], &options_type);
+    if (options_type == napi_object) {
+        bool present;
+        napi_has_named_property(env, args[3], "dither", &present);
+        if (present) {
+            napi_value value;
+            napi_valuetype type;
+            napi_get_named_property(env, args[3], "dither", &value);
+            napi_typeof(env, value, &type);
+            if (type != napi_undefined && napi_get_value_bool(env, value, &settings.dither) != napi_ok) {
+                napi_throw_error(env, nullptr, "Invalid options: dither must be a boolean");
+                return nullptr;
+            }
+        }
+
+        int32_t threshold;
+        if (!GetOptionalInt32Property(env, args[3], "threshold", threshold, present) ||
+            (present && (threshold < 0 || threshold > 255))) {
+            napi_throw_error(env, nullptr, "Invalid options: threshold must be 0-255");
+            return nullptr;
+        }
+        if (present) settings.threshold = threshold;
+    }
+
+    uint64_t hash = hashPixels(pixels, length, settings);
+    std::shared_ptr<const std::vector<unsigned char>> encoded = findCachedRaster(hash, settings, pixels, length);
+    if (!encoded) {
+        std::shared_ptr<std::vector<unsigned char>> fresh = std::make_shared<std::vector<unsigned char>>();
+        encodeRaster(pixels, settings, *fresh);
+        encoded = fresh;
+        cacheRaster(hash, settings, pixels, length, encoded);
+    }
+
+    // Always a fresh copy: the caller may modify the Buffer it gets
+    napi_value buffer;
+    NAPI_CALL(env, napi_create_buffer_copy(env, encoded->size(), encoded->data(), nullptr, &buffer));
+    return buffer;
+}
@@ -0,0 +1,435 @@
+#include "common.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// ============================================================================
+// Per-printer job scheduler
+// ============================================================================
+//
+// Every job for a printer goes through that printer's queue and its jobs run
+// one at a time on the worker pool, so submissions to one device never race. Drawer kicks
+// use a priority lane that is always drained before bulk jobs. An identical
+// kick arriving within the coalescing window is merged into the earlier one
+// and every caller receives the shared result. Results are handed back to JS
+// through one thread-safe function per environment instead of an async work
+// item per call, and native waiters (e.g. failover) are called back on the
+// worker thread. A job may hand its waiters off once it has run (e.g. to the
+// spooler job tracker), which then settles them itself. A printer's queue is
+// dropped once it is empty and its last kick can no longer be merged into,
+// so names that are used once don't pile up.
+
+typedef std::chrono::steady_clock Clock;
+
+static const int DEFAULT_COALESCE_WINDOW_MS = 0;
+static const int DEFAULT_MAX_QUEUE_DEPTH = 32;
+static const size_t MIN_QUEUE_SWEEP = 64;
+
+// Completion path back to one JS environment. Workers may outlive the
+// environment, so the thread-safe function is only called while open.
+struct CompletionChannel {
+    std::mutex mutex;
+    napi_threadsafe_function tsfn;
+    bool closed;
+    uint32_t pending;  // JS thread only
+
+    CompletionChannel() : tsfn(nullptr), closed(false), pending(0) {}
+};
+
+namespace {
+
+struct SchedulerJob {
+    std::string coalesceKey;
+    std::function<OperationResult()> run;
+    JobHandoff handoff;
+    Clock::time_point submittedAt;
+    uint64_t traceOperation;  // The first waiter's
+    std::vector<JobWaiter> waiters;
+    bool done;
+    OperationResult result;
+
+    SchedulerJob() : traceOperation(0), done(false) {}
+};
+
+struct PrinterQueue {
+    std::deque<std::shared_ptr<SchedulerJob>> lanes[2];
+    std::shared_ptr<SchedulerJob> lastKick;
+    size_t depth;  // queued + running
+    bool workerActive;  // A runNextJob task is queued or running
+
+    PrinterQueue() : depth(0), workerActive(false) {}
+};
+
+struct Completion {
+    JobWaiter waiter;
+    OperationResult result;
+    Clock::time_point deliveredAt;
+};
+
+// Intentionally leaked: detached workers may still touch these during exit
+std::mutex& g_schedulerMutex = *new std::mutex();
+std::unordered_map<std::string, PrinterQueue>& g_queues = *new std::unordered_map<std::string, PrinterQueue>();
+int g_coalesceWindowMs = DEFAULT_COALESCE_WINDOW_MS;
+int g_maxQueueDepth = DEFAULT_MAX_QUEUE_DEPTH;
+size_t g_queueSweepAt = MIN_QUEUE_SWEEP;  // Queue count that triggers the next sweep
+
+// Runs on the JS thread: resolve the waiter's promise
+void CallJsCompletion(napi_env env, napi_value js_callback, void* context, void* data) {
+    Completion* completion = static_cast<Completion*>(data);
+
+    if (env != nullptr) {
+        TraceScope scope(completion->waiter.traceOperation, nullptr);
+        CompletionChannel& channel = *completion->waiter.channel;
+        napi_value value = completion->waiter.format(env, completion->result);
+        napi_resolve_deferred(env, completion->waiter.deferred, value);
+        if (completion->waiter.retained != nullptr) {
+            napi_delete_reference(env, completion->waiter.retained);
+        }
+        recordStage(STAGE_COMPLETION, completion->deliveredAt);
+        if (completion->waiter.traceName != nullptr) {
+            traceEvent(completion->waiter.traceName, TRACE_ASYNC, completion->waiter.createdAt, Clock::now());
+        }
+
+        if (--channel.pending == 0) {
+            napi_unref_threadsafe_function(env, channel.tsfn);
+        }
+    }
+
+    delete completion;
+}
+
+void FinalizeCompletionChannel(napi_env env, void* finalize_data, void* finalize_hint) {
+    std::shared_ptr<CompletionChannel>* channel = static_cast<std::shared_ptr<CompletionChannel>*>(finalize_data);
+    {
+        std::lock_guard<std::mutex> lock((*channel)->mutex);
+        (*channel)->closed = true;
+    }
+    delete channel;
+}
+
+void deliver(const JobWaiter& waiter, const OperationResult& result) {
+    if (waiter.done) {
+        waiter.done(result);
+        return;
+    }
+
+    Completion* completion = new Completion();
+    completion->waiter = waiter;
+    completion->result = result;
+    completion->deliveredAt = Clock::now();
+
+    CompletionChannel& channel = *waiter.channel;
+    std::lock_guard<std::mutex> lock(channel.mutex);
+    if (channel.closed ||
+        napi_call_threadsafe_function(channel.tsfn, completion, napi_tsfn_nonblocking) != napi_ok) {
+        delete completion;
+    }
+}
+
+// Nothing queued or running, and no kick a new one could still merge into;
+// caller holds g_schedulerMutex
+bool isQueueIdle(const PrinterQueue& queue, Clock::time_point now) {
+    if (queue.depth > 0 || queue.workerActive) return false;
+    return !queue.lastKick ||
+           std::chrono::duration_cast<std::chrono::milliseconds>(now - queue.lastKick->submittedAt).count() >=
+               g_coalesceWindowMs;
+}
+
+// Queues kept for their coalescing window have nobody left to drop them, so
+// they're swept once the map has doubled since the last sweep
+void sweepIdleQueues(Clock::time_point now) {
+    for (auto it = g_queues.begin(); it != g_queues.end();) {
+        if (isQueueIdle(it->second, now)) {
+            it = g_queues.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    g_queueSweepAt = std::max(MIN_QUEUE_SWEEP, g_queues.size() * 2);
+}
+
+// Runs the printer's next job on the worker pool. One job per task, with
+// the next one resubmitted, so a busy printer can't hold a worker while
+// other printers wait; at most one task per printer is queued or running.
+void runNextJob(std::string printerName) {
+    std::unique_lock<std::mutex> lock(g_schedulerMutex);
+    PrinterQueue& queue = g_queues[printerName];
+
+    std::shared_ptr<SchedulerJob> job;
+    for (auto& lane : queue.lanes) {
+        if (!lane.empty()) {
+            job = lane.front();
+            lane.pop_front();
+            break;
+        }
+    }
+    if (!job) {
+        queue.workerActive = false;
+        if (isQueueIdle(queue, Clock::now())) g_queues.erase(printerName);
+        return;
+    }
+
+    lock.unlock();
+    OperationResult result;
+    {
+        TraceScope scope(job->traceOperation, printerName.c_str());
+        recordStage(STAGE_QUEUE_WAIT, job->submittedAt);
+        TraceSpan execute("execute");
+        result = job->run();
+    }
+    lock.lock();
+
+    job->done = true;
+    job->result = result;
+    job->run = nullptr;
+    std::vector<JobWaiter> waiters;
+    waiters.swap(job->waiters);
+    queue.depth--;
+    bool more = !queue.lanes[LANE_KICK].empty() || !queue.lanes[LANE_BULK].empty();
+    if (!more) {
+        queue.workerActive = false;
+        if (isQueueIdle(queue, Clock::now())) g_queues.erase(printerName);
+    }
+    lock.unlock();
+
+    if (more) {
+        SubmitPoolTask([printerName]() { runNextJob(printerName); });
+    }
+    if (!job->handoff || !job->handoff(result, waiters)) {
+        for (const auto& waiter : waiters) {
+            deliver(waiter, result);
+        }
+    }
+}
+
+// Queues a job for the printer, or merges the waiter into an identical recent
+// kick. Returns false, with the result in immediate, when the waiter must be
+// settled right away instead (queue full, or merged into a finished kick).
+bool enqueueJob(JobWaiter& waiter, const std::string& printerName, JobLane lane,
+                const std::string& coalesceKey, const std::function<OperationResult()>& run,
+                const JobHandoff& handoff, OperationResult& immediate) {
+    Clock::time_point now = Clock::now();
+    waiter.createdAt = now;
+
+    std::unique_lock<std::mutex> lock(g_schedulerMutex);
+    if (g_queues.size() >= g_queueSweepAt) sweepIdleQueues(now);
+    PrinterQueue& queue = g_queues[printerName];
+
+    std::shared_ptr<SchedulerJob>& recent = queue.lastKick;
+    bool coalesce = lane == LANE_KICK && !coalesceKey.empty() && recent &&
+                    recent->coalesceKey == coalesceKey &&
+                    std::chrono::duration_cast<std::chrono::milliseconds>(now - recent->submittedAt).count() <
+                        g_coalesceWindowMs;
+    // A finished job whose waiters were handed off has no final result to share
+    if (coalesce && recent->done && recent->handoff) coalesce = false;
+
+    if (coalesce && recent->done) {
+        immediate = recent->result;
+        return false;
+    }
+    if (coalesce) {
+        recent->waiters.push_back(waiter);
+        return true;
+    }
+    if (queue.depth >= static_cast<size_t>(g_maxQueueDepth)) {
+        immediate.setError(
+            PRINTER_QUEUE_FULL,
+            "Too many jobs queued for printer '" + printerName + "' (" + std::to_string(queue.depth) + ")"
+        );
+        return false;
+    }
+
+    std::shared_ptr<SchedulerJob> job = std::make_shared<SchedulerJob>();
+    job->coalesceKey = coalesceKey;
+    job->run = run;
+    job->handoff = handoff;
+    job->submittedAt = now;
+    job->traceOperation = waiter.traceOperation;
+    job->waiters.push_back(waiter);
+
+    queue.lanes[lane].push_back(job);
+    queue.depth++;
+    if (lane == LANE_KICK) {
+        queue.lastKick = job;
+    }
+    bool startWorker = !queue.workerActive;
+    queue.workerActive = true;
+    lock.unlock();
+    if (startWorker) {
+        SubmitPoolTask([printerName]() { runNextJob(printerName); });
+    }
+    return true;
+}
+
+} // namespace
+
+// ============================================================================
+// Scheduler API
+// ============================================================================
+
+bool InitScheduler(napi_env env, AddonData* data) {
+    std::shared_ptr<CompletionChannel>* channel =
+        new std::shared_ptr<CompletionChannel>(std::make_shared<CompletionChannel>());
+
+    napi_value name;
+    napi_create_string_utf8(env, "PrinterJobCompletion", NAPI_AUTO_LENGTH, &name);
+
+    napi_status status = napi_create_threadsafe_function(
+        env, nullptr, nullptr, name,
+        0, 1,
+        channel, FinalizeCompletionChannel,
+        nullptr, CallJsCompletion,
+        &(*channel)->tsfn);
+    if (status != napi_ok) {
+        delete channel;
+        return false;
+    }
+
+    // Only keep the event loop alive while jobs are outstanding
+    napi_unref_threadsafe_function(env, (*channel)->tsfn);
+    data->completions = *channel;
+    return true;
+}
+
+napi_value ScheduleJob(napi_env env, const char* operationName, const std::string& printerName,
+                       JobLane lane, const std::string& coalesceKey, std::function<OperationResult()> run,
+                       ResultFormatter format, napi_ref retained, JobHandoff handoff) {
+    AddonData* data = GetAddonData(env);
+
+    JobWaiter waiter;
+    waiter.channel = data->completions;
+    waiter.format = format;
+    waiter.retained = retained;
+    waiter.traceOperation = beginTraceOperation();
+    waiter.traceName = operationName;
+
+    napi_value promise;
+    if (napi_create_promise(env, &waiter.deferred, &promise) != napi_ok) {
+        return nullptr;
+    }
+
+    OperationResult immediate;
+    bool resolveNow = !enqueueJob(waiter, printerName, lane, coalesceKey, run, handoff, immediate);
+
+    if (resolveNow) {
+        napi_resolve_deferred(env, waiter.deferred, format(env, immediate));
+        if (retained != nullptr) napi_delete_reference(env, retained);
+    } else if (waiter.channel->pending++ == 0) {
+        napi_ref_threadsafe_function(env, waiter.channel->tsfn);
+    }
+
+    return promise;
+}
+
+// Schedules a job whose result goes to waiter.done instead of a promise, for
+// native code that acts on the outcome (e.g. failover). done runs on the
+// worker thread, or on this one if the job is settled right away.
+void ScheduleNativeJob(const JobWaiter& waiter, const std::string& printerName, JobLane lane,
+                       const std::string& coalesceKey, std::function<OperationResult()> run,
+                       JobHandoff handoff) {
+    JobWaiter native = waiter;
+    OperationResult immediate;
+    if (!enqueueJob(native, printerName, lane, coalesceKey, run, handoff, immediate)) {
+        native.done(immediate);
+    }
+}
+
+// A promise for a result that some other native thread delivers later with
+// DeliverResult(); keeps the event loop alive until then
+napi_value CreatePendingResult(napi_env env, ResultFormatter format, JobWaiter& waiter) {
+    waiter.channel = GetAddonData(env)->completions;
+    waiter.format = format;
+
+    napi_value promise;
+    if (napi_create_promise(env, &waiter.deferred, &promise) != napi_ok) {
+        return nullptr;
+    }
+    if (waiter.channel->pending++ == 0) {
+        napi_ref_threadsafe_function(env, waiter.channel->tsfn);
+    }
+    return promise;
+}
+
+// Settles a promise from CreatePendingResult(); callable from any thread
+void DeliverResult(const JobWaiter& waiter, const OperationResult& result) {
+    deliver(waiter, result);
+}
+
+size_t GetPrinterQueueDepth(const std::string& printerName) {
+    std::lock_guard<std::mutex> lock(g_schedulerMutex);
+    auto it = g_queues.find(printerName);
+    return it == g_queues.end() ? 0 : it->second.depth;
+}
+
+// ============================================================================
+// Exported N-API functions
+// ============================================================================
+
+napi_value ConfigureScheduler(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) napi_typeof(env, args[0], &type);
+    if (type != napi_object) {
+        napi_throw_type_error(env, nullptr, "Expected an options object");
+        return nullptr;
+    }
+
+    int32_t coalesceWindowMs = -1;
+    int32_t maxQueueDepth = -1;
+    bool has_property;
+    napi_value value;
+
+    napi_has_named_property(env, args[0], "coalesceWindowMs", &has_property);
+    if (has_property) {
+        napi_get_named_property(env, args[0], "coalesceWindowMs", &value);
+        if (napi_get_value_int32(env, value, &coalesceWindowMs) != napi_ok || coalesceWindowMs < 0) {
+            napi_throw_range_error(env, nullptr, "coalesceWindowMs must be a non-negative number");
+            return nullptr;
+        }
+    }
+
+    napi_has_named_property(env, args[0], "maxQueueDepth", &has_property);
+    if (has_property) {
+        napi_get_named_property(env, args[0], "maxQueueDepth", &value);
+        if (napi_get_value_int32(env, value, &maxQueueDepth) != napi_ok || maxQueueDepth < 1) {
+            napi_throw_range_error(env, nullptr, "maxQueueDepth must be at least 1");
+            return nullptr;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_schedulerMutex);
+        if (coalesceWindowMs >= 0) g_coalesceWindowMs = coalesceWindowMs;
+        if (maxQueueDepth >= 1) g_maxQueueDepth = maxQueueDepth;
+    }
+
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    return undefined;
+}
+
+napi_value GetQueueDepth(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    std::string printer_name;
+    if (argc < 1 || !GetPrinterNameFromArg(env, args[0], printer_name)) {
+        napi_throw_error(env, nullptr, "First argument must be a string (printer name) with max 256 characters");
+        return nullptr;
+    }
+    OperationResult ambiguous;
+    resolvePrinterName(printer_name, printer_name, ambiguous);
+
+    napi_value depth;
+    NAPI_CALL(env, napi_create_uint32(env, static_cast<uint32_t>(GetPrinterQueueDepth(printer_name)), &depth));
+    return depth;
+}
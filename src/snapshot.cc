@@ -0,0 +1,145 @@
+#include "common.h"
+#include <chrono>
+#include <map>
+#include <mutex>
+
+// ============================================================================
+// Printer snapshot store
+// ============================================================================
+//
+// Keeps the result of the last enumeration together with the generation at
+// which each printer was added or last changed. The generation only moves
+// when something changed, so getAvailablePrinters({ since }) can answer with
+// just the printers touched after the caller's generation. Removed printers
+// are kept as tombstones so removals can be reported; once too many pile up
+// the oldest are dropped and older generations get a full list instead.
+
+static const size_t MAX_PRINTER_TOMBSTONES = 1024;
+
+namespace {
+
+struct SnapshotEntry {
+    PrinterInfo info;
+    uint64_t addedGeneration;
+    uint64_t modifiedGeneration;
+    bool removed;
+};
+
+// Intentionally leaked: the detached watcher may still touch these during exit
+std::mutex& g_snapshotMutex = *new std::mutex();
+std::map<std::string, SnapshotEntry>& g_entries = *new std::map<std::string, SnapshotEntry>();
+uint64_t g_generation = 0;
+uint64_t g_deltaFloor = 0;  // Deltas from before this generation need a full list
+size_t g_tombstones = 0;
+
+bool samePrinter(const PrinterInfo& a, const PrinterInfo& b) {
+    return a.isDefault == b.isDefault && a.port == b.port &&
+           a.status == b.status && a.type == b.type &&
+           a.ipAddress == b.ipAddress && a.hostname == b.hostname &&
+           a.bluetoothAddress == b.bluetoothAddress;
+}
+
+// Start from wall-clock milliseconds so a generation saved before a restart
+// is never mistaken for one issued by this process
+void initGeneration() {
+    if (g_generation != 0) return;
+    g_generation = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    g_deltaFloor = g_generation;
+}
+
+void pruneTombstones() {
+    while (g_tombstones > MAX_PRINTER_TOMBSTONES) {
+        auto oldest = g_entries.end();
+        for (auto it = g_entries.begin(); it != g_entries.end(); ++it) {
+            if (it->second.removed &&
+                (oldest == g_entries.end() || it->second.modifiedGeneration < oldest->second.modifiedGeneration)) {
+                oldest = it;
+            }
+        }
+        if (oldest == g_entries.end()) break;
+
+        if (oldest->second.modifiedGeneration > g_deltaFloor) {
+            g_deltaFloor = oldest->second.modifiedGeneration;
+        }
+        g_entries.erase(oldest);
+        g_tombstones--;
+    }
+}
+
+} // namespace
+
+// Record a fresh enumeration and return the resulting generation
+uint64_t applyPrinterSnapshot(const std::vector<PrinterInfo>& printers) {
+    std::lock_guard<std::mutex> lock(g_snapshotMutex);
+    initGeneration();
+
+    uint64_t next = g_generation + 1;
+    bool changed = false;
+
+    std::map<std::string, const PrinterInfo*> current;
+    for (const auto& printer : printers) {
+        current[printer.name] = &printer;
+    }
+
+    for (const auto& entry : current) {
+        const PrinterInfo& printer = *entry.second;
+        auto it = g_entries.find(entry.first);
+
+        if (it == g_entries.end() || it->second.removed) {
+            if (it != g_entries.end()) g_tombstones--;
+            g_entries[entry.first] = SnapshotEntry{ printer, next, next, false };
+            changed = true;
+        } else if (!samePrinter(it->second.info, printer)) {
+            it->second.info = printer;
+            it->second.modifiedGeneration = next;
+            changed = true;
+        }
+    }
+
+    for (auto& entry : g_entries) {
+        if (!entry.second.removed && current.find(entry.first) == current.end()) {
+            entry.second.removed = true;
+            entry.second.modifiedGeneration = next;
+            g_tombstones++;
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        g_generation = next;
+        pruneTombstones();
+    }
+    return g_generation;
+}
+
+// Everything that changed after generation `since`. Unknown or expired
+// generations get the full list with delta.full set.
+void printerDeltaSince(uint64_t since, PrinterDelta& delta) {
+    std::lock_guard<std::mutex> lock(g_snapshotMutex);
+    initGeneration();
+
+    delta.generation = g_generation;
+    delta.full = since < g_deltaFloor || since > g_generation;
+    delta.added.clear();
+    delta.changed.clear();
+    delta.removed.clear();
+
+    for (const auto& entry : g_entries) {
+        const SnapshotEntry& e = entry.second;
+        if (delta.full) {
+            if (!e.removed) delta.added.push_back(e.info);
+            continue;
+        }
+        if (e.modifiedGeneration <= since) continue;
+
+        if (e.removed) {
+            // Added and removed since the caller last looked: never seen
+            if (e.addedGeneration <= since) delta.removed.push_back(e.info);
+        } else if (e.addedGeneration > since) {
+            delta.added.push_back(e.info);
+        } else {
+            delta.changed.push_back(e.info);
+        }
+    }
+}
@@ -0,0 +1,455 @@
+#include "common.h"
+#include <atomic>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <intrin.h>
+#endif
+
+// ============================================================================
+// Latency metrics
+// ============================================================================
+//
+// Stage timings and per-printer counters for getStats(). Recording is a
+// handful of relaxed atomic increments into fixed tables, with no locks or
+// allocation, so it stays on in production. Histograms are log-linear over
+// microseconds: four buckets per power of two, so a reported percentile is
+// within a bucket (about 25%) of the true value. Printers get a slot in a
+// fixed open-addressing table the first time they are seen; once it is full,
+// further printers share one overflow slot.
+
+static const int SUB_BUCKETS_PER_OCTAVE = 4;
+static const int HISTOGRAM_BUCKETS = 128;       // Up to 2^32 us, about 71 minutes
+static const size_t MAX_TRACKED_PRINTERS = 128;
+static const int FIRST_ERROR_CODE = PRINTER_INVALID_ARGUMENT;
+static const int ERROR_CODE_SLOTS = 32;
+static const char* const OVERFLOW_PRINTER_NAME = "(other)";
+
+// Prometheus buckets: every power of two from 16 us to about 33 s
+static const int FIRST_EXPORTED_OCTAVE = 4;
+static const int LAST_EXPORTED_OCTAVE = 25;
+
+static const char* const STAGE_NAMES[STAGE_COUNT] = {
+    "validate", "queueWait", "lookup", "spoolFile", "submit", "completion", "enumerate", "marshal"
+};
+
+namespace {
+
+struct LatencyHistogram {
+    std::atomic<uint64_t> buckets[HISTOGRAM_BUCKETS];
+    std::atomic<uint64_t> sumMicros;
+    std::atomic<uint64_t> maxMicros;
+};
+
+enum SlotState {
+    SLOT_FREE = 0,
+    SLOT_CLAIMED,  // Name being written
+    SLOT_READY
+};
+
+struct PrinterStats {
+    std::atomic<uint64_t> hash;
+    std::atomic<int> state;
+    char name[MAX_PRINTER_NAME_LENGTH + 1];
+    std::atomic<uint64_t> requests;
+    std::atomic<uint64_t> errors[ERROR_CODE_SLOTS];
+    LatencyHistogram latency;
+};
+
+// A plain snapshot of a histogram, read without stopping writers
+struct HistogramSnapshot {
+    uint64_t buckets[HISTOGRAM_BUCKETS];
+    uint64_t count;
+    uint64_t sumMicros;
+    uint64_t maxMicros;
+};
+
+// Static storage: zero-initialised, never destroyed while detached workers run
+LatencyHistogram g_stages[STAGE_COUNT];
+PrinterStats g_printers[MAX_TRACKED_PRINTERS];
+PrinterStats g_overflowPrinter;
+std::atomic<int64_t> g_windowStartMicros(
+    std::chrono::duration_cast<std::chrono::microseconds>(StatsClock::now().time_since_epoch()).count());
+
+int highestBit(uint64_t value) {
+#if defined(_WIN32) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<int>(index);
+#elif defined(_WIN32)
+    // 32-bit MSVC only has the 32-bit scan
+    unsigned long index;
+    if (_BitScanReverse(&index, static_cast<unsigned long>(value >> 32))) return static_cast<int>(index) + 32;
+    _BitScanReverse(&index, static_cast<unsigned long>(value));
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+int bucketFor(uint64_t micros) {
+    if (micros < SUB_BUCKETS_PER_OCTAVE) return static_cast<int>(micros);
+    int octave = highestBit(micros);
+    int sub = static_cast<int>((micros >> (octave - 2)) & 3);
+    int index = (octave - 1) * SUB_BUCKETS_PER_OCTAVE + sub;
+    return index < HISTOGRAM_BUCKETS ? index : HISTOGRAM_BUCKETS - 1;
+}
+
+// Exclusive upper bound of a bucket, in microseconds
+uint64_t bucketLimit(int index) {
+    if (index < SUB_BUCKETS_PER_OCTAVE) return static_cast<uint64_t>(index) + 1;
+    int octave = index / SUB_BUCKETS_PER_OCTAVE + 1;
+    int sub = index % SUB_BUCKETS_PER_OCTAVE;
+    return static_cast<uint64_t>(5 + sub) << (octave - 2);
+}
+
+void record(LatencyHistogram& histogram, uint64_t micros) {
+    histogram.buckets[bucketFor(micros)].fetch_add(1, std::memory_order_relaxed);
+    histogram.sumMicros.fetch_add(micros, std::memory_order_relaxed);
+
+    uint64_t seen = histogram.maxMicros.load(std::memory_order_relaxed);
+    while (micros > seen &&
+           !histogram.maxMicros.compare_exchange_weak(seen, micros, std::memory_order_relaxed)) {
+    }
+}
+
+void clear(LatencyHistogram& histogram) {
+    for (auto& bucket : histogram.buckets) bucket.store(0, std::memory_order_relaxed);
+    histogram.sumMicros.store(0, std::memory_order_relaxed);
+    histogram.maxMicros.store(0, std::memory_order_relaxed);
+}
+
+void snapshot(const LatencyHistogram& histogram, HistogramSnapshot& out) {
+    out.count = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        out.buckets[i] = histogram.buckets[i].load(std::memory_order_relaxed);
+        out.count += out.buckets[i];
+    }
+    out.sumMicros = histogram.sumMicros.load(std::memory_order_relaxed);
+    out.maxMicros = histogram.maxMicros.load(std::memory_order_relaxed);
+}
+
+uint64_t microsSince(StatsClock::time_point start) {
+    int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(StatsClock::now() - start).count();
+    return micros > 0 ? static_cast<uint64_t>(micros) : 0;
+}
+
+// FNV-1a; never 0, which marks a free slot
+uint64_t hashName(const char* name, size_t length) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<unsigned char>(name[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+PrinterStats& printerSlot(const std::string& printerName) {
+    const char* name = printerName.c_str();
+    size_t length = printerName.size() < MAX_PRINTER_NAME_LENGTH ? printerName.size() : MAX_PRINTER_NAME_LENGTH;
+    uint64_t hash = hashName(name, length);
+
+    for (size_t probe = 0; probe < MAX_TRACKED_PRINTERS; probe++) {
+        PrinterStats& slot = g_printers[(hash + probe) % MAX_TRACKED_PRINTERS];
+        uint64_t current = slot.hash.load(std::memory_order_acquire);
+
+        if (current == 0) {
+            if (slot.hash.compare_exchange_strong(current, hash, std::memory_order_acq_rel)) {
+                slot.state.store(SLOT_CLAIMED, std::memory_order_relaxed);
+                std::memcpy(slot.name, name, length);
+                slot.name[length] = '\0';
+                slot.state.store(SLOT_READY, std::memory_order_release);
+                return slot;
+            }
+            // Lost the race; current now holds the winner's hash
+        }
+        if (current != hash) continue;
+
+        // The claiming thread is only copying the name
+        while (slot.state.load(std::memory_order_acquire) != SLOT_READY) {
+        }
+        if (std::strncmp(slot.name, name, length) == 0 && slot.name[length] == '\0') return slot;
+    }
+    return g_overflowPrinter;
+}
+
+// ----------------------------------------------------------------------------
+// getStats() object
+// ----------------------------------------------------------------------------
+
+// Upper bound of the bucket holding the q-th quantile, capped at the maximum
+double percentileMs(const HistogramSnapshot& histogram, double q) {
+    if (histogram.count == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(histogram.count) + 0.5);
+    if (rank < 1) rank = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += histogram.buckets[i];
+        if (seen >= rank) {
+            uint64_t limit = bucketLimit(i);
+            return static_cast<double>(limit < histogram.maxMicros ? limit : histogram.maxMicros) / 1000.0;
+        }
+    }
+    return static_cast<double>(histogram.maxMicros) / 1000.0;
+}
+
+void setNumber(napi_env env, napi_value object, const char* key, double number) {
+    napi_value value;
+    napi_create_double(env, number, &value);
+    napi_set_named_property(env, object, key, value);
+}
+
+napi_value HistogramToObject(napi_env env, const LatencyHistogram& histogram) {
+    HistogramSnapshot snap;
+    snapshot(histogram, snap);
+
+    napi_value object;
+    napi_create_object(env, &object);
+    setNumber(env, object, "count", static_cast<double>(snap.count));
+    setNumber(env, object, "meanMs", snap.count ? static_cast<double>(snap.sumMicros) / snap.count / 1000.0 : 0);
+    setNumber(env, object, "p50Ms", percentileMs(snap, 0.50));
+    setNumber(env, object, "p90Ms", percentileMs(snap, 0.90));
+    setNumber(env, object, "p99Ms", percentileMs(snap, 0.99));
+    setNumber(env, object, "maxMs", static_cast<double>(snap.maxMicros) / 1000.0);
+    return object;
+}
+
+napi_value PrinterStatsToObject(napi_env env, const PrinterStats& printer, uint64_t* errorTotals) {
+    napi_value object, errors;
+    napi_create_object(env, &object);
+    napi_create_object(env, &errors);
+
+    uint64_t failures = 0;
+    for (int i = 0; i < ERROR_CODE_SLOTS; i++) {
+        uint64_t count = printer.errors[i].load(std::memory_order_relaxed);
+        if (count == 0) continue;
+        failures += count;
+        errorTotals[i] += count;
+        setNumber(env, errors, std::to_string(FIRST_ERROR_CODE + i).c_str(), static_cast<double>(count));
+    }
+
+    setNumber(env, object, "requests", static_cast<double>(printer.requests.load(std::memory_order_relaxed)));
+    setNumber(env, object, "failures", static_cast<double>(failures));
+    napi_set_named_property(env, object, "errors", errors);
+    napi_set_named_property(env, object, "latency", HistogramToObject(env, printer.latency));
+    return object;
+}
+
+double windowMs() {
+    int64_t now = std::chrono::duration_cast<std::chrono::microseconds>(StatsClock::now().time_since_epoch()).count();
+    return static_cast<double>(now - g_windowStartMicros.load(std::memory_order_relaxed)) / 1000.0;
+}
+
+napi_value StatsToObject(napi_env env) {
+    napi_value stats, stages, printers, errors;
+    napi_create_object(env, &stats);
+    napi_create_object(env, &stages);
+    napi_create_object(env, &printers);
+    napi_create_object(env, &errors);
+
+    setNumber(env, stats, "windowMs", windowMs());
+
+    for (int stage = 0; stage < STAGE_COUNT; stage++) {
+        napi_set_named_property(env, stages, STAGE_NAMES[stage], HistogramToObject(env, g_stages[stage]));
+    }
+
+    uint64_t errorTotals[ERROR_CODE_SLOTS] = {};
+    for (const auto& printer : g_printers) {
+        if (printer.state.load(std::memory_order_acquire) != SLOT_READY) continue;
+        napi_set_named_property(env, printers, printer.name, PrinterStatsToObject(env, printer, errorTotals));
+    }
+    if (g_overflowPrinter.requests.load(std::memory_order_relaxed) != 0) {
+        napi_set_named_property(env, printers, OVERFLOW_PRINTER_NAME,
+                                PrinterStatsToObject(env, g_overflowPrinter, errorTotals));
+    }
+
+    for (int i = 0; i < ERROR_CODE_SLOTS; i++) {
+        if (errorTotals[i] == 0) continue;
+        setNumber(env, errors, std::to_string(FIRST_ERROR_CODE + i).c_str(), static_cast<double>(errorTotals[i]));
+    }
+
+    napi_set_named_property(env, stats, "stages", stages);
+    napi_set_named_property(env, stats, "printers", printers);
+    napi_set_named_property(env, stats, "errors", errors);
+    return stats;
+}
+
+// ----------------------------------------------------------------------------
+// Prometheus text format
+// ----------------------------------------------------------------------------
+
+std::string labelValue(const char* value) {
+    std::string escaped;
+    for (const char* c = value; *c != '\0'; c++) {
+        if (*c == '\\') escaped += "\\\\";
+        else if (*c == '"') escaped += "\\\"";
+        else if (*c == '\n') escaped += "\\n";
+        else escaped += *c;
+    }
+    return escaped;
+}
+
+std::string formatSeconds(uint64_t micros) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.6f", static_cast<double>(micros) / 1e6);
+    return buffer;
+}
+
+// One histogram series; labels are "key=\"value\"" pairs without braces
+void appendHistogram(std::string& out, const char* metric, const std::string& labels,
+                     const LatencyHistogram& histogram) {
+    HistogramSnapshot snap;
+    snapshot(histogram, snap);
+
+    std::string prefix = labels.empty() ? "" : labels + ",";
+    uint64_t cumulative = 0;
+    int bucket = 0;
+    for (int octave = FIRST_EXPORTED_OCTAVE; octave <= LAST_EXPORTED_OCTAVE; octave++) {
+        uint64_t limit = static_cast<uint64_t>(1) << octave;
+        for (; bucket < HISTOGRAM_BUCKETS && bucketLimit(bucket) <= limit; bucket++) {
+            cumulative += snap.buckets[bucket];
+        }
+        out += std::string(metric) + "_bucket{" + prefix + "le=\"" + formatSeconds(limit) + "\"} " +
+               std::to_string(cumulative) + "\n";
+    }
+    out += std::string(metric) + "_bucket{" + prefix + "le=\"+Inf\"} " + std::to_string(snap.count) + "\n";
+
+    std::string braced = labels.empty() ? "" : "{" + labels + "}";
+    out += std::string(metric) + "_sum" + braced + " " + formatSeconds(snap.sumMicros) + "\n";
+    out += std::string(metric) + "_count" + braced + " " + std::to_string(snap.count) + "\n";
+}
+
+void appendPrinter(std::string& out, const PrinterStats& printer, const char* name, int section) {
+    std::string label = "printer=\"" + labelValue(name) + "\"";
+    if (section == 0) {
+        out += "cashdrawer_printer_requests_total{" + label + "} " +
+               std::to_string(printer.requests.load(std::memory_order_relaxed)) + "\n";
+    } else if (section == 1) {
+        for (int i = 0; i < ERROR_CODE_SLOTS; i++) {
+            uint64_t count = printer.errors[i].load(std::memory_order_relaxed);
+            if (count == 0) continue;
+            out += "cashdrawer_printer_errors_total{" + label + ",code=\"" +
+                   std::to_string(FIRST_ERROR_CODE + i) + "\"} " + std::to_string(count) + "\n";
+        }
+    } else {
+        appendHistogram(out, "cashdrawer_printer_duration_seconds", label, printer.latency);
+    }
+}
+
+std::string StatsToPrometheus() {
+    std::string out;
+    out += "# HELP cashdrawer_stage_duration_seconds Time spent in each stage of drawer and printer operations.\n";
+    out += "# TYPE cashdrawer_stage_duration_seconds histogram\n";
+    for (int stage = 0; stage < STAGE_COUNT; stage++) {
+        appendHistogram(out, "cashdrawer_stage_duration_seconds",
+                        std::string("stage=\"") + STAGE_NAMES[stage] + "\"", g_stages[stage]);
+    }
+
+    static const char* const HEADERS[3] = {
+        "# HELP cashdrawer_printer_requests_total Drawer kicks and raw jobs sent to each printer.\n"
+        "# TYPE cashdrawer_printer_requests_total counter\n",
+        "# HELP cashdrawer_printer_errors_total Failed requests by printer and PrinterErrorCodes value.\n"
+        "# TYPE cashdrawer_printer_errors_total counter\n",
+        "# HELP cashdrawer_printer_duration_seconds End-to-end time of each request, from validation to result.\n"
+        "# TYPE cashdrawer_printer_duration_seconds histogram\n"
+    };
+    for (int section = 0; section < 3; section++) {
+        out += HEADERS[section];
+        for (const auto& printer : g_printers) {
+            if (printer.state.load(std::memory_order_acquire) == SLOT_READY) {
+                appendPrinter(out, printer, printer.name, section);
+            }
+        }
+        if (g_overflowPrinter.requests.load(std::memory_order_relaxed) != 0) {
+            appendPrinter(out, g_overflowPrinter, OVERFLOW_PRINTER_NAME, section);
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+void recordStage(StatStage stage, StatsClock::time_point start) {
+    record(g_stages[stage], microsSince(start));
+
+    // Queue wait and completion start on one thread and end on another
+    if (traceEnabled()) {
+        bool crossesThreads = stage == STAGE_QUEUE_WAIT || stage == STAGE_COMPLETION;
+        traceEvent(STAGE_NAMES[stage], crossesThreads ? TRACE_ASYNC : TRACE_SPAN, start, StatsClock::now());
+    }
+}
+
+// One drawer kick or raw job, from validation to its result
+void recordPrinterResult(const std::string& printerName, const OperationResult& result,
+                         StatsClock::time_point start) {
+    PrinterStats& printer = printerSlot(printerName);
+    printer.requests.fetch_add(1, std::memory_order_relaxed);
+    record(printer.latency, microsSince(start));
+
+    if (!result.success) {
+        int slot = result.errorCode - FIRST_ERROR_CODE;
+        if (slot < 0 || slot >= ERROR_CODE_SLOTS) slot = PRINTER_OTHER_ERROR - FIRST_ERROR_CODE;
+        printer.errors[slot].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// ============================================================================
+// Exported N-API functions
+// ============================================================================
+
+// getStats() -> { windowMs, stages, printers, errors }
+// getStats({ format: "prometheus" }) -> text exposition format
+napi_value GetStats(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    std::string format;
+    bool present = false;
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) napi_typeof(env, args[0], &type);
+    if (type == napi_object && !GetOptionalStringProperty(env, args[0], "format", format, present)) {
+        napi_throw_type_error(env, nullptr, "format must be a string");
+        return nullptr;
+    }
+    if (present && format != "object" && format != "prometheus") {
+        napi_throw_type_error(env, nullptr, "format must be \"object\" or \"prometheus\"");
+        return nullptr;
+    }
+
+    if (format == "prometheus") {
+        std::string text = StatsToPrometheus();
+        napi_value result;
+        NAPI_CALL(env, napi_create_string_utf8(env, text.c_str(), text.size(), &result));
+        return result;
+    }
+    return StatsToObject(env);
+}
+
+// resetStats() clears every histogram and counter. Printers keep their slots.
+napi_value ResetStats(napi_env env, napi_callback_info info) {
+    for (auto& stage : g_stages) clear(stage);
+
+    PrinterStats* printers[MAX_TRACKED_PRINTERS + 1];
+    for (size_t i = 0; i < MAX_TRACKED_PRINTERS; i++) printers[i] = &g_printers[i];
+    printers[MAX_TRACKED_PRINTERS] = &g_overflowPrinter;
+    for (PrinterStats* printer : printers) {
+        printer->requests.store(0, std::memory_order_relaxed);
+        for (auto& count : printer->errors) count.store(0, std::memory_order_relaxed);
+        clear(printer->latency);
+    }
+
+    g_windowStartMicros.store(
+        std::chrono::duration_cast<std::chrono::microseconds>(StatsClock::now().time_since_epoch()).count(),
+        std::memory_order_relaxed);
+
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    return undefined;
+}
@@ -0,0 +1,322 @@
+#include "common.h"
+#include <atomic>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#endif
+
+// ============================================================================
+// Chrome trace events
+// ============================================================================
+//
+// startTrace() turns on recording of every stage of every operation into a
+// fixed ring buffer, which dumpTrace() renders as Chrome trace JSON for
+// Perfetto or chrome://tracing. Work on one thread (execute, lookup,
+// submit, CUPS calls) becomes complete ("X") events on that thread's track.
+// Stages that cross threads, such as queue wait and completion, and the
+// operations themselves become async ("b"/"e") events keyed by operation
+// id, so a kick can be followed from the JS call through its worker and back.
+//
+// Writers claim a slot with one atomic increment and publish it with a
+// per-slot sequence number (a seqlock), so recording never blocks; a full
+// ring overwrites its oldest events. dumpTrace() skips any slot that
+// changed while it was being read. While tracing is off, recording is one
+// relaxed load.
+
+static const size_t DEFAULT_TRACE_BUFFER_EVENTS = 16384;
+static const size_t MIN_TRACE_BUFFER_EVENTS = 256;
+static const size_t MAX_TRACE_BUFFER_EVENTS = 1 << 20;
+static const size_t LABEL_WORDS = 6;  // Printer names are cut to 47 bytes
+static const char* const TRACE_CATEGORY = "cashdrawer";
+
+namespace {
+
+struct TraceSlot {
+    std::atomic<uint64_t> sequence;  // 2 * index + 1 while written, 2 * index + 2 once published
+    std::atomic<const char*> name;
+    std::atomic<int> phase;
+    std::atomic<uint32_t> thread;
+    std::atomic<uint64_t> operation;
+    std::atomic<int64_t> startNanos;
+    std::atomic<int64_t> endNanos;
+    std::atomic<uint64_t> label[LABEL_WORDS];
+};
+
+struct TraceRing {
+    TraceSlot* slots;
+    size_t mask;
+};
+
+// A plain copy of one published event
+struct TraceRecord {
+    const char* name;
+    int phase;
+    uint32_t thread;
+    uint64_t operation;
+    int64_t startNanos;
+    int64_t endNanos;
+    char label[LABEL_WORDS * sizeof(uint64_t)];
+};
+
+std::atomic<bool> g_traceEnabled(false);
+std::atomic<TraceRing*> g_traceRing(nullptr);
+std::atomic<uint64_t> g_traceHead(0);        // Next slot index, never reset
+std::atomic<uint64_t> g_traceStart(0);       // Head when the current trace started
+std::atomic<uint64_t> g_nextOperation(1);
+std::atomic<uint32_t> g_nextThread(1);
+std::atomic<uint32_t> g_jsThread(0);
+
+thread_local uint32_t t_threadId = 0;
+thread_local TraceContext t_context = { 0, nullptr };
+
+uint32_t currentThreadId() {
+    if (t_threadId == 0) t_threadId = g_nextThread.fetch_add(1, std::memory_order_relaxed);
+    return t_threadId;
+}
+
+int64_t nanosOf(StatsClock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+// Allocated once and only replaced by a larger ring; a replaced ring is
+// leaked because a worker may still be writing its last event into it
+TraceRing* ensureRing(size_t capacity) {
+    TraceRing* ring = g_traceRing.load(std::memory_order_acquire);
+    if (ring != nullptr && ring->mask + 1 >= capacity) return ring;
+
+    TraceRing* grown = new TraceRing();
+    grown->slots = new TraceSlot[capacity]();
+    grown->mask = capacity - 1;
+    g_traceRing.store(grown, std::memory_order_release);
+    return grown;
+}
+
+bool readSlot(const TraceSlot& slot, uint64_t index, TraceRecord& out) {
+    uint64_t published = 2 * index + 2;
+    if (slot.sequence.load(std::memory_order_acquire) != published) return false;
+
+    out.name = slot.name.load(std::memory_order_relaxed);
+    out.phase = slot.phase.load(std::memory_order_relaxed);
+    out.thread = slot.thread.load(std::memory_order_relaxed);
+    out.operation = slot.operation.load(std::memory_order_relaxed);
+    out.startNanos = slot.startNanos.load(std::memory_order_relaxed);
+    out.endNanos = slot.endNanos.load(std::memory_order_relaxed);
+    uint64_t words[LABEL_WORDS];
+    for (size_t i = 0; i < LABEL_WORDS; i++) words[i] = slot.label[i].load(std::memory_order_relaxed);
+    memcpy(out.label, words, sizeof(out.label));
+    out.label[sizeof(out.label) - 1] = '\0';
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == published;
+}
+
+// ----------------------------------------------------------------------------
+// Chrome trace JSON
+// ----------------------------------------------------------------------------
+
+void appendJsonString(std::string& out, const char* value) {
+    out += '"';
+    for (const char* c = value; *c != '\0'; c++) {
+        unsigned char ch = static_cast<unsigned char>(*c);
+        if (ch == '\\') out += "\\\\";
+        else if (ch == '"') out += "\\\"";
+        else if (ch < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+            out += escaped;
+        } else {
+            out += *c;
+        }
+    }
+    out += '"';
+}
+
+void appendEvent(std::string& out, const TraceRecord& record, const char* phase, int64_t nanos, bool withArgs) {
+    char buffer[160];
+    out += out.empty() ? "{\"name\":" : ",\n{\"name\":";
+    appendJsonString(out, record.name);
+    snprintf(buffer, sizeof(buffer), ",\"cat\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":%d,\"tid\":%u",
+             TRACE_CATEGORY, phase, static_cast<double>(nanos) / 1e3, static_cast<int>(getpid()), record.thread);
+    out += buffer;
+
+    if (record.phase == TRACE_SPAN) {
+        snprintf(buffer, sizeof(buffer), ",\"dur\":%.3f",
+                 static_cast<double>(record.endNanos - record.startNanos) / 1e3);
+        out += buffer;
+    } else {
+        snprintf(buffer, sizeof(buffer), ",\"id\":\"0x%llx\"", static_cast<unsigned long long>(record.operation));
+        out += buffer;
+    }
+
+    if (withArgs && (record.operation != 0 || record.label[0] != '\0')) {
+        out += ",\"args\":{";
+        if (record.operation != 0) {
+            snprintf(buffer, sizeof(buffer), "\"operation\":%llu", static_cast<unsigned long long>(record.operation));
+            out += buffer;
+        }
+        if (record.label[0] != '\0') {
+            out += record.operation != 0 ? ",\"printer\":" : "\"printer\":";
+            appendJsonString(out, record.label);
+        }
+        out += '}';
+    }
+    out += '}';
+}
+
+std::string TraceToJson() {
+    std::string events;
+    TraceRing* ring = g_traceRing.load(std::memory_order_acquire);
+    uint64_t overwritten = 0;
+
+    if (ring != nullptr) {
+        uint64_t head = g_traceHead.load(std::memory_order_acquire);
+        uint64_t first = g_traceStart.load(std::memory_order_relaxed);
+        if (head - first > ring->mask + 1) {
+            overwritten = head - first - (ring->mask + 1);
+            first = head - (ring->mask + 1);
+        }
+
+        TraceRecord record;
+        for (uint64_t index = first; index < head; index++) {
+            if (!readSlot(ring->slots[index & ring->mask], index, record)) continue;
+            if (record.phase == TRACE_SPAN) {
+                appendEvent(events, record, "X", record.startNanos, true);
+            } else {
+                appendEvent(events, record, "b", record.startNanos, true);
+                appendEvent(events, record, "e", record.endNanos, false);
+            }
+        }
+    }
+
+    uint32_t jsThread = g_jsThread.load(std::memory_order_relaxed);
+    if (jsThread != 0) {
+        char buffer[160];
+        snprintf(buffer, sizeof(buffer),
+                 "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"JavaScript\"}}",
+                 static_cast<int>(getpid()), jsThread);
+        if (!events.empty()) events += ",\n";
+        events += buffer;
+    }
+
+    char footer[96];
+    snprintf(footer, sizeof(footer), "],\n\"displayTimeUnit\":\"ms\",\"otherData\":{\"overwrittenEvents\":%llu}}",
+             static_cast<unsigned long long>(overwritten));
+    return "{\"traceEvents\":[\n" + events + footer;
+}
+
+} // namespace
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+bool traceEnabled() {
+    return g_traceEnabled.load(std::memory_order_relaxed);
+}
+
+// A fresh id for an operation's async events; 0 (untraced) while tracing is off
+uint64_t beginTraceOperation() {
+    if (!traceEnabled()) return 0;
+    return g_nextOperation.fetch_add(1, std::memory_order_relaxed);
+}
+
+TraceContext swapTraceContext(TraceContext context) {
+    TraceContext previous = t_context;
+    t_context = context;
+    return previous;
+}
+
+// Records one event for the operation and printer of this thread's context.
+// name must be a string literal. Async events need an operation to pair on.
+void traceEvent(const char* name, TracePhase phase, StatsClock::time_point start, StatsClock::time_point end) {
+    if (!traceEnabled()) return;
+    if (phase == TRACE_ASYNC && t_context.operation == 0) return;
+    TraceRing* ring = g_traceRing.load(std::memory_order_acquire);
+    if (ring == nullptr) return;
+
+    uint64_t words[LABEL_WORDS] = {};
+    if (t_context.label != nullptr) {
+        size_t length = strnlen(t_context.label, sizeof(words) - 1);
+        memcpy(words, t_context.label, length);
+    }
+
+    uint64_t index = g_traceHead.fetch_add(1, std::memory_order_relaxed);
+    TraceSlot& slot = ring->slots[index & ring->mask];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.phase.store(phase, std::memory_order_relaxed);
+    slot.thread.store(currentThreadId(), std::memory_order_relaxed);
+    slot.operation.store(t_context.operation, std::memory_order_relaxed);
+    slot.startNanos.store(nanosOf(start), std::memory_order_relaxed);
+    slot.endNanos.store(nanosOf(end), std::memory_order_relaxed);
+    for (size_t i = 0; i < LABEL_WORDS; i++) slot.label[i].store(words[i], std::memory_order_relaxed);
+
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+// ============================================================================
+// Exported N-API functions
+// ============================================================================
+
+// startTrace({ bufferSize }) clears the buffer and starts recording
+napi_value StartTrace(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    double requested = static_cast<double>(DEFAULT_TRACE_BUFFER_EVENTS);
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) napi_typeof(env, args[0], &type);
+    if (type == napi_object) {
+        bool has_property;
+        napi_has_named_property(env, args[0], "bufferSize", &has_property);
+        if (has_property) {
+            napi_value value;
+            napi_get_named_property(env, args[0], "bufferSize", &value);
+            if (napi_get_value_double(env, value, &requested) != napi_ok ||
+                !(requested >= MIN_TRACE_BUFFER_EVENTS) || requested > MAX_TRACE_BUFFER_EVENTS) {
+                napi_throw_range_error(env, nullptr, "bufferSize must be between 256 and 1048576 events");
+                return nullptr;
+            }
+        }
+    } else if (type != napi_undefined) {
+        napi_throw_type_error(env, nullptr, "Options must be an object");
+        return nullptr;
+    }
+
+    size_t capacity = MIN_TRACE_BUFFER_EVENTS;
+    while (capacity < requested) capacity <<= 1;
+
+    g_traceEnabled.store(false, std::memory_order_relaxed);
+    ensureRing(capacity);
+    g_traceStart.store(g_traceHead.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    g_jsThread.store(currentThreadId(), std::memory_order_relaxed);
+    g_traceEnabled.store(true, std::memory_order_release);
+
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    return undefined;
+}
+
+// stopTrace() stops recording; the buffer is kept for dumpTrace()
+napi_value StopTrace(napi_env env, napi_callback_info info) {
+    g_traceEnabled.store(false, std::memory_order_relaxed);
+
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    return undefined;
+}
+
+// dumpTrace() -> Chrome trace JSON of the events still in the buffer
+napi_value DumpTrace(napi_env env, napi_callback_info info) {
+    std::string json = TraceToJson();
+
+    napi_value result;
+    NAPI_CALL(env, napi_create_string_utf8(env, json.c_str(), json.size(), &result));
+    return result;
+}
@@ -0,0 +1,746 @@
+#include "common.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <climits>
+#include <termios.h>
+#endif
+
+// ============================================================================
+// Direct raw TCP transport (port 9100)
+// ============================================================================
+//
+// Sends ESC/POS bytes straight to a network printer instead of through
+// cupsd and its socket backend. Connections are kept alive in a small
+// per-endpoint pool so a warm kick is a single send(). Receipt printers
+// usually accept only one connection at a time, so idle sockets are closed
+// by a reaper thread once their keep-alive expires rather than being held
+// for the life of the process.
+
+#ifndef _WIN32
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+
+static const size_t MAX_IDLE_PER_ENDPOINT = 2;
+
+struct IdleSocket {
+    int fd;
+    Clock::time_point expiresAt;
+};
+
+// Intentionally leaked: the detached reaper thread still waits on these while
+// static destructors run at exit, and destroying a waited-on condition
+// variable blocks.
+std::mutex& g_poolMutex = *new std::mutex();
+std::condition_variable& g_reaperCond = *new std::condition_variable();
+std::unordered_map<std::string, std::vector<IdleSocket>>& g_idleSockets =
+    *new std::unordered_map<std::string, std::vector<IdleSocket>>();
+bool g_reaperStarted = false;
+
+int64_t millisUntil(Clock::time_point deadline) {
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+    return remaining > 0 ? remaining : 0;
+}
+
+std::string endpointKey(const TcpEndpoint& endpoint) {
+    return endpoint.host + ":" + std::to_string(endpoint.port);
+}
+
+// Closes idle sockets whose keep-alive has expired
+void reaperLoop() {
+    std::unique_lock<std::mutex> lock(g_poolMutex);
+    for (;;) {
+        Clock::time_point now = Clock::now();
+        Clock::time_point next = Clock::time_point::max();
+
+        for (auto it = g_idleSockets.begin(); it != g_idleSockets.end();) {
+            std::vector<IdleSocket>& sockets = it->second;
+            for (size_t i = 0; i < sockets.size();) {
+                if (sockets[i].expiresAt <= now) {
+                    close(sockets[i].fd);
+                    sockets.erase(sockets.begin() + i);
+                } else {
+                    if (sockets[i].expiresAt < next) next = sockets[i].expiresAt;
+                    i++;
+                }
+            }
+            it = sockets.empty() ? g_idleSockets.erase(it) : std::next(it);
+        }
+
+        if (next == Clock::time_point::max()) {
+            g_reaperCond.wait(lock);
+        } else {
+            g_reaperCond.wait_until(lock, next);
+        }
+    }
+}
+
+// A pooled socket is only reusable if the peer has not closed it. Any
+// unsolicited bytes (e.g. automatic status back) are discarded.
+bool isSocketAlive(int fd) {
+    for (;;) {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        int ready = poll(&pfd, 1, 0);
+        if (ready == 0) return true;
+        if (ready < 0) return errno == EINTR;
+        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) return false;
+
+        char discard[64];
+        ssize_t n = recv(fd, discard, sizeof(discard), MSG_DONTWAIT);
+        if (n == 0) return false;
+        if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+}
+
+int takeIdleSocket(const std::string& key) {
+    std::lock_guard<std::mutex> lock(g_poolMutex);
+    auto it = g_idleSockets.find(key);
+    if (it == g_idleSockets.end()) return -1;
+
+    std::vector<IdleSocket>& sockets = it->second;
+    while (!sockets.empty()) {
+        IdleSocket idle = sockets.back();
+        sockets.pop_back();
+        if (idle.expiresAt > Clock::now() && isSocketAlive(idle.fd)) {
+            return idle.fd;
+        }
+        close(idle.fd);
+    }
+    return -1;
+}
+
+void returnIdleSocket(const std::string& key, int fd, int keepAliveMs) {
+    if (keepAliveMs <= 0) {
+        close(fd);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(g_poolMutex);
+    std::vector<IdleSocket>& sockets = g_idleSockets[key];
+    if (sockets.size() >= MAX_IDLE_PER_ENDPOINT) {
+        close(fd);
+        return;
+    }
+
+    IdleSocket idle;
+    idle.fd = fd;
+    idle.expiresAt = Clock::now() + std::chrono::milliseconds(keepAliveMs);
+    sockets.push_back(idle);
+
+    if (!g_reaperStarted) {
+        g_reaperStarted = true;
+        std::thread(reaperLoop).detach();
+    }
+    g_reaperCond.notify_one();
+}
+
+struct ResolvedEndpoint {
+    std::vector<ResolvedAddress> addresses;
+    Clock::time_point expiresAt;
+};
+
+static const int RESOLVE_CACHE_TTL_MS = 5 * 60 * 1000;
+
+std::mutex& g_resolveMutex = *new std::mutex();
+std::unordered_map<std::string, ResolvedEndpoint>& g_resolved =
+    *new std::unordered_map<std::string, ResolvedEndpoint>();
+
+// getaddrinfo() has no timeout of its own, so an endpoint is resolved once
+// and its addresses reused until they expire or stop accepting connections.
+// Only the first kick to a slow-resolving host pays for the lookup.
+bool resolveEndpoint(const TcpEndpoint& endpoint, std::vector<ResolvedAddress>& addresses, std::string& error) {
+    std::string key = endpointKey(endpoint);
+    {
+        std::lock_guard<std::mutex> lock(g_resolveMutex);
+        auto it = g_resolved.find(key);
+        if (it != g_resolved.end() && it->second.expiresAt > Clock::now()) {
+            addresses = it->second.addresses;
+            return true;
+        }
+    }
+
+    struct addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo* list = nullptr;
+    std::string service = std::to_string(endpoint.port);
+    int gai = getaddrinfo(endpoint.host.c_str(), service.c_str(), &hints, &list);
+    if (gai != 0) {
+        error = "Failed to resolve '" + endpoint.host + "': " + gai_strerror(gai);
+        return false;
+    }
+
+    addresses.clear();
+    for (struct addrinfo* ai = list; ai != nullptr; ai = ai->ai_next) {
+        if (ai->ai_addrlen > sizeof(struct sockaddr_storage)) continue;
+        ResolvedAddress resolved;
+        resolved.family = ai->ai_family;
+        resolved.socktype = ai->ai_socktype;
+        resolved.protocol = ai->ai_protocol;
+        std::memcpy(&resolved.address, ai->ai_addr, ai->ai_addrlen);
+        resolved.length = static_cast<socklen_t>(ai->ai_addrlen);
+        addresses.push_back(resolved);
+    }
+    freeaddrinfo(list);
+
+    ResolvedEndpoint entry;
+    entry.addresses = addresses;
+    entry.expiresAt = Clock::now() + std::chrono::milliseconds(RESOLVE_CACHE_TTL_MS);
+    std::lock_guard<std::mutex> lock(g_resolveMutex);
+    g_resolved[key] = entry;
+    return true;
+}
+
+// The printer may have moved; resolve again on the next connect
+void forgetResolvedEndpoint(const TcpEndpoint& endpoint) {
+    std::lock_guard<std::mutex> lock(g_resolveMutex);
+    g_resolved.erase(endpointKey(endpoint));
+}
+
+// Creates a non-blocking socket and starts connecting it. Returns -1 with
+// errno set if that fails at once; pending tells whether the connect is
+// still in progress.
+int beginConnect(const ResolvedAddress& ai, bool& pending) {
+    pending = false;
+    int fd = socket(ai.family, ai.socktype, ai.protocol);
+    if (fd < 0) return -1;
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    if (connect(fd, reinterpret_cast<const struct sockaddr*>(&ai.address), ai.length) == 0) {
+        return fd;
+    }
+    if (errno == EINPROGRESS) {
+        pending = true;
+        return fd;
+    }
+    int saved = errno;
+    close(fd);
+    errno = saved;
+    return -1;
+}
+
+// Outcome of a connect that has become writable; 0 when it succeeded
+int connectResult(int fd) {
+    int soError = 0;
+    socklen_t len = sizeof(soError);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &soError, &len) != 0) return errno;
+    return soError;
+}
+
+void setConnectedOptions(int fd) {
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
+#ifdef SO_NOSIGPIPE
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+}
+
+// Non-blocking connect bounded by the endpoint's connect timeout. The
+// timeout covers the connect only; name resolution comes first and is cached.
+int connectEndpoint(const TcpEndpoint& endpoint, std::string& error) {
+    std::vector<ResolvedAddress> addresses;
+    if (!resolveEndpoint(endpoint, addresses, error)) {
+        return -1;
+    }
+
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(endpoint.connectTimeoutMs);
+    int fd = -1;
+    error = "Connection to " + endpointKey(endpoint) + " timed out";
+
+    for (size_t i = 0; i < addresses.size() && fd < 0; i++) {
+        bool pending = false;
+        int candidate = beginConnect(addresses[i], pending);
+        if (candidate < 0) {
+            error = "Failed to connect to " + endpointKey(endpoint) + ": " + std::strerror(errno);
+            continue;
+        }
+
+        int rc = 0;
+        if (pending) {
+            struct pollfd pfd;
+            pfd.fd = candidate;
+            pfd.events = POLLOUT;
+            pfd.revents = 0;
+            do {
+                rc = poll(&pfd, 1, static_cast<int>(millisUntil(deadline)));
+            } while (rc < 0 && errno == EINTR);
+
+            if (rc > 0) {
+                int soError = connectResult(candidate);
+                if (soError == 0) {
+                    rc = 0;
+                } else {
+                    error = "Failed to connect to " + endpointKey(endpoint) + ": " + std::strerror(soError);
+                    rc = -1;
+                }
+            } else {
+                rc = -1;
+            }
+        }
+
+        if (rc == 0) {
+            fd = candidate;
+        } else {
+            close(candidate);
+        }
+    }
+    if (fd < 0) {
+        forgetResolvedEndpoint(endpoint);
+    } else {
+        setConnectedOptions(fd);
+    }
+    return fd;
+}
+
+// Writes every segment to a non-blocking descriptor, gathered into as few
+// system calls as the kernel allows, or fails once the timeout elapses.
+// `written` tells the caller whether anything reached the printer.
+bool writeSegments(int fd, bool isSocket, const DataSegment* segments, size_t count, int timeoutMs,
+                   size_t& written, std::string& error) {
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    written = 0;
+
+    std::vector<struct iovec> iov;
+    for (size_t i = 0; i < count; i++) {
+        if (segments[i].length == 0) continue;
+        struct iovec entry;
+        entry.iov_base = const_cast<unsigned char*>(segments[i].data);
+        entry.iov_len = segments[i].length;
+        iov.push_back(entry);
+    }
+
+    size_t first = 0;
+    while (first < iov.size()) {
+        int iovcnt = static_cast<int>(std::min(iov.size() - first, static_cast<size_t>(IOV_MAX)));
+        ssize_t n;
+        if (isSocket) {
+            struct msghdr message;
+            std::memset(&message, 0, sizeof(message));
+            message.msg_iov = &iov[first];
+            message.msg_iovlen = iovcnt;
+            n = sendmsg(fd, &message, MSG_NOSIGNAL);
+        } else {
+            n = writev(fd, &iov[first], iovcnt);
+        }
+        if (n > 0) {
+            size_t advanced = static_cast<size_t>(n);
+            written += advanced;
+            while (first < iov.size() && advanced >= iov[first].iov_len) {
+                advanced -= iov[first].iov_len;
+                first++;
+            }
+            if (advanced > 0) {
+                iov[first].iov_base = static_cast<unsigned char*>(iov[first].iov_base) + advanced;
+                iov[first].iov_len -= advanced;
+            }
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            error = std::strerror(errno);
+            return false;
+        }
+
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLOUT;
+        pfd.revents = 0;
+        int remaining = static_cast<int>(millisUntil(deadline));
+        int rc = remaining > 0 ? poll(&pfd, 1, remaining) : 0;
+        if (rc == 0) {
+            error = "write timed out";
+            return false;
+        }
+        if (rc < 0 && errno != EINTR) {
+            error = std::strerror(errno);
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+OperationResult sendOverTcp(const TcpEndpoint& endpoint, const unsigned char* data, size_t length) {
+    DataSegment segment = { data, length };
+    return sendOverTcp(endpoint, &segment, 1);
+}
+
+OperationResult sendOverTcp(const TcpEndpoint& endpoint, const DataSegment* segments, size_t count) {
+    OperationResult result;
+    std::string key = endpointKey(endpoint);
+    std::string error;
+    size_t written = 0;
+
+    int fd = takeIdleSocket(key);
+    bool reused = fd >= 0;
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (fd < 0) {
+            fd = connectEndpoint(endpoint, error);
+            if (fd < 0) {
+                result.setError(PRINTER_OPEN_ERROR, error);
+                return result;
+            }
+            reused = false;
+        }
+
+        if (writeSegments(fd, true, segments, count, endpoint.writeTimeoutMs, written, error)) {
+            returnIdleSocket(key, fd, endpoint.keepAliveMs);
+            return result;
+        }
+
+        close(fd);
+        fd = -1;
+
+        // A pooled connection may have gone stale; reconnect once, unless
+        // part of the payload already went out and would be printed twice
+        if (!reused || written > 0) break;
+    }
+
+    result.setError(PRINTER_WRITE_ERROR, "Failed to write to " + key + ": " + error);
+    return result;
+}
+
+// Connect ahead of the first kick, e.g. when a DrawerHandle is created. The
+// connection goes to the idle pool like any other, so keepAliveMs still
+// decides how long it stays open.
+OperationResult openTcpEndpoint(const TcpEndpoint& endpoint) {
+    OperationResult result;
+    std::string key = endpointKey(endpoint);
+    int fd = takeIdleSocket(key);
+    if (fd < 0) {
+        std::string error;
+        fd = connectEndpoint(endpoint, error);
+        if (fd < 0) {
+            result.setError(PRINTER_OPEN_ERROR, error);
+            return result;
+        }
+    }
+    returnIdleSocket(key, fd, endpoint.keepAliveMs);
+    return result;
+}
+
+// ============================================================================
+// Direct device-node transport (USB, parallel, serial)
+// ============================================================================
+//
+// Writes straight to /dev/usb/lp*, /dev/lp* or /dev/tty* and keeps the
+// descriptor open between kicks, so the warm path is a single write().
+// Each device has its own lock so concurrent kicks never interleave bytes.
+
+namespace {
+
+struct OpenDevice {
+    std::mutex mutex;
+    int fd;
+    bool isTerminal;
+    SerialSettings applied;
+
+    OpenDevice() : fd(-1), isTerminal(false) {}
+};
+
+std::mutex& g_devicesMutex = *new std::mutex();
+std::unordered_map<std::string, OpenDevice*>& g_devices = *new std::unordered_map<std::string, OpenDevice*>();
+
+OpenDevice* deviceFor(const std::string& path) {
+    std::lock_guard<std::mutex> lock(g_devicesMutex);
+    OpenDevice*& device = g_devices[path];
+    if (!device) device = new OpenDevice();
+    return device;
+}
+
+bool sameSerialSettings(const SerialSettings& a, const SerialSettings& b) {
+    return a.baudRate == b.baudRate && a.dataBits == b.dataBits && a.stopBits == b.stopBits &&
+           a.parity == b.parity && a.flowControl == b.flowControl;
+}
+
+bool baudRateConstant(int baudRate, speed_t& speed) {
+    switch (baudRate) {
+        case 1200: speed = B1200; return true;
+        case 2400: speed = B2400; return true;
+        case 4800: speed = B4800; return true;
+        case 9600: speed = B9600; return true;
+        case 19200: speed = B19200; return true;
+        case 38400: speed = B38400; return true;
+        case 57600: speed = B57600; return true;
+        case 115200: speed = B115200; return true;
+#ifdef B230400
+        case 230400: speed = B230400; return true;
+#endif
+        default: return false;
+    }
+}
+
+bool applySerialSettings(int fd, const SerialSettings& serial, std::string& error) {
+    speed_t speed;
+    if (!baudRateConstant(serial.baudRate, speed)) {
+        error = "Unsupported baud rate " + std::to_string(serial.baudRate);
+        return false;
+    }
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) {
+        error = "Failed to read serial settings: " + std::string(std::strerror(errno));
+        return false;
+    }
+
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+
+    tio.c_cflag &= ~(CSIZE | CSTOPB | PARENB | PARODD);
+    tio.c_cflag |= CLOCAL | CREAD | (serial.dataBits == 7 ? CS7 : CS8);
+    if (serial.stopBits == 2) tio.c_cflag |= CSTOPB;
+    if (serial.parity == PARITY_EVEN) tio.c_cflag |= PARENB;
+    if (serial.parity == PARITY_ODD) tio.c_cflag |= PARENB | PARODD;
+
+#ifdef CRTSCTS
+    tio.c_cflag &= ~CRTSCTS;
+    if (serial.flowControl == FLOW_HARDWARE) tio.c_cflag |= CRTSCTS;
+#endif
+    tio.c_iflag &= ~(IXON | IXOFF | IXANY);
+    if (serial.flowControl == FLOW_SOFTWARE) tio.c_iflag |= IXON | IXOFF;
+
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+
+    if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+        error = "Failed to apply serial settings: " + std::string(std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+// Opens (or re-configures) the device; caller holds device.mutex
+bool ensureDeviceOpen(OpenDevice& device, const DeviceTarget& target, std::string& error) {
+    if (device.fd < 0) {
+        int fd = open(target.path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0 && (errno == EACCES || errno == EROFS)) {
+            fd = open(target.path.c_str(), O_WRONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        }
+        if (fd < 0) {
+            error = "Failed to open " + target.path + ": " + std::strerror(errno);
+            return false;
+        }
+        // Only write to printer devices (and FIFOs standing in for one),
+        // never append to a regular file a path happens to name
+        struct stat info;
+        if (fstat(fd, &info) != 0 || !(S_ISCHR(info.st_mode) || S_ISFIFO(info.st_mode))) {
+            close(fd);
+            error = target.path + " is not a character device";
+            return false;
+        }
+        device.fd = fd;
+        device.isTerminal = isatty(fd) != 0;
+        device.applied = SerialSettings();
+        device.applied.baudRate = 0;  // force the first configuration
+    }
+
+    if (device.isTerminal && !sameSerialSettings(device.applied, target.serial)) {
+        if (!applySerialSettings(device.fd, target.serial, error)) {
+            return false;
+        }
+        device.applied = target.serial;
+    }
+    return true;
+}
+
+void closeDevice(OpenDevice& device) {
+    if (device.fd >= 0) {
+        close(device.fd);
+        device.fd = -1;
+    }
+}
+
+} // namespace
+
+OperationResult sendToDevice(const DeviceTarget& target, const unsigned char* data, size_t length) {
+    DataSegment segment = { data, length };
+    return sendToDevice(target, &segment, 1);
+}
+
+OperationResult sendToDevice(const DeviceTarget& target, const DataSegment* segments, size_t count) {
+    OperationResult result;
+    OpenDevice* device = deviceFor(target.path);
+    std::lock_guard<std::mutex> lock(device->mutex);
+
+    std::string error;
+    size_t written = 0;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool wasOpen = device->fd >= 0;
+        if (!ensureDeviceOpen(*device, target, error)) {
+            closeDevice(*device);
+            result.setError(PRINTER_OPEN_ERROR, error);
+            return result;
+        }
+
+        if (writeSegments(device->fd, false, segments, count, target.writeTimeoutMs, written, error)) {
+            return result;
+        }
+
+        // The printer may have been unplugged and re-attached; reopen once
+        closeDevice(*device);
+        if (!wasOpen || written > 0) break;
+    }
+
+    result.setError(PRINTER_WRITE_ERROR, "Failed to write to " + target.path + ": " + error);
+    return result;
+}
+
+// Open the device ahead of the first write, e.g. when a DrawerHandle is created
+OperationResult openDeviceTarget(const DeviceTarget& target) {
+    OperationResult result;
+    OpenDevice* device = deviceFor(target.path);
+    std::lock_guard<std::mutex> lock(device->mutex);
+
+    std::string error;
+    if (!ensureDeviceOpen(*device, target, error)) {
+        closeDevice(*device);
+        result.setError(PRINTER_OPEN_ERROR, error);
+    }
+    return result;
+}
+
+// ============================================================================
+// Status channels (drawerstatus.cc)
+// ============================================================================
+//
+// The status reader keeps its own descriptor per printer while a query is
+// out: a socket taken from the idle pool (or a new one), or a duplicate
+// of the shared device descriptor, so a kick that reopens the device can't
+// close it underneath a pending poll().
+
+// Runs on the worker pool, since getaddrinfo() may block
+bool resolveStatusEndpoint(const TcpEndpoint& endpoint, std::vector<ResolvedAddress>& addresses,
+                           std::string& error) {
+    if (!resolveEndpoint(endpoint, addresses, error)) return false;
+    if (addresses.empty()) {
+        error = "'" + endpoint.host + "' has no addresses";
+        return false;
+    }
+    return true;
+}
+
+int takeStatusSocket(const TcpEndpoint& endpoint) {
+    return takeIdleSocket(endpointKey(endpoint));
+}
+
+// The status reader polls the socket for POLLOUT and then calls
+// finishStatusConnect(), so it never waits for a connect itself
+int startStatusConnect(const ResolvedAddress& address, std::string& error) {
+    bool pending = false;
+    int fd = beginConnect(address, pending);
+    if (fd < 0) {
+        error = std::strerror(errno);
+    } else if (!pending) {
+        setConnectedOptions(fd);
+    }
+    return fd;
+}
+
+bool finishStatusConnect(int fd, std::string& error) {
+    int soError = connectResult(fd);
+    if (soError != 0) {
+        error = std::strerror(soError);
+        return false;
+    }
+    setConnectedOptions(fd);
+    return true;
+}
+
+// One non-blocking send: the bytes sent, 0 if the socket is full, -1 on error
+ssize_t sendStatusBytes(int fd, const unsigned char* data, size_t length, std::string& error) {
+    for (;;) {
+        ssize_t n = send(fd, data, length, MSG_NOSIGNAL);
+        if (n >= 0) return n;
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+        error = std::strerror(errno);
+        return -1;
+    }
+}
+
+void releaseStatusSocket(const TcpEndpoint& endpoint, int fd) {
+    returnIdleSocket(endpointKey(endpoint), fd, endpoint.keepAliveMs);
+}
+
+int openDeviceStatusFd(const DeviceTarget& target, std::string& error) {
+    OpenDevice* device = deviceFor(target.path);
+    std::lock_guard<std::mutex> lock(device->mutex);
+
+    if (!ensureDeviceOpen(*device, target, error)) {
+        closeDevice(*device);
+        return -1;
+    }
+    if ((fcntl(device->fd, F_GETFL) & O_ACCMODE) == O_WRONLY) {
+        error = target.path + " is only writable, so the printer's status can't be read";
+        return -1;
+    }
+
+    int fd = fcntl(device->fd, F_DUPFD_CLOEXEC, 0);
+    if (fd < 0) {
+        error = "Failed to duplicate the descriptor for " + target.path + ": " + std::strerror(errno);
+    }
+    return fd;
+}
+
+
+#else
+
+OperationResult sendOverTcp(const TcpEndpoint& endpoint, const DataSegment* segments, size_t count) {
+    OperationResult result;
+    result.setError(PRINTER_OPEN_ERROR, "The tcp transport is not supported on Windows");
+    return result;
+}
+
+OperationResult sendOverTcp(const TcpEndpoint& endpoint, const unsigned char* data, size_t length) {
+    return sendOverTcp(endpoint, static_cast<const DataSegment*>(nullptr), 0);
+}
+
+OperationResult openTcpEndpoint(const TcpEndpoint& endpoint) {
+    return sendOverTcp(endpoint, static_cast<const DataSegment*>(nullptr), 0);
+}
+
+OperationResult sendToDevice(const DeviceTarget& target, const DataSegment* segments, size_t count) {
+    OperationResult result;
+    result.setError(PRINTER_OPEN_ERROR, "The device transport is not supported on Windows");
+    return result;
+}
+
+OperationResult sendToDevice(const DeviceTarget& target, const unsigned char* data, size_t length) {
+    return sendToDevice(target, static_cast<const DataSegment*>(nullptr), 0);
+}
+
+OperationResult openDeviceTarget(const DeviceTarget& target) {
+    return sendToDevice(target, static_cast<const DataSegment*>(nullptr), 0);
+}
+
+#endif
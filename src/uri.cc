@@ -0,0 +1,195 @@
+#include "uri.h"
+
+// ============================================================================
+// Character helpers
+// ============================================================================
+
+static inline char asciiLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+static inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static inline bool isSchemeChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || isDigit(c) || c == '+' || c == '-' || c == '.';
+}
+
+bool startsWithNoCase(const char* text, size_t length, const char* prefix) {
+    size_t i = 0;
+    for (; prefix[i] != '\0'; i++) {
+        if (i >= length || asciiLower(text[i]) != prefix[i]) return false;
+    }
+    return true;
+}
+
+bool containsNoCase(const char* text, size_t length, const char* needle) {
+    size_t needleLength = 0;
+    while (needle[needleLength] != '\0') needleLength++;
+    if (needleLength > length) return false;
+
+    for (size_t start = 0; start + needleLength <= length; start++) {
+        size_t i = 0;
+        while (i < needleLength && asciiLower(text[start + i]) == needle[i]) i++;
+        if (i == needleLength) return true;
+    }
+    return false;
+}
+
+// Parse up to 5 digits as a port (1-65535); returns characters consumed
+static size_t parsePort(const char* text, size_t length, int& port) {
+    size_t i = 0;
+    int value = 0;
+    while (i < length && isDigit(text[i]) && i < 5) {
+        value = value * 10 + (text[i] - '0');
+        i++;
+    }
+    if (i == 0 || (i < length && isDigit(text[i])) || value == 0 || value > 65535) {
+        return 0;
+    }
+    port = value;
+    return i;
+}
+
+// Match one dotted quad at text; returns its length or 0
+static size_t matchIPv4(const char* text, size_t length) {
+    size_t i = 0;
+    for (int octet = 0; octet < 4; octet++) {
+        if (octet > 0) {
+            if (i >= length || text[i] != '.') return 0;
+            i++;
+        }
+        size_t digits = 0;
+        int value = 0;
+        while (i < length && isDigit(text[i]) && digits < 3) {
+            value = value * 10 + (text[i] - '0');
+            i++;
+            digits++;
+        }
+        if (digits == 0 || value > 255) return 0;
+    }
+    return i;
+}
+
+bool isIPv4Literal(const char* text, size_t length) {
+    return length > 0 && matchIPv4(text, length) == length;
+}
+
+// ============================================================================
+// Scanners
+// ============================================================================
+
+bool scanIPv4(const char* text, size_t length, TextSpan& address, int& port) {
+    for (size_t start = 0; start < length; start++) {
+        if (!isDigit(text[start])) continue;
+
+        size_t matched = matchIPv4(text + start, length - start);
+        if (matched == 0) continue;
+
+        address = TextSpan(text + start, matched);
+        size_t end = start + matched;
+        if (end + 1 < length && text[end] == ':') {
+            parsePort(text + end + 1, length - end - 1, port);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool scanBluetoothAddress(const char* text, size_t length, char* out) {
+    // Separated form: XX:XX:XX:XX:XX:XX or XX-XX-XX-XX-XX-XX
+    for (size_t start = 0; start + 17 <= length; start++) {
+        size_t i = 0;
+        for (; i < 17; i++) {
+            char c = text[start + i];
+            if (i % 3 == 2 ? (c != ':' && c != '-') : hexValue(c) < 0) break;
+        }
+        if (i == 17) {
+            for (i = 0; i < 17; i++) out[i] = text[start + i];
+            out[17] = '\0';
+            return true;
+        }
+    }
+
+    // Bare form: twelve consecutive hex digits
+    size_t run = 0;
+    for (size_t i = 0; i < length; i++) {
+        run = hexValue(text[i]) >= 0 ? run + 1 : 0;
+        if (run == 12) {
+            const char* raw = text + i - 11;
+            for (int b = 0; b < 6; b++) {
+                out[b * 3] = raw[b * 2];
+                out[b * 3 + 1] = raw[b * 2 + 1];
+                out[b * 3 + 2] = b < 5 ? ':' : '\0';
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseUri(const char* text, size_t length, UriParts& parts) {
+    parts = UriParts();
+
+    // scheme
+    size_t i = 0;
+    while (i < length && isSchemeChar(text[i])) i++;
+    if (i == 0 || i + 3 > length || text[i] != ':' || text[i + 1] != '/' || text[i + 2] != '/') {
+        return false;
+    }
+    parts.scheme = TextSpan(text, i);
+    i += 3;
+
+    // authority ends at the first '/', '?' or '#'
+    size_t authorityStart = i;
+    size_t authorityEnd = i;
+    while (authorityEnd < length && text[authorityEnd] != '/' && text[authorityEnd] != '?' && text[authorityEnd] != '#') {
+        authorityEnd++;
+    }
+
+    // skip userinfo
+    for (size_t j = authorityStart; j < authorityEnd; j++) {
+        if (text[j] == '@') authorityStart = j + 1;
+    }
+
+    size_t hostEnd;
+    size_t cursor = authorityStart;
+    if (cursor < authorityEnd && text[cursor] == '[') {
+        size_t close = cursor + 1;
+        while (close < authorityEnd && text[close] != ']') close++;
+        if (close >= authorityEnd) return false;
+        parts.host = TextSpan(text + cursor + 1, close - cursor - 1);
+        parts.hostKind = HOST_IPV6;
+        hostEnd = close + 1;
+    } else {
+        hostEnd = cursor;
+        while (hostEnd < authorityEnd && text[hostEnd] != ':') hostEnd++;
+        parts.host = TextSpan(text + cursor, hostEnd - cursor);
+        if (!parts.host.empty()) {
+            parts.hostKind = isIPv4Literal(parts.host.data, parts.host.length) ? HOST_IPV4 : HOST_NAME;
+        }
+    }
+
+    if (hostEnd < authorityEnd) {
+        if (text[hostEnd] != ':') return false;
+        size_t portLength = authorityEnd - hostEnd - 1;
+        // An empty port ("host:") is allowed and means the default
+        if (portLength > 0 && parsePort(text + hostEnd + 1, portLength, parts.port) != portLength) {
+            return false;
+        }
+    }
+
+    // path
+    size_t pathEnd = authorityEnd;
+    while (pathEnd < length && text[pathEnd] != '?' && text[pathEnd] != '#') pathEnd++;
+    parts.path = TextSpan(text + authorityEnd, pathEnd - authorityEnd);
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef NODE_PRINTER_URI_H
+#define NODE_PRINTER_URI_H
+
+#include <cstddef>
+
+// ============================================================================
+// Allocation-free scanners for printer connection details
+// ============================================================================
+//
+// These replace per-call std::regex matching in printer enumeration. They
+// never allocate: results are spans into the caller's buffer, and callers
+// copy out only what they keep. Kept free of N-API and CUPS so benchmarks
+// can link them on their own.
+
+struct TextSpan {
+    const char* data;
+    size_t length;
+
+    TextSpan() : data(nullptr), length(0) {}
+    TextSpan(const char* d, size_t n) : data(d), length(n) {}
+    bool empty() const { return length == 0; }
+};
+
+enum HostKind {
+    HOST_NONE,
+    HOST_IPV4,
+    HOST_IPV6,
+    HOST_NAME
+};
+
+// scheme://[userinfo@]host[:port][/path][?query][#fragment]
+struct UriParts {
+    TextSpan scheme;
+    TextSpan host;      // IPv6 literals without the brackets
+    HostKind hostKind;
+    int port;           // 0 when absent
+    TextSpan path;      // includes the leading '/', excludes query/fragment
+
+    UriParts() : hostKind(HOST_NONE), port(0) {}
+};
+
+// ASCII case-insensitive helpers
+bool startsWithNoCase(const char* text, size_t length, const char* prefix);
+bool containsNoCase(const char* text, size_t length, const char* needle);
+
+// Parse a hierarchical URI. Returns false when there is no "scheme://" or
+// the authority is malformed (unterminated IPv6 literal, bad port).
+bool parseUri(const char* text, size_t length, UriParts& parts);
+
+// Find the first dotted-quad IPv4 address in text, with an optional ":port"
+// directly after it. Octets above 255 are rejected.
+bool scanIPv4(const char* text, size_t length, TextSpan& address, int& port);
+
+// Find the first Bluetooth address, "00:11:22:33:44:55" / "00-11-..." or
+// twelve consecutive hex digits. out receives the colon-separated form and
+// must hold at least 18 bytes.
+bool scanBluetoothAddress(const char* text, size_t length, char* out);
+
+// True when span is a valid dotted-quad IPv4 address
+bool isIPv4Literal(const char* text, size_t length);
+
+#endif // NODE_PRINTER_URI_H
@@ -0,0 +1,317 @@
+#include "common.h"
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+// ============================================================================
+// Printer watcher
+// ============================================================================
+//
+// A single native thread re-enumerates printers on behalf of every
+// watchPrinters() subscriber, records the result in the snapshot store
+// (snapshot.cc) and pushes only the entries that changed since its previous
+// poll. Changes that pile up while JS is busy are merged per printer, so each
+// subscriber has at most one delivery in flight and nothing is marshalled
+// when nothing changed.
+
+static const int DEFAULT_WATCH_INTERVAL_MS = 2000;
+static const int MIN_WATCH_INTERVAL_MS = 100;
+
+namespace {
+
+struct PrinterWatch {
+    uint32_t id;
+    napi_threadsafe_function tsfn;
+    int intervalMs;
+    bool primed;          // Initial snapshot queued
+    bool closed;
+    bool deliveryQueued;
+    std::map<std::string, PrinterChange> pending;
+
+    PrinterWatch()
+        : id(0), tsfn(nullptr), intervalMs(DEFAULT_WATCH_INTERVAL_MS)
+        , primed(false), closed(false), deliveryQueued(false) {}
+};
+
+// Intentionally leaked: the detached watcher may still touch these during exit
+std::mutex& g_watchMutex = *new std::mutex();
+std::condition_variable& g_watchWake = *new std::condition_variable();
+std::unordered_map<uint32_t, PrinterWatch*>& g_watches = *new std::unordered_map<uint32_t, PrinterWatch*>();
+uint32_t g_nextWatchId = 1;
+bool g_watcherRunning = false;
+bool g_pollNow = false;
+uint64_t g_watchGeneration = 0;  // Snapshot generation subscribers have been told about
+
+// Fold a new change into what the subscriber has not seen yet
+void mergeChange(std::map<std::string, PrinterChange>& pending, const PrinterChange& change) {
+    auto it = pending.find(change.printer.name);
+    if (it == pending.end()) {
+        pending.insert(std::make_pair(change.printer.name, change));
+        return;
+    }
+
+    PrinterChange& existing = it->second;
+    if (existing.kind == PRINTER_ADDED) {
+        // JS never saw this printer, so a removal cancels the addition
+        if (change.kind == PRINTER_REMOVED) {
+            pending.erase(it);
+        } else {
+            existing.printer = change.printer;
+        }
+    } else if (existing.kind == PRINTER_REMOVED) {
+        // Removed and back again: JS still holds the old entry
+        existing.kind = PRINTER_CHANGED;
+        existing.printer = change.printer;
+    } else {
+        existing.kind = change.kind == PRINTER_REMOVED ? PRINTER_REMOVED : PRINTER_CHANGED;
+        existing.printer = change.printer;
+    }
+}
+
+// Changes since the watcher's last poll. getAvailablePrinters() updates the
+// same store, so this asks for a delta instead of diffing against the
+// previous poll, which would miss whatever an enumeration in between saw.
+void collectChanges(uint64_t generation, std::vector<PrinterChange>& changes) {
+    if (g_watchGeneration == 0 || generation == g_watchGeneration) return;
+
+    PrinterDelta delta;
+    printerDeltaSince(g_watchGeneration, delta);
+    for (const auto& printer : delta.added) changes.push_back(PrinterChange{ PRINTER_ADDED, printer });
+    for (const auto& printer : delta.changed) changes.push_back(PrinterChange{ PRINTER_CHANGED, printer });
+    for (const auto& printer : delta.removed) changes.push_back(PrinterChange{ PRINTER_REMOVED, printer });
+}
+
+// Called with g_watchMutex held
+void queueDelivery(PrinterWatch* watch, bool force) {
+    if (watch->deliveryQueued || (!force && watch->pending.empty())) return;
+    if (napi_call_threadsafe_function(watch->tsfn, nullptr, napi_tsfn_nonblocking) == napi_ok) {
+        watch->deliveryQueued = true;
+    }
+}
+
+void watcherLoop() {
+    std::unique_lock<std::mutex> lock(g_watchMutex);
+
+    while (!g_watches.empty()) {
+        g_pollNow = false;
+
+        lock.unlock();
+        std::vector<PrinterInfo> printers;
+        bool enumerated = enumeratePrinters(printers);
+        lock.lock();
+
+        // A failed poll (e.g. cupsd restarting) must not look like every
+        // printer disappearing; keep the snapshot and try again next time
+        if (enumerated) {
+            uint64_t generation = applyPrinterSnapshot(printers);
+            indexPrinterNames(printers);
+            std::vector<PrinterChange> changes;
+            collectChanges(generation, changes);
+            g_watchGeneration = generation;
+
+            for (auto& entry : g_watches) {
+                PrinterWatch* watch = entry.second;
+                if (!watch->primed) {
+                    // First delivery carries every current printer
+                    for (const auto& printer : printers) {
+                        watch->pending[printer.name] = PrinterChange{ PRINTER_ADDED, printer };
+                    }
+                    watch->primed = true;
+                    queueDelivery(watch, true);
+                    continue;
+                }
+                for (const auto& change : changes) {
+                    mergeChange(watch->pending, change);
+                }
+                queueDelivery(watch, false);
+            }
+        }
+
+        int intervalMs = DEFAULT_WATCH_INTERVAL_MS;
+        bool first = true;
+        for (const auto& entry : g_watches) {
+            if (first || entry.second->intervalMs < intervalMs) intervalMs = entry.second->intervalMs;
+            first = false;
+        }
+
+        g_watchWake.wait_for(lock, std::chrono::milliseconds(intervalMs), []() {
+            return g_pollNow || g_watches.empty();
+        });
+    }
+
+    g_watchGeneration = 0;
+    g_watcherRunning = false;
+}
+
+const char* changeKindName(PrinterChangeKind kind) {
+    switch (kind) {
+    case PRINTER_ADDED: return "added";
+    case PRINTER_REMOVED: return "removed";
+    default: return "changed";
+    }
+}
+
+// Runs on the JS thread: hand the merged changes to the callback
+void CallJsWatch(napi_env env, napi_value js_callback, void* context, void* data) {
+    PrinterWatch* watch = static_cast<PrinterWatch*>(context);
+
+    std::map<std::string, PrinterChange> pending;
+    bool closed;
+    {
+        std::lock_guard<std::mutex> lock(g_watchMutex);
+        pending.swap(watch->pending);
+        watch->deliveryQueued = false;
+        closed = watch->closed;
+    }
+
+    if (env == nullptr || closed) return;
+
+    PrinterMarshaller marshaller(env);
+    napi_value type_key, printer_key, kinds[3];
+    napi_create_string_latin1(env, "type", NAPI_AUTO_LENGTH, &type_key);
+    napi_create_string_latin1(env, "printer", NAPI_AUTO_LENGTH, &printer_key);
+    for (int kind = PRINTER_ADDED; kind <= PRINTER_CHANGED; kind++) {
+        napi_create_string_latin1(env, changeKindName(static_cast<PrinterChangeKind>(kind)), NAPI_AUTO_LENGTH, &kinds[kind]);
+    }
+
+    napi_value changes;
+    napi_create_array_with_length(env, pending.size(), &changes);
+
+    uint32_t index = 0;
+    for (const auto& entry : pending) {
+        napi_property_descriptor properties[] = {
+            { nullptr, type_key, nullptr, nullptr, nullptr, kinds[entry.second.kind], napi_default_jsproperty, nullptr },
+            { nullptr, printer_key, nullptr, nullptr, nullptr, marshaller.toObject(entry.second.printer), napi_default_jsproperty, nullptr }
+        };
+        napi_value change;
+        napi_create_object(env, &change);
+        napi_define_properties(env, change, 2, properties);
+        napi_set_element(env, changes, index++, change);
+    }
+
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    napi_call_function(env, undefined, js_callback, 1, &changes, nullptr);
+}
+
+void FinalizeWatch(napi_env env, void* finalize_data, void* finalize_hint) {
+    PrinterWatch* watch = static_cast<PrinterWatch*>(finalize_data);
+    {
+        // Still registered when the environment is torn down without close()
+        std::lock_guard<std::mutex> lock(g_watchMutex);
+        auto it = g_watches.find(watch->id);
+        if (it != g_watches.end() && it->second == watch) g_watches.erase(it);
+    }
+    g_watchWake.notify_all();
+    delete watch;
+}
+
+} // namespace
+
+// ============================================================================
+// Exported N-API functions
+// ============================================================================
+
+// watchPrinters(callback, { intervalMs }) -> watch id
+napi_value WatchPrinters(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) napi_typeof(env, args[0], &type);
+    if (type != napi_function) {
+        napi_throw_type_error(env, nullptr, "First argument must be a callback function");
+        return nullptr;
+    }
+
+    int32_t intervalMs = DEFAULT_WATCH_INTERVAL_MS;
+    napi_valuetype options_type = napi_undefined;
+    if (argc >= 2) napi_typeof(env, args[1], &options_type);
+    if (options_type == napi_object) {
+        bool has_interval;
+        napi_has_named_property(env, args[1], "intervalMs", &has_interval);
+        if (has_interval) {
+            napi_value value;
+            napi_get_named_property(env, args[1], "intervalMs", &value);
+            if (napi_get_value_int32(env, value, &intervalMs) != napi_ok || intervalMs < MIN_WATCH_INTERVAL_MS) {
+                napi_throw_range_error(env, nullptr, "intervalMs must be at least 100");
+                return nullptr;
+            }
+        }
+    }
+
+    PrinterWatch* watch = new PrinterWatch();
+    watch->intervalMs = intervalMs;
+
+    napi_value name;
+    NAPI_CALL(env, napi_create_string_utf8(env, "PrinterWatch", NAPI_AUTO_LENGTH, &name));
+
+    napi_status status = napi_create_threadsafe_function(
+        env, args[0], nullptr, name,
+        0, 1,
+        watch, FinalizeWatch,
+        watch, CallJsWatch,
+        &watch->tsfn);
+    if (status != napi_ok) {
+        delete watch;
+        napi_throw_error(env, nullptr, "Failed to create the printer watch");
+        return nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_watchMutex);
+        watch->id = g_nextWatchId++;
+        g_watches[watch->id] = watch;
+        g_pollNow = true;  // Prime the new subscriber without waiting a full interval
+        if (!g_watcherRunning) {
+            g_watcherRunning = true;
+            std::thread(watcherLoop).detach();
+        }
+    }
+    g_watchWake.notify_all();
+
+    napi_value id;
+    NAPI_CALL(env, napi_create_uint32(env, watch->id, &id));
+    return id;
+}
+
+// unwatchPrinters(id)
+napi_value UnwatchPrinters(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    uint32_t id = 0;
+    if (argc < 1 || napi_get_value_uint32(env, args[0], &id) != napi_ok) {
+        napi_throw_type_error(env, nullptr, "Expected a watch id");
+        return nullptr;
+    }
+
+    napi_threadsafe_function tsfn = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(g_watchMutex);
+        auto it = g_watches.find(id);
+        if (it != g_watches.end()) {
+            it->second->closed = true;
+            tsfn = it->second->tsfn;
+            g_watches.erase(it);
+        }
+    }
+
+    // The watcher only calls the function for registered watches, so it is
+    // safe to release now; FinalizeWatch frees the watch once queued calls drain
+    if (tsfn != nullptr) {
+        napi_release_threadsafe_function(tsfn, napi_tsfn_release);
+        g_watchWake.notify_all();
+    }
+
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    return undefined;
+}
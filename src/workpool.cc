@@ -0,0 +1,373 @@
+#include "common.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// ============================================================================
+// Printer I/O worker pool
+// ============================================================================
+//
+// Printer I/O (scheduled jobs, batch kicks, handle opens and enumeration)
+// runs on the addon's own threads instead of libuv's pool, so a slow cupsd
+// or a hung network printer can't hold up fs, dns and crypto work elsewhere
+// in the process. By default the workers share one FIFO queue. With work
+// stealing, each worker has its own queue: tasks submitted from a worker
+// (the next job for the same printer, a batch's fan-out) stay on that
+// worker, JS submissions are spread round robin, and an idle worker takes
+// tasks from the others. Results go back to JS through one thread-safe
+// function per environment. Reconfiguring replaces the pool; the old
+// workers finish what was queued on them and exit.
+
+static const int DEFAULT_POOL_SIZE = 4;
+static const int MAX_POOL_SIZE = 64;
+
+// Completion path back to one JS environment, as for scheduler results
+struct WorkChannel {
+    std::mutex mutex;
+    napi_threadsafe_function tsfn;
+    bool closed;
+    uint32_t pending;  // JS thread only
+
+    WorkChannel() : tsfn(nullptr), closed(false), pending(0) {}
+};
+
+struct WorkCompletion {
+    std::shared_ptr<WorkChannel> channel;
+    napi_async_complete_callback complete;
+    void* data;
+};
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct TaskQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+};
+
+struct WorkerPool {
+    int size;
+    bool workStealing;
+    std::vector<std::unique_ptr<TaskQueue>> queues;  // One shared, or one per worker
+    std::atomic<size_t> nextQueue;                   // Round robin for submissions from outside
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    size_t queued;      // Submitted but not yet claimed by a worker
+    size_t peakQueued;
+    bool retired;
+
+    std::atomic<uint32_t> active;
+    std::atomic<uint64_t> submitted;
+    std::atomic<uint64_t> completed;
+    std::atomic<uint64_t> stolen;
+    std::atomic<uint64_t> busyNanos;
+    Clock::time_point startedAt;
+
+    WorkerPool(int workers, bool stealing)
+        : size(workers), workStealing(stealing), nextQueue(0), queued(0), peakQueued(0), retired(false)
+        , active(0), submitted(0), completed(0), stolen(0), busyNanos(0), startedAt(Clock::now()) {
+        size_t queueCount = stealing ? static_cast<size_t>(workers) : 1;
+        for (size_t i = 0; i < queueCount; i++) queues.emplace_back(new TaskQueue());
+    }
+};
+
+// Intentionally leaked: detached workers may still touch these during exit
+std::mutex& g_poolMutex = *new std::mutex();
+std::shared_ptr<WorkerPool>& g_pool = *new std::shared_ptr<WorkerPool>();
+int g_poolSize = DEFAULT_POOL_SIZE;
+bool g_workStealing = false;
+
+// The pool and queue of the worker running on this thread, if any
+thread_local WorkerPool* t_pool = nullptr;
+thread_local size_t t_queue = 0;
+
+bool popTask(TaskQueue& queue, std::function<void()>& task) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return true;
+}
+
+// Takes the task this worker has claimed: its own queue first, then the
+// others. Claims never outnumber queued tasks, so a scan always ends with one.
+std::function<void()> claimTask(WorkerPool& pool, size_t own) {
+    std::function<void()> task;
+    for (;;) {
+        if (popTask(*pool.queues[own], task)) return task;
+        for (size_t i = 1; i < pool.queues.size(); i++) {
+            if (popTask(*pool.queues[(own + i) % pool.queues.size()], task)) {
+                pool.stolen++;
+                return task;
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+void workerLoop(std::shared_ptr<WorkerPool> pool, size_t index) {
+    size_t own = pool->workStealing ? index : 0;
+    t_pool = pool.get();
+    t_queue = own;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(pool->wakeMutex);
+            pool->wake.wait(lock, [&pool]() { return pool->queued > 0 || pool->retired; });
+            if (pool->queued == 0) return;  // Retired and drained
+            pool->queued--;
+        }
+
+        std::function<void()> task = claimTask(*pool, own);
+        pool->active++;
+        Clock::time_point start = Clock::now();
+        task();
+        pool->busyNanos += static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        pool->active--;
+        pool->completed++;
+    }
+}
+
+// The pool new work goes to; its workers start with the first task
+std::shared_ptr<WorkerPool> currentPool() {
+    std::lock_guard<std::mutex> lock(g_poolMutex);
+    if (!g_pool) {
+        g_pool = std::make_shared<WorkerPool>(g_poolSize, g_workStealing);
+        for (int i = 0; i < g_poolSize; i++) {
+            std::thread(workerLoop, g_pool, static_cast<size_t>(i)).detach();
+        }
+    }
+    return g_pool;
+}
+
+void retirePool(const std::shared_ptr<WorkerPool>& pool) {
+    {
+        std::lock_guard<std::mutex> lock(pool->wakeMutex);
+        pool->retired = true;
+    }
+    pool->wake.notify_all();
+}
+
+// Runs on the JS thread: complete the work item
+void CallJsWorkComplete(napi_env env, napi_value js_callback, void* context, void* data) {
+    WorkCompletion* completion = static_cast<WorkCompletion*>(data);
+
+    if (env != nullptr) {
+        WorkChannel& channel = *completion->channel;
+        completion->complete(env, napi_ok, completion->data);
+        if (--channel.pending == 0) {
+            napi_unref_threadsafe_function(env, channel.tsfn);
+        }
+    }
+
+    delete completion;
+}
+
+void FinalizeWorkChannel(napi_env env, void* finalize_data, void* finalize_hint) {
+    std::shared_ptr<WorkChannel>* channel = static_cast<std::shared_ptr<WorkChannel>*>(finalize_data);
+    {
+        std::lock_guard<std::mutex> lock((*channel)->mutex);
+        (*channel)->closed = true;
+    }
+    delete channel;
+}
+
+void SetNumber(napi_env env, napi_value object, const char* key, double number) {
+    napi_value value;
+    napi_create_double(env, number, &value);
+    napi_set_named_property(env, object, key, value);
+}
+
+} // namespace
+
+// ============================================================================
+// Worker pool API
+// ============================================================================
+
+bool InitWorkerPool(napi_env env, AddonData* data) {
+    std::shared_ptr<WorkChannel>* channel =
+        new std::shared_ptr<WorkChannel>(std::make_shared<WorkChannel>());
+
+    napi_value name;
+    napi_create_string_utf8(env, "PrinterWorkCompletion", NAPI_AUTO_LENGTH, &name);
+
+    napi_status status = napi_create_threadsafe_function(
+        env, nullptr, nullptr, name,
+        0, 1,
+        channel, FinalizeWorkChannel,
+        nullptr, CallJsWorkComplete,
+        &(*channel)->tsfn);
+    if (status != napi_ok) {
+        delete channel;
+        return false;
+    }
+
+    // Only keep the event loop alive while work is outstanding
+    napi_unref_threadsafe_function(env, (*channel)->tsfn);
+    data->workCompletions = *channel;
+    return true;
+}
+
+// Queues a task on the pool; callable from any thread
+void SubmitPoolTask(std::function<void()> task) {
+    for (;;) {
+        std::shared_ptr<WorkerPool> pool = currentPool();
+        size_t index = 0;
+        if (pool->workStealing) {
+            index = t_pool == pool.get() ? t_queue : pool->nextQueue++ % pool->queues.size();
+        }
+        {
+            std::lock_guard<std::mutex> lock(pool->wakeMutex);
+            if (pool->retired) continue;  // Replaced meanwhile; its workers may be gone
+            {
+                std::lock_guard<std::mutex> queueLock(pool->queues[index]->mutex);
+                pool->queues[index]->tasks.push_back(std::move(task));
+            }
+            pool->queued++;
+            pool->peakQueued = std::max(pool->peakQueued, pool->queued);
+        }
+        pool->submitted++;
+        pool->wake.notify_one();
+        return;
+    }
+}
+
+// Starts an item whose result some pool task hands back later with
+// FinishWorkCompletion(); keeps the event loop alive until then. JS thread only.
+WorkCompletion* BeginWorkCompletion(napi_env env, napi_async_complete_callback complete, void* data) {
+    WorkCompletion* completion = new WorkCompletion();
+    completion->channel = GetAddonData(env)->workCompletions;
+    completion->complete = complete;
+    completion->data = data;
+
+    if (completion->channel->pending++ == 0) {
+        napi_ref_threadsafe_function(env, completion->channel->tsfn);
+    }
+    return completion;
+}
+
+// Has complete(env, napi_ok, data) called on the JS thread; callable from
+// any thread, once. If the environment is gone, data is not released.
+void FinishWorkCompletion(WorkCompletion* completion) {
+    WorkChannel& channel = *completion->channel;
+    std::lock_guard<std::mutex> lock(channel.mutex);
+    if (channel.closed ||
+        napi_call_threadsafe_function(channel.tsfn, completion, napi_tsfn_nonblocking) != napi_ok) {
+        delete completion;
+    }
+}
+
+// The pool's counterpart of napi_create_async_work + napi_queue_async_work:
+// execute runs on a worker, then complete on the JS thread
+void QueuePoolWork(napi_env env, napi_async_execute_callback execute,
+                   napi_async_complete_callback complete, void* data) {
+    WorkCompletion* completion = BeginWorkCompletion(env, complete, data);
+    SubmitPoolTask([env, execute, data, completion]() {
+        execute(env, data);
+        FinishWorkCompletion(completion);
+    });
+}
+
+// ============================================================================
+// Exported N-API functions
+// ============================================================================
+
+// configureWorkerPool({ size, workStealing })
+napi_value ConfigureWorkerPool(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) napi_typeof(env, args[0], &type);
+    if (type != napi_object) {
+        napi_throw_type_error(env, nullptr, "Expected an options object");
+        return nullptr;
+    }
+
+    int32_t size = -1;
+    bool present;
+    if (!GetOptionalInt32Property(env, args[0], "size", size, present) ||
+        (present && (size < 1 || size > MAX_POOL_SIZE))) {
+        napi_throw_range_error(env, nullptr, "size must be 1-64");
+        return nullptr;
+    }
+
+    bool workStealing = false;
+    bool has_stealing;
+    napi_has_named_property(env, args[0], "workStealing", &has_stealing);
+    if (has_stealing) {
+        napi_value value;
+        napi_get_named_property(env, args[0], "workStealing", &value);
+        if (napi_get_value_bool(env, value, &workStealing) != napi_ok) {
+            napi_throw_type_error(env, nullptr, "workStealing must be a boolean");
+            return nullptr;
+        }
+    }
+
+    std::shared_ptr<WorkerPool> retired;
+    {
+        std::lock_guard<std::mutex> lock(g_poolMutex);
+        int newSize = present ? size : g_poolSize;
+        bool newStealing = has_stealing ? workStealing : g_workStealing;
+        if (newSize != g_poolSize || newStealing != g_workStealing) {
+            g_poolSize = newSize;
+            g_workStealing = newStealing;
+            retired.swap(g_pool);
+        }
+    }
+    if (retired) retirePool(retired);
+
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    return undefined;
+}
+
+// getWorkerPoolStats() -> counters since the pool was started
+napi_value GetWorkerPoolStats(napi_env env, napi_callback_info info) {
+    int size;
+    bool workStealing;
+    std::shared_ptr<WorkerPool> pool;
+    {
+        std::lock_guard<std::mutex> lock(g_poolMutex);
+        size = g_poolSize;
+        workStealing = g_workStealing;
+        pool = g_pool;
+    }
+
+    size_t queued = 0, peakQueued = 0;
+    double uptimeMs = 0, busyMs = 0;
+    if (pool) {
+        std::lock_guard<std::mutex> lock(pool->wakeMutex);
+        queued = pool->queued;
+        peakQueued = pool->peakQueued;
+        uptimeMs = std::chrono::duration<double, std::milli>(Clock::now() - pool->startedAt).count();
+        busyMs = static_cast<double>(pool->busyNanos.load()) / 1e6;
+    }
+
+    napi_value stats, value;
+    NAPI_CALL(env, napi_create_object(env, &stats));
+    SetNumber(env, stats, "size", size);
+    napi_get_boolean(env, workStealing, &value);
+    napi_set_named_property(env, stats, "workStealing", value);
+    SetNumber(env, stats, "active", pool ? pool->active.load() : 0);
+    SetNumber(env, stats, "queued", static_cast<double>(queued));
+    SetNumber(env, stats, "peakQueued", static_cast<double>(peakQueued));
+    SetNumber(env, stats, "submitted", pool ? static_cast<double>(pool->submitted.load()) : 0);
+    SetNumber(env, stats, "completed", pool ? static_cast<double>(pool->completed.load()) : 0);
+    SetNumber(env, stats, "stolen", pool ? static_cast<double>(pool->stolen.load()) : 0);
+    SetNumber(env, stats, "busyMs", busyMs);
+    SetNumber(env, stats, "uptimeMs", uptimeMs);
+    // Share of the workers' time spent running tasks
+    SetNumber(env, stats, "utilization", uptimeMs > 0 ? std::min(1.0, busyMs / (uptimeMs * size)) : 0);
+    return stats;
+}
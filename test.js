@@ -1,4 +1,15 @@
-const { openCashDrawer, getAvailablePrinters, PrinterErrorCodes } = require('./index.js');
+const fs = require('fs');
+const http = require('http');
+const net = require('net');
+const os = require('os');
+const path = require('path');
+const { execFile, execFileSync } = require('child_process');
+const {
+  openCashDrawer, openCashDrawers, openDrawerHandle, sendRaw, encodeReceipt, encodeRasterImage, getDrawerStatus,
+  waitForDrawerClosed, getAvailablePrinters, watchPrinters, getStats, resetStats, configureBlocklist,
+  setPrinterAliases, resolvePrinterName, startTrace, stopTrace, dumpTrace,
+  configureWorkerPool, getWorkerPoolStats, configureScheduler, getQueueDepth, PrinterErrorCodes
+} = require('./index.js');
 
 // Use a non-existent printer for safe testing (won't create files)
 const TEST_PRINTER_NAME = 'test-printer-does-not-exist';
@@ -44,6 +55,335 @@ async function runTests() {
   console.log('Expected: errorCode 1008 (virtual printer blocked)');
   console.log('');
 
+  // Test direct TCP transport against a loopback "printer"
+  console.log('Test 5: Direct TCP transport (loopback printer)...');
+  const received = [];
+  const sockets = new Set();
+  const server = net.createServer((socket) => {
+    sockets.add(socket);
+    socket.on('data', (chunk) => received.push(...chunk));
+    socket.on('close', () => sockets.delete(socket));
+  });
+  await new Promise((resolve) => server.listen(0, '127.0.0.1', resolve));
+  const tcpOptions = { transport: 'tcp', host: '127.0.0.1', port: server.address().port };
+  console.log('Result:', await openCashDrawer('loopback', tcpOptions));
+  console.log('Result (pooled):', await openCashDrawer('loopback', tcpOptions));
+  await new Promise((resolve) => setTimeout(resolve, 50));
+  console.log('Bytes received:', received);
+  console.log('Expected: two kicks [27, 112, 0, 50, 250] over one connection');
+  for (const socket of sockets) socket.destroy();
+  server.close();
+  console.log('');
+
+  // Test direct device transport against a FIFO standing in for /dev/usb/lp0
+  if (process.platform !== 'win32') {
+    console.log('Test 6: Direct device transport (FIFO printer)...');
+    const fifoPath = path.join(os.tmpdir(), `cashdrawer-test-${process.pid}`);
+    execFileSync('mkfifo', [fifoPath]);
+    // Non-blocking read end: the addon keeps its end open between kicks
+    const reader = fs.openSync(fifoPath, fs.constants.O_RDONLY | fs.constants.O_NONBLOCK);
+    console.log('Result:', await openCashDrawer('fifo', { transport: 'device', devicePath: fifoPath }));
+    const deviceBytes = Buffer.alloc(64);
+    const length = fs.readSync(reader, deviceBytes, 0, deviceBytes.length, null);
+    console.log('Bytes received:', [...deviceBytes.subarray(0, length)]);
+    console.log('Expected: [27, 112, 0, 50, 250]');
+    fs.closeSync(reader);
+    fs.unlinkSync(fifoPath);
+    console.log('');
+  }
+
+  // Test printer watching: the first callback carries the current printers
+  console.log('Test 7: Watching printers...');
+  const changes = await new Promise((resolve) => {
+    const watcher = watchPrinters((initial) => {
+      watcher.close();
+      resolve(initial);
+    }, { intervalMs: 500 });
+  });
+  console.log('Initial changes:', changes.map((c) => `${c.type} ${c.printer.name}`));
+  console.log(`Expected: ${printers.length} "added" entries`);
+  console.log('');
+
+  console.log('Test 8: Printer changes since a generation...');
+  const first = await getAvailablePrinters({ since: 0 });
+  const next = await getAvailablePrinters({ since: first.generation });
+  console.log(`Full list: ${first.full}, ${first.added.length} printers at generation ${first.generation}`);
+  console.log(`Since then: ${next.added.length} added, ${next.changed.length} changed, ${next.removed.length} removed`);
+  console.log('Expected: nothing changed unless printers were reconfigured meanwhile');
+  console.log('');
+
+  // Test a persistent drawer handle against a loopback "printer"
+  console.log('Test 9: Drawer handle over TCP...');
+  let handleConnections = 0;
+  const handleServer = net.createServer((socket) => {
+    handleConnections++;
+    socket.on('error', () => {});
+  });
+  await new Promise((resolve) => handleServer.listen(0, '127.0.0.1', resolve));
+  const drawer = await openDrawerHandle('loopback', { transport: 'tcp', host: '127.0.0.1', port: handleServer.address().port });
+  console.log('Kick:', await drawer.kick());
+  console.log('Kick:', await drawer.kick());
+  await drawer.close();
+  console.log('After close:', await drawer.kick());
+  console.log(`Connections: ${handleConnections}`);
+  console.log('Expected: two successful kicks over one connection, then PRINTER_HANDLE_CLOSED');
+  handleServer.close();
+  console.log('');
+
+  // Test drawer status against a loopback "printer" that answers DLE EOT 1:
+  // the drawer reads open (sensor low) for three queries, then closed
+  console.log('Test 10: Drawer status over TCP...');
+  let statusQueries = 0;
+  const statusServer = net.createServer((socket) => {
+    socket.on('data', (data) => {
+      for (let i = 0; i + 2 < data.length; i++) {
+        if (data[i] === 0x10 && data[i + 1] === 0x04 && data[i + 2] === 0x01) {
+          statusQueries++;
+          socket.write(Buffer.from([statusQueries <= 3 ? 0x12 : 0x16]));
+        }
+      }
+    });
+    socket.on('error', () => {});
+  });
+  await new Promise((resolve) => statusServer.listen(0, '127.0.0.1', resolve));
+  const statusOptions = { transport: 'tcp', host: '127.0.0.1', port: statusServer.address().port };
+  console.log('Status:', await getDrawerStatus('loopback', statusOptions));
+  console.log('Wait:', await waitForDrawerClosed('loopback', { ...statusOptions, intervalMs: 50, timeout: 5000 }));
+  console.log(`Status queries: ${statusQueries}`);
+  console.log('Expected: drawerOpen true, then drawerOpen false after 4 queries');
+  statusServer.close();
+  console.log('');
+
+  // Test a receipt and drawer kick sent as one payload
+  console.log('Test 11: Raw receipt with drawer kick over TCP...');
+  const rawChunks = [];
+  const rawServer = net.createServer((socket) => {
+    socket.on('data', (data) => rawChunks.push(data));
+    socket.on('error', () => {});
+  });
+  await new Promise((resolve) => rawServer.listen(0, '127.0.0.1', resolve));
+  const receipt = Buffer.from('\x1b@Thank you\n', 'latin1');
+  const rawResult = await sendRaw('loopback', receipt, {
+    transport: 'tcp', host: '127.0.0.1', port: rawServer.address().port, keepAlive: 0, appendDrawerKick: true,
+  });
+  await new Promise((resolve) => setTimeout(resolve, 100));
+  console.log('Result:', rawResult);
+  console.log('Received:', Buffer.concat(rawChunks).toString('hex'));
+  console.log('Expected: the receipt bytes followed by the drawer command 1b700032fa');
+  rawServer.close();
+  console.log('');
+
+  // Test the receipt encoder
+  console.log('Test 12: Encode a receipt...');
+  const encoded = encodeReceipt([
+    { align: 'center', bold: true, text: 'TOTAL\n' },
+    { codePage: 'cp858', text: '3,50 €\n', cut: 'partial' },
+  ]);
+  console.log('Encoded:', encoded.toString('hex'));
+  console.log('Expected: 1b40 1b7400 1b6101 1b4501 544f54414c0a 1b7413 332c353020d50a 1d5601 (without spaces)');
+  console.log('');
+
+  // Malformed UTF-8 prints one '?' per rejected byte
+  console.log('Test 12b: Encode malformed UTF-8...');
+  const malformed = Buffer.from([
+    0xe0, 0x80, 0xaf,        // overlong 3-byte form
+    0xed, 0xa0, 0x80,        // UTF-16 surrogate
+    0xf0, 0x80, 0x80, 0xaf,  // overlong 4-byte form
+    0xf4, 0x90, 0x80, 0x80,  // past U+10FFFF
+    0xc3, 0xa9,              // é, well-formed
+  ]);
+  const rejected = encodeReceipt([{ text: malformed }], { initialize: false });
+  console.log('Encoded text:', rejected.subarray(3).toString('hex'));
+  console.log(`Expected: ${'3f'.repeat(14)}82 (14 '?' and cp437 é)`);
+  console.log('');
+
+  // Test the raster image encoder
+  console.log('Test 13: Encode a raster image...');
+  const pixels = new Uint8ClampedArray(10 * 2 * 4).fill(255);
+  for (let x = 0; x < 10; x += 2) pixels.fill(0, x * 4, x * 4 + 3);  // Black every other dot on row 0
+  const raster = encodeRasterImage(pixels, 10, 2, { dither: false });
+  console.log('Encoded:', raster.toString('hex'));
+  console.log('Expected: 1d763000 0200 0200 aa80 0000 (without spaces)');
+  console.log('Cached result equal:', raster.equals(encodeRasterImage(pixels, 10, 2, { dither: false })));
+  console.log('');
+
+  // Test waiting for the spooler to finish the job
+  console.log(`Test 14: Awaiting job completion on "${TEST_PRINTER_NAME}"...`);
+  const awaited = await openCashDrawer(TEST_PRINTER_NAME, { awaitCompletion: true, timeout: 5000 });
+  console.log('Result:', awaited);
+  console.log('Expected: PRINTER_OPEN_ERROR straight away, without completionMs');
+  console.log('');
+
+  // Test the latency metrics
+  console.log('Test 15: Stats after the tests above...');
+  const stats = getStats();
+  console.log('Submit stage:', stats.stages.submit);
+  console.log(`Requests to "${TEST_PRINTER_NAME}":`, stats.printers[TEST_PRINTER_NAME]?.requests);
+  console.log('Errors by code:', stats.errors);
+  console.log('Prometheus lines:', getStats({ format: 'prometheus' }).split('\n').length);
+  resetStats();
+  console.log('Requests after reset:', getStats().printers[TEST_PRINTER_NAME]?.requests, '(expected: 0)');
+  console.log('');
+
+  // Test trace events
+  console.log('Test 16: Tracing a kick...');
+  startTrace();
+  await openCashDrawer(TEST_PRINTER_NAME);
+  stopTrace();
+  const trace = JSON.parse(dumpTrace());
+  console.log('Trace events:', trace.traceEvents.map(e => `${e.ph}:${e.name}`).join(' '));
+  console.log('');
+
+  // Test the configurable virtual printer blocklist
+  console.log('Test 17: Blocking a site-specific virtual queue...');
+  configureBlocklist({ add: ['Test-Printer-Does'] });
+  const blocked = await openCashDrawer(TEST_PRINTER_NAME);
+  console.log('Result:', blocked.errorCode, '(expected:', PrinterErrorCodes.PRINTER_VIRTUAL_BLOCKED + ')');
+  configureBlocklist({ allow: [TEST_PRINTER_NAME.toUpperCase()] });
+  const allowed = await openCashDrawer(TEST_PRINTER_NAME);
+  console.log('Allowlisted result:', allowed.errorCode, '(expected: not', PrinterErrorCodes.PRINTER_VIRTUAL_BLOCKED + ')');
+  console.log('Patterns:', configureBlocklist({ defaults: true }).patterns.length);
+  console.log('');
+
+  // Test printer name resolution
+  console.log('Test 18: Resolving printer names and aliases...');
+  setPrinterAliases({ 'Lane 3 Drawer': TEST_PRINTER_NAME });
+  console.log('Alias:', resolvePrinterName('lane_3-DRAWER'));
+  console.log('Unknown:', resolvePrinterName('no such queue'));
+  setPrinterAliases({});
+  console.log('');
+
+  // Test failover across printers
+  console.log('Test 19: Failing over to a backup printer...');
+  const failover = await openCashDrawer(['No Such Printer', TEST_PRINTER_NAME], { hedgeAfterMs: 1000 });
+  console.log('Result:', failover.success, 'via', failover.printerName);
+  console.log('Attempts:', failover.attempts.map(a => `${a.printerName}: ${a.pending ? 'pending' : a.errorCode}`).join(', '));
+  console.log('');
+
+  // Test the printer I/O worker pool
+  console.log('Test 20: Worker pool counters...');
+  configureWorkerPool({ size: 2, workStealing: true });
+  await Promise.all([getAvailablePrinters(), openCashDrawer(TEST_PRINTER_NAME), openCashDrawer(TEST_PRINTER_NAME)]);
+  const pool = getWorkerPoolStats();
+  console.log(`Pool: ${pool.size} workers, ${pool.submitted} tasks, utilization ${pool.utilization.toFixed(3)}`);
+  configureWorkerPool({ size: 4, workStealing: false });
+  console.log('');
+
+  // Test a batch with more concurrency than items
+  console.log('Test 21: Batches smaller than their concurrency...');
+  const batches = await Promise.all(Array.from({ length: 50 }, () =>
+    openCashDrawers(Array.from({ length: 5 }, () => ({ printerName: TEST_PRINTER_NAME })), { concurrency: 8 })));
+  console.log('Results:', batches.reduce((n, batch) => n + batch.length, 0), '(expected: 250)');
+  console.log('');
+
+  // Test that a lost answer after the document went out doesn't resend it.
+  // libcups reads CUPS_SERVER once per thread, so the kick runs in a child.
+  if (process.platform !== 'win32') {
+    console.log('Test 22: cupsd dropping the connection after the document...');
+    const { TAG, OP, STATUS, decodeRequest, encodeResponse } = require('./bench/load/ipp');
+    let createJobs = 0;
+    let documents = 0;
+    const cupsd = http.createServer((req, res) => {
+      const chunks = [];
+      req.on('data', (chunk) => chunks.push(chunk));
+      req.on('end', () => {
+        const message = decodeRequest(Buffer.concat(chunks));
+        let status = STATUS.OK;
+        let groups = [];
+        if (message.operation === OP.GET_PRINTER_ATTRIBUTES) {
+          groups = [{ tag: TAG.PRINTER, attributes: [
+            [TAG.NAME, 'printer-name', 'drop-test'],
+            [TAG.URI, 'printer-uri-supported', 'ipp://localhost/printers/drop-test'],
+            [TAG.URI, 'device-uri', 'socket://127.0.0.1:9'],
+          ] }];
+        } else if (message.operation === OP.CREATE_JOB) {
+          createJobs++;
+          groups = [{ tag: TAG.JOB, attributes: [[TAG.INTEGER, 'job-id', createJobs], [TAG.ENUM, 'job-state', 3]] }];
+        } else if (message.operation === OP.SEND_DOCUMENT || message.operation === OP.PRINT_JOB) {
+          documents++;
+          req.socket.destroy();
+          return;
+        } else if (message.operation !== OP.CANCEL_JOB) {
+          status = STATUS.OPERATION_NOT_SUPPORTED;
+        }
+        const body = encodeResponse(message, status, groups);
+        res.writeHead(200, { 'Content-Type': 'application/ipp', 'Content-Length': body.length });
+        res.end(body);
+      });
+    });
+    await new Promise((resolve) => cupsd.listen(0, '127.0.0.1', resolve));
+    const child = await new Promise((resolve) => {
+      execFile(process.execPath, ['-e', `require(${JSON.stringify(__dirname)}).openCashDrawer('drop-test')` +
+        '.then((r) => console.log(r.success, r.errorCode))'], {
+        env: { ...process.env, CUPS_SERVER: `127.0.0.1:${cupsd.address().port}` }, timeout: 20000,
+      }, (error, stdout) => resolve(stdout.trim()));
+    });
+    console.log('Result:', child);
+    console.log(`Create-Job requests: ${createJobs}, documents: ${documents}`);
+    console.log('Expected: a failed kick after one Create-Job and one document');
+    cupsd.close();
+    console.log('');
+  }
+
+  // Test the scheduler: coalescing within a window, and kicks ahead of bulk jobs
+  console.log('Test 23: Coalescing and lane order on one printer...');
+  const laneChunks = [];
+  const laneServer = net.createServer((socket) => {
+    socket.on('data', (data) => laneChunks.push(data));
+    socket.on('error', () => {});
+  });
+  await new Promise((resolve) => laneServer.listen(0, '127.0.0.1', resolve));
+  const laneOptions = { transport: 'tcp', host: '127.0.0.1', port: laneServer.address().port };
+  configureScheduler({ coalesceWindowMs: 1000 });
+  const merged = await Promise.all([1, 2, 3].map(() => openCashDrawer('lanes', laneOptions)));
+  await new Promise((resolve) => setTimeout(resolve, 50));
+  console.log('Results:', merged.map((r) => r.success));
+  console.log('Kicks received:', Buffer.concat(laneChunks).length / 5, '(expected: 1)');
+  configureScheduler({ coalesceWindowMs: 0 });
+  laneChunks.length = 0;
+  await Promise.all([
+    sendRaw('lanes', Buffer.from('A'), laneOptions),
+    sendRaw('lanes', Buffer.from('B'), laneOptions),
+    openCashDrawer('lanes', laneOptions),
+  ]);
+  await new Promise((resolve) => setTimeout(resolve, 50));
+  const order = Buffer.concat(laneChunks).toString('latin1');
+  console.log('Kick before the queued receipt:', order.indexOf('\x1bp') < order.indexOf('B'), '(expected: true)');
+  console.log('Queue depth afterwards:', getQueueDepth('lanes'), '(expected: 0)');
+  laneServer.close();
+  console.log('');
+
+  // Test that a failed hedged attempt starts the next printer at once. A
+  // server that never reads keeps big writes stuck, so 'Stuck' waits behind
+  // one and the hedged 'Full' attempt hits maxQueueDepth straight away.
+  console.log('Test 24: A hedged attempt that fails...');
+  const stalled = [];
+  const stallServer = net.createServer((socket) => {
+    socket.pause();
+    socket.on('error', () => {});
+    stalled.push(socket);
+  });
+  await new Promise((resolve) => stallServer.listen(0, '127.0.0.1', resolve));
+  const stallOptions = { transport: 'tcp', host: '127.0.0.1', port: stallServer.address().port, writeTimeout: 3000 };
+  const bigReceipt = Buffer.alloc(64 * 1024 * 1024);
+  configureScheduler({ maxQueueDepth: 2 });
+  const blockers = [
+    sendRaw('Stuck', bigReceipt, stallOptions),
+    sendRaw('Full', bigReceipt, stallOptions),
+    sendRaw('Full', bigReceipt, stallOptions),
+  ];
+  const hedgeStart = Date.now();
+  const hedgedFailure = await openCashDrawer(['Stuck', 'Full', 'Spare'], { ...stallOptions, hedgeAfterMs: 1000 });
+  const hedgeElapsed = Date.now() - hedgeStart;
+  console.log('Result:', hedgedFailure.success, 'via', hedgedFailure.printerName);
+  console.log('Attempts:', hedgedFailure.attempts.map(a => `${a.printerName}: ${a.pending ? 'pending' : a.errorCode}`).join(', '));
+  console.log(`Settled after ${hedgeElapsed} ms (expected: about 1000, not 2000)`);
+  await Promise.all(blockers);
+  configureScheduler({ maxQueueDepth: 32 });
+  for (const socket of stalled) socket.destroy();
+  stallServer.close();
+  console.log('');
+
   console.log('All tests completed.');
 }
 